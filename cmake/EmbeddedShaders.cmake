@@ -0,0 +1,68 @@
+# Compiles shader permutations with glslc at build time and writes a header that embeds the spir-v as constexpr arrays.
+#
+#   vdd_add_embedded_shader(<source> [<define>...])
+#   vdd_generate_embedded_shaders(<output header> <target name>)
+#
+# <source> is relative to the source directory and has to be the exact path the game asks for, the defines are
+# NAME or NAME=VALUE. The game looks permutations up by path and sorted defines so the order doesn't matter.
+# VDD_GLSLC_EXECUTABLE has to be set to a glslc binary or target before generating.
+
+set(VDD_EMBEDDED_SHADER_COUNT 0)
+
+function(vdd_add_embedded_shader source)
+    set(index ${VDD_EMBEDDED_SHADER_COUNT})
+    set(defines ${ARGN})
+    list(TRANSFORM defines PREPEND "-D")
+    list(SORT defines)
+
+    set(VDD_EMBEDDED_SHADER_${index}_SOURCE "${source}" PARENT_SCOPE)
+    set(VDD_EMBEDDED_SHADER_${index}_DEFINES "${defines}" PARENT_SCOPE)
+    math(EXPR index "${index} + 1")
+    set(VDD_EMBEDDED_SHADER_COUNT ${index} PARENT_SCOPE)
+endfunction()
+
+function(vdd_generate_embedded_shaders header target)
+    get_filename_component(header_dir "${header}" DIRECTORY)
+    set(spirv_dir "${header_dir}/spirv")
+    file(MAKE_DIRECTORY "${spirv_dir}")
+
+    if (TARGET ${VDD_GLSLC_EXECUTABLE})
+        set(glslc "$<TARGET_FILE:${VDD_GLSLC_EXECUTABLE}>")
+    else()
+        set(glslc "${VDD_GLSLC_EXECUTABLE}")
+    endif()
+
+    set(arrays "")
+    set(entries "")
+    set(outputs "")
+    math(EXPR last "${VDD_EMBEDDED_SHADER_COUNT} - 1")
+    foreach(index RANGE ${last})
+        set(source "${VDD_EMBEDDED_SHADER_${index}_SOURCE}")
+        set(defines "${VDD_EMBEDDED_SHADER_${index}_DEFINES}")
+        get_filename_component(name "${source}" NAME)
+        set(output "${spirv_dir}/${index}_${name}.inc")
+
+        # -mfmt=c writes the words as a braced initializer list, the stage comes from the file extension
+        add_custom_command(
+            OUTPUT "${output}"
+            COMMAND ${glslc} -c -mfmt=c ${defines} -o "${output}" "${CMAKE_CURRENT_SOURCE_DIR}/${source}"
+            DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/${source}" ${VDD_GLSLC_EXECUTABLE}
+            COMMENT "Compiling ${source} ${defines}"
+            VERBATIM)
+        list(APPEND outputs "${output}")
+
+        list(JOIN defines " " defines_key)
+        string(APPEND arrays "constexpr uint32_t c_embeddedShader${index}[] =\n#include \"spirv/${index}_${name}.inc\"\n;\n\n")
+        string(APPEND entries "    { \"${source}\", \"${defines_key}\", c_embeddedShader${index}, sizeof(c_embeddedShader${index}) },\n")
+    endforeach()
+
+    set(content "// generated by cmake/EmbeddedShaders.cmake, edit the permutations in CMakeLists.txt instead\n#pragma once\n\n")
+    string(APPEND content "#include <cstddef>\n#include <cstdint>\n\n")
+    string(APPEND content "struct EmbeddedShader\n{\n    const char* m_path;\n    // -D flags sorted and joined by spaces\n")
+    string(APPEND content "    const char* m_defines;\n    const uint32_t* m_spirv;\n    std::size_t m_spirvSize;\n};\n\n")
+    string(APPEND content "${arrays}")
+    string(APPEND content "constexpr EmbeddedShader c_embeddedShaders[] =\n{\n${entries}};\n")
+    file(CONFIGURE OUTPUT "${header}" CONTENT "${content}" @ONLY)
+
+    add_custom_target(${target} DEPENDS ${outputs})
+endfunction()
@@ -1,4 +1,4 @@
-#version 400
+#version 450
 #extension GL_ARB_separate_shader_objects  : enable
 #extension GL_ARB_shading_language_420pack : enable
 
@@ -38,8 +38,19 @@ layout(std140, set = 0, binding = 0) uniform FrameBuf
     PointLightBuf uPointLights[2];
 } Frame;
 
+// set through VkSpecializationInfo when the pipeline is created, see MeshFragmentConstant in ShaderSpecialization.h
+layout(constant_id = 0) const bool cWireframe = false;
+layout(constant_id = 1) const bool cUseTexture = false;
+layout(constant_id = 2) const bool cUseTextureSampleScale = false;
+layout(constant_id = 3) const bool cUseDirectionalLight = false;
+layout(constant_id = 4) const bool cUseSpotLight = false;
+layout(constant_id = 5) const bool cUsePointLight = false;
+layout(constant_id = 6) const int cMaxSampledTextureCount = 1;
+layout(constant_id = 7) const bool cWaterGradientNormal = false;
+
 layout(set = 2, binding = 0) uniform sampler samplerColour;
-layout(set = 3, binding = 0) uniform texture2D sampledTexture[MAX_SAMPLED_TEXTURE_COUNT];
+layout(set = 3, binding = 0) uniform texture2D sampledTexture[cMaxSampledTextureCount];
+layout(set = 4, binding = 0) uniform texture2D sampledWaterHeightTexture;
 
 layout(std140, set = 1, binding = 0) uniform ObjectBuf
 {
@@ -48,11 +59,15 @@ layout(std140, set = 1, binding = 0) uniform ObjectBuf
     vec3 uFresnelR0;
     float uRoughness;
     uint uTextureIndex;
+    vec4 uPositionScale;
+    vec4 uPositionOffset;
+    vec4 uTextureScaleOffset;
 } Object;
 
 layout(location = 0) in vec3 vNormalW;
 layout(location = 1) in vec3 vPositionW;
 layout(location = 2) in vec2 inUV;
+layout(location = 3) flat in vec2 vHeightGradientScale;
 
 layout(location = 0) out vec4 fFragColor;
 
@@ -167,42 +182,54 @@ vec3 ComputePointLight(PointLightBuf light, vec3 pos, vec3 normal, vec3 toEye)
 
 void main()
 {
-#ifdef IS_WIREFRAME
-    fFragColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
-#else
+    if (cWireframe)
+    {
+        fFragColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
+        return;
+    }
+
     vec3 normalizedNormalW = normalize(vNormalW);
+    if (cWaterGradientNormal)
+    {
+        // the waves are far finer than the patch vertices away from the camera so the normal is rebuilt per pixel
+        vec2 heightGradient = texture(sampler2D(sampledWaterHeightTexture, samplerColour), inUV).yz * vHeightGradientScale;
+        normalizedNormalW = normalize(vec3(-heightGradient.x, 1.0, -heightGradient.y) * mat3(Object.uWorld));
+    }
     vec3 toEyeW = normalize(Frame.uEyePosW - vPositionW);
 
-#ifdef USE_TEXTURE
-    vec2 uv = inUV;
-#ifdef USE_TEXTURE_SAMPLE_SCALE
-    uv *= 100.0f;
-#endif // USE_TEXTURE_SAMPLE_SCALE
-    vec3 rgb = (texture(sampler2D(sampledTexture[Object.uTextureIndex], samplerColour), uv) * Object.uDiffuseAlbedo).xyz;
-#else
     vec3 rgb = Object.uDiffuseAlbedo.xyz;
-#endif // USE_TEXTURE
+    if (cUseTexture)
+    {
+        vec2 uv = inUV;
+        if (cUseTextureSampleScale)
+        {
+            uv *= 100.0f;
+        }
+        rgb = (texture(sampler2D(sampledTexture[Object.uTextureIndex], samplerColour), uv) * Object.uDiffuseAlbedo).xyz;
+    }
 
     const float shadowFactor = 1.0f;
 
     vec3 lightResult = vec3(0.0f, 0.0f, 0.0f) + Frame.uAmbientLight.xyz;
-#ifdef USE_DIRECTIONAL_LIGHT
-    lightResult += shadowFactor * ComputeDirectionalLight(Frame.uDirLight, normalizedNormalW, toEyeW);
-#endif // USE_DIRECTIONAL_LIGHT
-
-#ifdef USE_SPOT_LIGHT
-    lightResult += shadowFactor * ComputeSpotLight(Frame.uSpotLight, vPositionW, normalizedNormalW, toEyeW);
-#endif // USE_SPOT_LIGHT
-
-#ifdef USE_POINT_LIGHT
-    lightResult += shadowFactor * ComputePointLight(Frame.uPointLights[0], vPositionW, normalizedNormalW, toEyeW);
-    lightResult += shadowFactor * ComputePointLight(Frame.uPointLights[1], vPositionW, normalizedNormalW, toEyeW);
-#endif // USE_POINT_LIGHT
+    if (cUseDirectionalLight)
+    {
+        lightResult += shadowFactor * ComputeDirectionalLight(Frame.uDirLight, normalizedNormalW, toEyeW);
+    }
+
+    if (cUseSpotLight)
+    {
+        lightResult += shadowFactor * ComputeSpotLight(Frame.uSpotLight, vPositionW, normalizedNormalW, toEyeW);
+    }
+
+    if (cUsePointLight)
+    {
+        lightResult += shadowFactor * ComputePointLight(Frame.uPointLights[0], vPositionW, normalizedNormalW, toEyeW);
+        lightResult += shadowFactor * ComputePointLight(Frame.uPointLights[1], vPositionW, normalizedNormalW, toEyeW);
+    }
 
     vec3 finalColour = rgb * lightResult;
     fFragColor = vec4(finalColour.x, finalColour.y, finalColour.z, 0.0f);
 
     // Common convention to take alpha from diffuse material.
     fFragColor.a = Object.uDiffuseAlbedo.a;
-#endif // IS_WIREFRAME
 }
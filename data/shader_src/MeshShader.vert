@@ -1,4 +1,4 @@
-#version 400
+#version 450
 #extension GL_ARB_separate_shader_objects  : enable
 #extension GL_ARB_shading_language_420pack : enable
 
@@ -45,12 +45,17 @@ layout(std140, set = 1, binding = 0) uniform ObjectBuf
     vec3 uFresnelR0;
     float uRoughness;
     uint uTextureIndex;
+    vec4 uPositionScale;
+    vec4 uPositionOffset;
+    vec4 uTextureScaleOffset;
 } Object;
 
-#ifdef USE_WATER_TEXTURE
-    layout(set = 2, binding = 0) uniform sampler samplerColour;
-    layout(set = 4, binding = 0) uniform texture2D sampledWaterHeightTexture;
-#endif // USE_WATER_TEXTURE
+// set through VkSpecializationInfo when the pipeline is created, see MeshVertexConstant in ShaderSpecialization.h
+layout(constant_id = 0) const bool cDuckWaterSample = false;
+layout(constant_id = 1) const bool cOctahedralNormal = false;
+
+layout(set = 2, binding = 0) uniform sampler samplerColour;
+layout(set = 4, binding = 0) uniform texture2D sampledWaterHeightTexture;
 
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aNormal;
@@ -59,34 +64,50 @@ layout(location = 2) in vec2 inUV;
 layout(location = 0) out vec3 vNormalW;
 layout(location = 1) out vec3 vPositionW;
 layout(location = 2) out vec2 outUV;
+// only WaterShader.vert has a use for it, written so MeshShader.frag's input is always fed
+layout(location = 3) flat out vec2 vHeightGradientScale;
+
+// the inverse of the folding in MeshLoader's VertexPacker
+vec3 DecodeOctahedral(vec2 encoded)
+{
+    vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-direction.z, 0.0);
+    direction.x += direction.x >= 0.0 ? -fold : fold;
+    direction.y += direction.y >= 0.0 ? -fold : fold;
+    return normalize(direction);
+}
 
 void main()
 {
-    vec4 position = vec4(aPosition, 1.0f);
-#ifndef DUCK_WATER_SAMPLE
-#ifdef USE_WATER_TEXTURE
-    position.y += texture(sampler2D(sampledWaterHeightTexture, samplerColour), inUV).x;
-#endif // USE_WATER_TEXTURE 
-#endif // DUCK_WATER_SAMPLE
+    vec2 uv = inUV * Object.uTextureScaleOffset.xy + Object.uTextureScaleOffset.zw;
+
+    vec4 position = vec4(aPosition * Object.uPositionScale.xyz + Object.uPositionOffset.xyz, 1.0f);
+    if (!cDuckWaterSample)
+    {
+        position.y += texture(sampler2D(sampledWaterHeightTexture, samplerColour), uv).x;
+    }
 
     mat4 world = Object.uWorld;
-#ifdef DUCK_WATER_SAMPLE
-    float offsetY = texture(sampler2D(sampledWaterHeightTexture, samplerColour), vec2(0.5f, 0.5f)).x;
-    offsetY -= 150.0;
-    mat4 offsetMat;
-    offsetMat[0].xyzw = vec4(1.0, 0.0, 0.0, 0.0);
-    offsetMat[1].xyzw = vec4(0.0, 1.0, 0.0, offsetY);
-    offsetMat[2].xyzw = vec4(0.0, 0.0, 1.0, 0.0);
-    offsetMat[3].xyzw = vec4(0.0, 0.0, 0.0, 1.0);
-
-    world = world * offsetMat;
-#endif // DUCK_WATER_SAMPLE
+    if (cDuckWaterSample)
+    {
+        float offsetY = texture(sampler2D(sampledWaterHeightTexture, samplerColour), vec2(0.5f, 0.5f)).x;
+        offsetY -= 150.0;
+        mat4 offsetMat;
+        offsetMat[0].xyzw = vec4(1.0, 0.0, 0.0, 0.0);
+        offsetMat[1].xyzw = vec4(0.0, 1.0, 0.0, offsetY);
+        offsetMat[2].xyzw = vec4(0.0, 0.0, 1.0, 0.0);
+        offsetMat[3].xyzw = vec4(0.0, 0.0, 0.0, 1.0);
+
+        world = world * offsetMat;
+    }
 
     vec4 posW = position * world;
     vPositionW = posW.xyz;
     gl_Position = posW * Frame.uViewProj;
 
-    vNormalW = aNormal * mat3(world);
+    vec3 normal = cOctahedralNormal ? DecodeOctahedral(aNormal.xy) : aNormal;
+    vNormalW = normal * mat3(world);
 
-    outUV = inUV; 
+    outUV = uv;
+    vHeightGradientScale = vec2(0.0);
 }
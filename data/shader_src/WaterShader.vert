@@ -0,0 +1,106 @@
+#version 450
+#extension GL_ARB_separate_shader_objects  : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+struct DirectionalLightBuf
+{
+    vec3 uStrength;
+    float padding0;
+    vec3 uDirection;
+};
+
+struct SpotLightBuf
+{
+    vec3 uStrength;
+    float uFalloffStart;
+    vec3 uDirection;
+    float uFalloffEnd;
+    vec3 uPosition;
+    float uSpotPower;
+};
+
+struct PointLightBuf
+{
+    vec3 uStrength;
+    float uFalloffStart;
+    vec3 uPosition;
+    float uFalloffEnd;
+};
+
+layout(std140, set = 0, binding = 0) uniform FrameBuf
+{
+    mat4 uViewProj;
+    vec3 uEyePosW;
+    float padding0;
+    vec4 uAmbientLight;
+    DirectionalLightBuf uDirLight;
+    SpotLightBuf uSpotLight;
+    PointLightBuf uPointLights[2];
+} Frame;
+
+layout(std140, set = 1, binding = 0) uniform ObjectBuf
+{
+    mat4 uWorld;
+    vec4 uDiffuseAlbedo;
+    vec3 uFresnelR0;
+    float uRoughness;
+    uint uTextureIndex;
+    vec4 uPositionScale;
+    vec4 uPositionOffset;
+    vec4 uTextureScaleOffset;
+} Object;
+
+// set through VkSpecializationInfo when the pipeline is created, see WaterVertexConstant in ShaderSpecialization.h
+layout(constant_id = 0) const uint cPatchQuadCount = 16;
+
+layout(set = 2, binding = 0) uniform sampler samplerColour;
+layout(set = 4, binding = 0) uniform texture2D sampledWaterHeightTexture;
+
+// one per patch instance, see WaterPatch in WaterLod.h
+layout(location = 4) in vec4 aPatchOriginSize;
+layout(location = 5) in vec4 aPatchUvOriginScale;
+layout(location = 6) in vec2 aPatchMorphRange;
+
+layout(location = 0) out vec3 vNormalW;
+layout(location = 1) out vec3 vPositionW;
+layout(location = 2) out vec2 outUV;
+// turns the heightmap's per texel gradient into height per unit along the object's x and z
+layout(location = 3) flat out vec2 vHeightGradientScale;
+
+void main()
+{
+    // there's no vertex buffer, the patch's indices are into a row major grid of cPatchQuadCount + 1 vertices a side
+    // with the rows running against z the way LoadGridPrimitive lays them out
+    uint patchVertexCount = cPatchQuadCount + 1;
+    uint column = uint(gl_VertexIndex) % patchVertexCount;
+    uint row = uint(gl_VertexIndex) / patchVertexCount;
+    vec2 gridPosition = vec2(float(column), float(cPatchQuadCount - row));
+
+    mat4 world = Object.uWorld;
+    vec2 planePosition = aPatchOriginSize.xy + gridPosition / float(cPatchQuadCount) * aPatchOriginSize.z;
+    float cameraDistance = distance((vec4(planePosition.x, 0.0, planePosition.y, 1.0) * world).xyz, Frame.uEyePosW);
+
+    // odd vertices slide onto their even neighbour as the camera gets close to where the next coarser level takes
+    // over, by the end the patch is the coarser level's grid and the two meet without cracks
+    float morph = clamp((cameraDistance - aPatchMorphRange.x) / (aPatchMorphRange.y - aPatchMorphRange.x), 0.0, 1.0);
+    gridPosition -= fract(gridPosition * 0.5) * 2.0 * morph;
+
+    vec2 patchUV = gridPosition / float(cPatchQuadCount);
+    planePosition = aPatchOriginSize.xy + patchUV * aPatchOriginSize.z;
+    vec2 uv = aPatchUvOriginScale.xy + patchUV * aPatchUvOriginScale.zw;
+
+    // one fetch gets the height and the gradient water.comp worked out for it
+    vec3 heightGradient = texture(sampler2D(sampledWaterHeightTexture, samplerColour), uv).xyz;
+    vec4 position = vec4(planePosition.x, 0.0, planePosition.y, 1.0);
+    position.y += heightGradient.x;
+
+    vec4 posW = position * world;
+    vPositionW = posW.xyz;
+    gl_Position = posW * Frame.uViewProj;
+
+    vHeightGradientScale = vec2(textureSize(sampler2D(sampledWaterHeightTexture, samplerColour), 0)) * aPatchUvOriginScale.zw / aPatchOriginSize.z;
+    vec2 heightGradientObject = heightGradient.yz * vHeightGradientScale;
+    vNormalW = normalize(vec3(-heightGradientObject.x, 1.0, -heightGradientObject.y)) * mat3(world);
+
+    outUV = uv;
+}
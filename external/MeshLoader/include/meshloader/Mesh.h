@@ -11,9 +11,33 @@ namespace MeshLoader
         std::unique_ptr<char> buffer = nullptr;
         
         Vertex* GetVertex() { return reinterpret_cast<Vertex*>(&buffer.get()[0]); }
+        const Vertex* GetVertex() const { return reinterpret_cast<const Vertex*>(&buffer.get()[0]); }
         int vertexCount = 0;
 
         IndexType* GetIndex() { return reinterpret_cast<IndexType*>(&buffer.get()[sizeof(Vertex)*vertexCount]); }
+        const IndexType* GetIndex() const { return reinterpret_cast<const IndexType*>(&buffer.get()[sizeof(Vertex)*vertexCount]); }
         int indexCount = 0;
     };
+
+    struct Bounds
+    {
+        Vector3 min;
+        Vector3 max;
+    };
+
+    // read straight out of a mapped mesh cache, the pointers are only valid while mapping is alive
+    struct MappedMesh
+    {
+        std::shared_ptr<const void> mapping = nullptr;
+
+        const Vertex* GetVertex() const { return vertices; }
+        const Vertex* vertices = nullptr;
+        int vertexCount = 0;
+
+        const IndexType* GetIndex() const { return indices; }
+        const IndexType* indices = nullptr;
+        int indexCount = 0;
+
+        Bounds bounds = {};
+    };
 }
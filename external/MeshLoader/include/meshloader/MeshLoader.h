@@ -4,14 +4,44 @@
 
 #include "meshloader/MeshLoaderStd.h"
 #include "meshloader/Mesh.h"
+#include "meshloader/VertexFormat.h"
 
 namespace MeshLoader
 {
+    // pass as the source hash to use a cache whatever it was written from, for builds that ship the cache without the model
+    constexpr uint64_t c_meshCacheAnySource = 0;
+
+    // measured with a 16 entry fifo cache
+    struct OptimizeStats
+    {
+        // vertices transformed per triangle, 0.5 is about the best a big closed mesh can do and 3 is no reuse at all
+        float acmrBefore = 0.0f;
+        float acmrAfter = 0.0f;
+        // vertices transformed per vertex used, 1 means every vertex is transformed exactly once
+        float atvrBefore = 0.0f;
+        float atvrAfter = 0.0f;
+    };
+
     class Loader
     {
     public:
         ML_DLL static bool LoadCubePrimitive(Mesh& outMesh, const float width = 1.0f, const float height = 1.0f, const float depth = 1.0f);
         ML_DLL static bool LoadGridPrimitive(float planeWidth, float planeDepth, uint32_t gridX, uint32_t gridY, Mesh& outMesh);
         ML_DLL static bool LoadModel(const void* buffer, const size_t bufferSize, Mesh& outMesh);
+
+        // reorders the triangles for the post-transform cache and overdraw then the vertices for fetch locality,
+        // slow enough that it belongs at import time, right before a mesh is written to its cache
+        ML_DLL static bool Optimize(Mesh& mesh, OptimizeStats* outStats = nullptr);
+
+        // offsets and stride of a vertex in the given format, same for every mesh
+        ML_DLL static VertexLayout GetVertexLayout(const VertexFormat& format);
+        // converts the vertices for upload, the mesh itself always stays float32 so it can be packed again differently
+        ML_DLL static bool PackVertices(const Vertex* vertices, const int vertexCount, const VertexFormat& format, PackedVertices& outPackedVertices);
+
+        // the cache is a versioned binary copy of the mesh tagged with the hash of the file it was loaded from
+        ML_DLL static uint64_t HashSource(const void* buffer, const size_t bufferSize);
+        ML_DLL static bool SaveMeshCache(const Mesh& mesh, const uint64_t sourceHash, const char* path);
+        // maps the cache instead of reading it, fails if it's missing, from another version or from another source
+        ML_DLL static bool LoadMeshCache(const char* path, const uint64_t sourceHash, MappedMesh& outMesh);
     };
 }
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cinttypes>
+#include <memory>
+
+#include "meshloader/Vertex.h"
+
+namespace MeshLoader
+{
+    enum PositionFormat
+    {
+        PositionFormat_Float32 = 0,
+        // four halfs, the mesh is stored around its own bounds as -1 to 1 so precision follows its size
+        PositionFormat_Float16,
+        // four unorm16s, the mesh is stored as 0 to 1 across its bounds
+        PositionFormat_Unorm16,
+    };
+
+    enum DirectionFormat
+    {
+        DirectionFormat_Float32 = 0,
+        // two snorm16s folded onto an octahedron, has to be unfolded in the shader
+        DirectionFormat_Octahedral16,
+        // left out of the vertex altogether
+        DirectionFormat_None,
+    };
+
+    enum TextureFormat
+    {
+        TextureFormat_Float32 = 0,
+        // two unorm16s across the mesh's uv bounds so wrapping uvs still work
+        TextureFormat_Unorm16,
+    };
+
+    struct VertexFormat
+    {
+        PositionFormat position = PositionFormat_Float32;
+        DirectionFormat normal = DirectionFormat_Float32;
+        DirectionFormat tangent = DirectionFormat_Float32;
+        TextureFormat texture = TextureFormat_Float32;
+    };
+
+    constexpr uint32_t c_vertexAttributeAbsent = 0xffffffffu;
+
+    // byte offsets of each attribute in a packed vertex, c_vertexAttributeAbsent when it was left out
+    struct VertexLayout
+    {
+        uint32_t stride = 0;
+        uint32_t positionOffset = c_vertexAttributeAbsent;
+        uint32_t normalOffset = c_vertexAttributeAbsent;
+        uint32_t tangentOffset = c_vertexAttributeAbsent;
+        uint32_t textureOffset = c_vertexAttributeAbsent;
+    };
+
+    struct PackedVertices
+    {
+        std::unique_ptr<char[]> buffer = nullptr;
+        int vertexCount = 0;
+        VertexFormat format;
+        VertexLayout layout;
+
+        // stored * scale + offset gives back the mesh's own positions and uvs, 1 and 0 for float32
+        Vector3 positionScale = { 1.0f, 1.0f, 1.0f };
+        Vector3 positionOffset = { 0.0f, 0.0f, 0.0f };
+        Vector2 textureScale = { 1.0f, 1.0f };
+        Vector2 textureOffset = { 0.0f, 0.0f };
+    };
+}
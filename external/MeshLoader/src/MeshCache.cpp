@@ -0,0 +1,209 @@
+#include "MeshCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#include "meshloader/MeshLoader.h"
+
+using namespace MeshLoader;
+
+static uint64_t AlignOffset(const uint64_t offset)
+{
+    return (offset + c_meshCacheAlignment - 1) / c_meshCacheAlignment * c_meshCacheAlignment;
+}
+
+// the returned pointer unmaps the file once the last copy of it is gone
+static std::shared_ptr<const void> MapFile(const char* path, size_t& outSize)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    // the view keeps the file open by itself
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+        return nullptr;
+    }
+
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == nullptr)
+    {
+        return nullptr;
+    }
+
+    outSize = static_cast<size_t>(fileSize.QuadPart);
+    return std::shared_ptr<const void>(data, [](const void* view) { UnmapViewOfFile(view); });
+#else
+    const int file = open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0)
+    {
+        data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    const size_t size = static_cast<size_t>(info.st_size);
+    outSize = size;
+    return std::shared_ptr<const void>(data, [size](const void* view) { munmap(const_cast<void*>(view), size); });
+#endif // _WIN32
+}
+
+uint64_t MeshCache::Hash(const void* buffer, const size_t bufferSize)
+{
+    constexpr uint64_t fnv1aOffsetBasis = 0xcbf29ce484222325ull;
+    constexpr uint64_t fnv1aPrime = 0x100000001b3ull;
+
+    uint64_t hash = fnv1aOffsetBasis;
+    const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+    for (size_t i = 0; i < bufferSize; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= fnv1aPrime;
+    }
+    return hash == c_meshCacheAnySource ? 1 : hash;
+}
+
+bool MeshCache::Save(const Mesh& mesh, const uint64_t sourceHash, const char* path)
+{
+    if (mesh.buffer == nullptr || mesh.vertexCount <= 0 || mesh.indexCount <= 0)
+    {
+        return false;
+    }
+
+    MeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = c_meshCacheMagic;
+    header.version = c_meshCacheVersion;
+    header.sourceHash = sourceHash;
+    header.vertexSize = sizeof(Vertex);
+    header.indexSize = sizeof(IndexType);
+    header.vertexCount = static_cast<uint32_t>(mesh.vertexCount);
+    header.indexCount = static_cast<uint32_t>(mesh.indexCount);
+    header.vertexOffset = AlignOffset(sizeof(MeshCacheHeader));
+    header.indexOffset = AlignOffset(header.vertexOffset + sizeof(Vertex) * header.vertexCount);
+
+    header.bounds.min = mesh.GetVertex()[0].position;
+    header.bounds.max = mesh.GetVertex()[0].position;
+    for (int i = 1; i < mesh.vertexCount; ++i)
+    {
+        const Vector3& position = mesh.GetVertex()[i].position;
+        header.bounds.min = { std::min(header.bounds.min.x, position.x), std::min(header.bounds.min.y, position.y), std::min(header.bounds.min.z, position.z) };
+        header.bounds.max = { std::max(header.bounds.max.x, position.x), std::max(header.bounds.max.y, position.y), std::max(header.bounds.max.z, position.z) };
+    }
+
+    // written under another name and moved over the old one so a crash never leaves half a cache behind
+    const std::string tempPath = std::string(path) + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    const std::vector<char> padding(c_meshCacheAlignment, 0);
+    const size_t vertexPadding = static_cast<size_t>(header.vertexOffset - sizeof(MeshCacheHeader));
+    const size_t indexPadding = static_cast<size_t>(header.indexOffset - header.vertexOffset - sizeof(Vertex) * header.vertexCount);
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    written = written && fwrite(padding.data(), 1, vertexPadding, file) == vertexPadding;
+    written = written && fwrite(mesh.GetVertex(), sizeof(Vertex), header.vertexCount, file) == header.vertexCount;
+    written = written && fwrite(padding.data(), 1, indexPadding, file) == indexPadding;
+    written = written && fwrite(mesh.GetIndex(), sizeof(IndexType), header.indexCount, file) == header.indexCount;
+    const bool closed = fclose(file) == 0;
+    if (!written || !closed)
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    const bool renamed = MoveFileExA(tempPath.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    const bool renamed = std::rename(tempPath.c_str(), path) == 0;
+#endif // _WIN32
+    if (!renamed)
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool MeshCache::Load(const char* path, const uint64_t sourceHash, MappedMesh& outMesh)
+{
+    size_t size = 0;
+    std::shared_ptr<const void> mapping = MapFile(path, size);
+    if (mapping == nullptr || size < sizeof(MeshCacheHeader))
+    {
+        return false;
+    }
+
+    const uint8_t* data = static_cast<const uint8_t*>(mapping.get());
+    MeshCacheHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != c_meshCacheMagic ||
+        header.version != c_meshCacheVersion ||
+        header.vertexSize != sizeof(Vertex) ||
+        header.indexSize != sizeof(IndexType) ||
+        (sourceHash != c_meshCacheAnySource && header.sourceHash != sourceHash))
+    {
+        return false;
+    }
+
+    // everything is checked against the file size so a truncated cache is rejected instead of read past
+    const uint64_t vertexEnd = header.vertexOffset + static_cast<uint64_t>(sizeof(Vertex)) * header.vertexCount;
+    const uint64_t indexEnd = header.indexOffset + static_cast<uint64_t>(sizeof(IndexType)) * header.indexCount;
+    if (header.vertexOffset % c_meshCacheAlignment != 0 ||
+        header.indexOffset % c_meshCacheAlignment != 0 ||
+        header.vertexOffset < sizeof(MeshCacheHeader) ||
+        header.indexOffset < vertexEnd ||
+        indexEnd > size)
+    {
+        return false;
+    }
+
+    outMesh.vertices = reinterpret_cast<const Vertex*>(data + header.vertexOffset);
+    outMesh.vertexCount = static_cast<int>(header.vertexCount);
+    outMesh.indices = reinterpret_cast<const IndexType*>(data + header.indexOffset);
+    outMesh.indexCount = static_cast<int>(header.indexCount);
+    outMesh.bounds = header.bounds;
+    outMesh.mapping = std::move(mapping);
+
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+
+#include "meshloader/Mesh.h"
+
+namespace MeshLoader
+{
+    constexpr uint32_t c_meshCacheMagic = 0x434d4c4d; // "MLMC"
+    // bump whenever the layout, Vertex or what's done to a mesh before it's saved changes so old caches are thrown away
+    constexpr uint32_t c_meshCacheVersion = 2;
+    // the arrays start on this so they can be used right out of the mapping
+    constexpr uint64_t c_meshCacheAlignment = 16;
+
+    struct MeshCacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t sourceHash;
+        uint32_t vertexSize;
+        uint32_t indexSize;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        Bounds bounds;
+    };
+
+    class MeshCache
+    {
+    public:
+        // 64 bit fnv-1a, never returns c_meshCacheAnySource
+        static uint64_t Hash(const void* buffer, const size_t bufferSize);
+        static bool Save(const Mesh& mesh, const uint64_t sourceHash, const char* path);
+        static bool Load(const char* path, const uint64_t sourceHash, MappedMesh& outMesh);
+    };
+}
@@ -2,7 +2,10 @@
 
 #include <cstring>
 
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
 #include "MeshUtils.h"
+#include "VertexPacker.h"
 
 #ifdef ML_ENABLE_ASSIMP
 #include "AssimpLoader.h"
@@ -265,3 +268,33 @@ bool Loader::LoadModel(const void* buffer, const size_t bufferSize, Mesh& outMes
     return false;
 #endif // ML_ENABLE_ASSIMP
 }
+
+bool Loader::Optimize(Mesh& mesh, OptimizeStats* outStats /*= nullptr*/)
+{
+    return MeshOptimizer::Optimize(mesh, outStats);
+}
+
+VertexLayout Loader::GetVertexLayout(const VertexFormat& format)
+{
+    return VertexPacker::GetLayout(format);
+}
+
+bool Loader::PackVertices(const Vertex* vertices, const int vertexCount, const VertexFormat& format, PackedVertices& outPackedVertices)
+{
+    return VertexPacker::Pack(vertices, vertexCount, format, outPackedVertices);
+}
+
+uint64_t Loader::HashSource(const void* buffer, const size_t bufferSize)
+{
+    return MeshCache::Hash(buffer, bufferSize);
+}
+
+bool Loader::SaveMeshCache(const Mesh& mesh, const uint64_t sourceHash, const char* path)
+{
+    return MeshCache::Save(mesh, sourceHash, path);
+}
+
+bool Loader::LoadMeshCache(const char* path, const uint64_t sourceHash, MappedMesh& outMesh)
+{
+    return MeshCache::Load(path, sourceHash, outMesh);
+}
@@ -0,0 +1,326 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "MeshUtils.h"
+
+using namespace MeshLoader;
+
+namespace
+{
+    constexpr uint32_t c_invalidVertex = 0xffffffffu;
+
+    // vertex to triangle adjacency packed into one array, the triangles of vertex v are offsets[v] to offsets[v + 1]
+    struct Adjacency
+    {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+    };
+
+    void BuildAdjacency(const IndexType* indices, const uint32_t triangleCount, const uint32_t vertexCount, Adjacency& outAdjacency)
+    {
+        outAdjacency.offsets.assign(vertexCount + 1, 0);
+        for (uint32_t i = 0; i < triangleCount * 3; ++i)
+        {
+            ++outAdjacency.offsets[indices[i] + 1];
+        }
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            outAdjacency.offsets[v + 1] += outAdjacency.offsets[v];
+        }
+
+        std::vector<uint32_t> cursor(outAdjacency.offsets.begin(), outAdjacency.offsets.end() - 1);
+        outAdjacency.triangles.resize(triangleCount * 3);
+        for (uint32_t t = 0; t < triangleCount; ++t)
+        {
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                outAdjacency.triangles[cursor[indices[t * 3 + c]]++] = t;
+            }
+        }
+    }
+
+    // tipsify from sander, nehab and barczak "fast triangle reordering for vertex locality and reduced overdraw",
+    // fans around the vertex that will stay in the cache longest and only jumps when nothing is left around it.
+    // every jump is a point where the cache is cold anyway, those split the output into clusters
+    void Tipsify(const IndexType* indices, const uint32_t triangleCount, const uint32_t vertexCount, std::vector<uint32_t>& outTriangles, std::vector<uint32_t>& outClusterStarts)
+    {
+        Adjacency adjacency;
+        BuildAdjacency(indices, triangleCount, vertexCount, adjacency);
+
+        std::vector<uint32_t> liveTriangles(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+        }
+
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        uint32_t time = c_meshOptimizerCacheSize + 1;
+        uint32_t scan = 0;
+
+        outTriangles.clear();
+        outTriangles.reserve(triangleCount);
+        outClusterStarts.clear();
+
+        const auto skipDeadEnd = [&]() -> uint32_t
+        {
+            while (!deadEnds.empty())
+            {
+                const uint32_t vertex = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveTriangles[vertex] > 0)
+                {
+                    return vertex;
+                }
+            }
+            for (; scan < vertexCount; ++scan)
+            {
+                if (liveTriangles[scan] > 0)
+                {
+                    return scan;
+                }
+            }
+            return c_invalidVertex;
+        };
+
+        uint32_t fanVertex = skipDeadEnd();
+        bool jumped = true;
+        while (fanVertex != c_invalidVertex)
+        {
+            if (jumped)
+            {
+                outClusterStarts.push_back(static_cast<uint32_t>(outTriangles.size()));
+            }
+
+            candidates.clear();
+            for (uint32_t a = adjacency.offsets[fanVertex]; a < adjacency.offsets[fanVertex + 1]; ++a)
+            {
+                const uint32_t triangle = adjacency.triangles[a];
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+
+                emitted[triangle] = true;
+                outTriangles.push_back(triangle);
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    const uint32_t vertex = indices[triangle * 3 + c];
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    --liveTriangles[vertex];
+                    if (time - cacheTime[vertex] > c_meshOptimizerCacheSize)
+                    {
+                        cacheTime[vertex] = time++;
+                    }
+                }
+            }
+
+            // prefers the candidate that's been in the cache longest but will still be there after its fan is emitted
+            uint32_t nextVertex = c_invalidVertex;
+            uint32_t bestPriority = 0;
+            for (const uint32_t vertex : candidates)
+            {
+                if (liveTriangles[vertex] == 0)
+                {
+                    continue;
+                }
+
+                uint32_t priority = 1;
+                if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= c_meshOptimizerCacheSize)
+                {
+                    priority = time - cacheTime[vertex] + 1;
+                }
+                if (nextVertex == c_invalidVertex || priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    nextVertex = vertex;
+                }
+            }
+
+            jumped = nextVertex == c_invalidVertex;
+            fanVertex = jumped ? skipDeadEnd() : nextVertex;
+        }
+    }
+
+    // clusters facing away from the middle of the mesh go first, they're the ones most likely to hide the rest
+    void SortClustersForOverdraw(const Mesh& mesh, const std::vector<uint32_t>& triangles, const std::vector<uint32_t>& clusterStarts, std::vector<uint32_t>& outTriangles)
+    {
+        const Vertex* vertices = mesh.GetVertex();
+        const IndexType* indices = mesh.GetIndex();
+        const uint32_t triangleCount = static_cast<uint32_t>(triangles.size());
+        const uint32_t clusterCount = static_cast<uint32_t>(clusterStarts.size());
+
+        Vector3 meshCentroid = { 0.0f, 0.0f, 0.0f };
+        for (int v = 0; v < mesh.vertexCount; ++v)
+        {
+            meshCentroid.x += vertices[v].position.x;
+            meshCentroid.y += vertices[v].position.y;
+            meshCentroid.z += vertices[v].position.z;
+        }
+        const float vertexScale = 1.0f / static_cast<float>(mesh.vertexCount);
+        meshCentroid = { meshCentroid.x * vertexScale, meshCentroid.y * vertexScale, meshCentroid.z * vertexScale };
+
+        std::vector<float> sortKeys(clusterCount);
+        for (uint32_t cluster = 0; cluster < clusterCount; ++cluster)
+        {
+            const uint32_t begin = clusterStarts[cluster];
+            const uint32_t end = cluster + 1 < clusterCount ? clusterStarts[cluster + 1] : triangleCount;
+
+            // area weighted, the cross products are twice the area which doesn't matter for the sign
+            Vector3 centroid = { 0.0f, 0.0f, 0.0f };
+            Vector3 normal = { 0.0f, 0.0f, 0.0f };
+            float area = 0.0f;
+            for (uint32_t t = begin; t < end; ++t)
+            {
+                const Vector3& p0 = vertices[indices[triangles[t] * 3 + 0]].position;
+                const Vector3& p1 = vertices[indices[triangles[t] * 3 + 1]].position;
+                const Vector3& p2 = vertices[indices[triangles[t] * 3 + 2]].position;
+
+                const Vector3 e0 = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+                const Vector3 e1 = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+                const Vector3 cross = { e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x };
+                const float triangleArea = std::sqrt(cross.x * cross.x + cross.y * cross.y + cross.z * cross.z);
+
+                normal = { normal.x + cross.x, normal.y + cross.y, normal.z + cross.z };
+                centroid.x += (p0.x + p1.x + p2.x) * triangleArea;
+                centroid.y += (p0.y + p1.y + p2.y) * triangleArea;
+                centroid.z += (p0.z + p1.z + p2.z) * triangleArea;
+                area += triangleArea;
+            }
+
+            if (area <= 0.0f)
+            {
+                sortKeys[cluster] = 0.0f;
+                continue;
+            }
+
+            const float areaScale = 1.0f / (3.0f * area);
+            centroid = { centroid.x * areaScale - meshCentroid.x, centroid.y * areaScale - meshCentroid.y, centroid.z * areaScale - meshCentroid.z };
+            sortKeys[cluster] = centroid.x * normal.x + centroid.y * normal.y + centroid.z * normal.z;
+        }
+
+        std::vector<uint32_t> clusterOrder(clusterCount);
+        for (uint32_t cluster = 0; cluster < clusterCount; ++cluster)
+        {
+            clusterOrder[cluster] = cluster;
+        }
+        // stable so flat meshes like the grid where every key is the same keep tipsify's order
+        std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](const uint32_t a, const uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+        outTriangles.clear();
+        outTriangles.reserve(triangleCount);
+        for (const uint32_t cluster : clusterOrder)
+        {
+            const uint32_t end = cluster + 1 < clusterCount ? clusterStarts[cluster + 1] : triangleCount;
+            outTriangles.insert(outTriangles.end(), triangles.begin() + clusterStarts[cluster], triangles.begin() + end);
+        }
+    }
+}
+
+void MeshOptimizer::MeasureCache(const IndexType* indices, const int indexCount, const int vertexCount, float& outAcmr, float& outAtvr)
+{
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<bool> referenced(vertexCount, false);
+    uint32_t time = c_meshOptimizerCacheSize + 1;
+    uint32_t misses = 0;
+    uint32_t referencedCount = 0;
+
+    for (int i = 0; i < indexCount; ++i)
+    {
+        const IndexType vertex = indices[i];
+        if (time - cacheTime[vertex] > c_meshOptimizerCacheSize)
+        {
+            cacheTime[vertex] = time++;
+            ++misses;
+        }
+        if (!referenced[vertex])
+        {
+            referenced[vertex] = true;
+            ++referencedCount;
+        }
+    }
+
+    outAcmr = indexCount > 0 ? static_cast<float>(misses) / static_cast<float>(indexCount / 3) : 0.0f;
+    outAtvr = referencedCount > 0 ? static_cast<float>(misses) / static_cast<float>(referencedCount) : 0.0f;
+}
+
+bool MeshOptimizer::Optimize(Mesh& mesh, OptimizeStats* outStats)
+{
+    if (mesh.buffer == nullptr || mesh.vertexCount <= 0 || mesh.indexCount <= 0 || mesh.indexCount % 3 != 0)
+    {
+        return false;
+    }
+
+    const uint32_t vertexCount = static_cast<uint32_t>(mesh.vertexCount);
+    const uint32_t triangleCount = static_cast<uint32_t>(mesh.indexCount / 3);
+    for (int i = 0; i < mesh.indexCount; ++i)
+    {
+        if (mesh.GetIndex()[i] >= vertexCount)
+        {
+            return false;
+        }
+    }
+
+    if (outStats != nullptr)
+    {
+        MeasureCache(mesh.GetIndex(), mesh.indexCount, mesh.vertexCount, outStats->acmrBefore, outStats->atvrBefore);
+    }
+
+    std::vector<uint32_t> tipsifyTriangles;
+    std::vector<uint32_t> clusterStarts;
+    Tipsify(mesh.GetIndex(), triangleCount, vertexCount, tipsifyTriangles, clusterStarts);
+
+    std::vector<uint32_t> triangles;
+    SortClustersForOverdraw(mesh, tipsifyTriangles, clusterStarts, triangles);
+
+    // vertices are renumbered in the order the triangles first use them so fetches walk the vertex buffer forwards,
+    // anything no triangle uses is dropped
+    std::vector<uint32_t> remap(vertexCount, c_invalidVertex);
+    std::vector<IndexType> indices(mesh.indexCount);
+    uint32_t usedVertexCount = 0;
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            const IndexType vertex = mesh.GetIndex()[triangles[t] * 3 + c];
+            if (remap[vertex] == c_invalidVertex)
+            {
+                remap[vertex] = usedVertexCount++;
+            }
+            indices[t * 3 + c] = remap[vertex];
+        }
+    }
+
+    Mesh optimizedMesh;
+    PrepareMesh(optimizedMesh, static_cast<int>(usedVertexCount), mesh.indexCount);
+    if (optimizedMesh.buffer.get() == nullptr)
+    {
+        return false;
+    }
+
+    for (uint32_t v = 0; v < vertexCount; ++v)
+    {
+        if (remap[v] != c_invalidVertex)
+        {
+            optimizedMesh.GetVertex()[remap[v]] = mesh.GetVertex()[v];
+        }
+    }
+    std::copy(indices.begin(), indices.end(), optimizedMesh.GetIndex());
+
+    mesh.buffer = std::move(optimizedMesh.buffer);
+    mesh.vertexCount = optimizedMesh.vertexCount;
+    mesh.indexCount = optimizedMesh.indexCount;
+
+    if (outStats != nullptr)
+    {
+        MeasureCache(mesh.GetIndex(), mesh.indexCount, mesh.vertexCount, outStats->acmrAfter, outStats->atvrAfter);
+    }
+
+    return true;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "meshloader/Mesh.h"
+#include "meshloader/MeshLoader.h"
+
+namespace MeshLoader
+{
+    // fifo size the triangle order is tuned for and the stats are measured with, most gpus hold at least this many
+    constexpr uint32_t c_meshOptimizerCacheSize = 16;
+
+    class MeshOptimizer
+    {
+    public:
+        static bool Optimize(Mesh& mesh, OptimizeStats* outStats);
+        // simulates a fifo post-transform cache over the index buffer
+        static void MeasureCache(const IndexType* indices, const int indexCount, const int vertexCount, float& outAcmr, float& outAtvr);
+    };
+}
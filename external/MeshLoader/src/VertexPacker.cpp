@@ -0,0 +1,276 @@
+#include "VertexPacker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace MeshLoader;
+
+namespace
+{
+    uint32_t GetPositionSize(const PositionFormat format)
+    {
+        // the 16 bit formats are padded out to four components, three component 16 bit vertex formats are rarely supported
+        return format == PositionFormat_Float32 ? sizeof(float) * 3 : sizeof(uint16_t) * 4;
+    }
+
+    uint32_t GetDirectionSize(const DirectionFormat format)
+    {
+        switch (format)
+        {
+        case DirectionFormat_Float32:
+            return sizeof(float) * 3;
+        case DirectionFormat_Octahedral16:
+            return sizeof(int16_t) * 2;
+        case DirectionFormat_None:
+        default:
+            return 0;
+        }
+    }
+
+    uint32_t GetTextureSize(const TextureFormat format)
+    {
+        return format == TextureFormat_Float32 ? sizeof(float) * 2 : sizeof(uint16_t) * 2;
+    }
+
+    // round to nearest even, anything too big for a half becomes infinity and anything too small flushes to zero
+    uint16_t FloatToHalf(const float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        const uint32_t sign = (bits >> 16) & 0x8000u;
+        const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xffu) - 127 + 15;
+        uint32_t mantissa = bits & 0x7fffffu;
+
+        if (exponent >= 31)
+        {
+            return static_cast<uint16_t>(sign | 0x7c00u);
+        }
+        if (exponent <= 0)
+        {
+            if (exponent < -10)
+            {
+                return static_cast<uint16_t>(sign);
+            }
+
+            // denormal, the implicit leading one has to be shifted in with the rest
+            mantissa |= 0x800000u;
+            const uint32_t shift = static_cast<uint32_t>(14 - exponent);
+            uint32_t half = mantissa >> shift;
+            const uint32_t remainder = mantissa & ((1u << shift) - 1);
+            const uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (half & 1u) != 0))
+            {
+                ++half;
+            }
+            return static_cast<uint16_t>(sign | half);
+        }
+
+        uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+        const uint32_t remainder = mantissa & 0x1fffu;
+        // a carry out of the mantissa bumps the exponent which is still the right answer
+        if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u) != 0))
+        {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint16_t FloatToUnorm16(const float value)
+    {
+        return static_cast<uint16_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f));
+    }
+
+    int16_t FloatToSnorm16(const float value)
+    {
+        return static_cast<int16_t>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+    }
+
+    // projects onto the octahedron |x| + |y| + |z| = 1 and folds the lower half over the upper one
+    void EncodeOctahedral(const Vector3& direction, int16_t* outEncoded)
+    {
+        const float length = std::fabs(direction.x) + std::fabs(direction.y) + std::fabs(direction.z);
+        if (length <= 0.0f)
+        {
+            outEncoded[0] = 0;
+            outEncoded[1] = 0;
+            return;
+        }
+
+        float x = direction.x / length;
+        float y = direction.y / length;
+        if (direction.z < 0.0f)
+        {
+            const float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            const float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = foldedX;
+            y = foldedY;
+        }
+
+        outEncoded[0] = FloatToSnorm16(x);
+        outEncoded[1] = FloatToSnorm16(y);
+    }
+
+    void PackDirection(const Vector3& direction, const DirectionFormat format, char* outData)
+    {
+        if (format == DirectionFormat_Float32)
+        {
+            memcpy(outData, &direction, sizeof(float) * 3);
+        }
+        else if (format == DirectionFormat_Octahedral16)
+        {
+            int16_t encoded[2];
+            EncodeOctahedral(direction, encoded);
+            memcpy(outData, encoded, sizeof(encoded));
+        }
+    }
+}
+
+VertexLayout VertexPacker::GetLayout(const VertexFormat& format)
+{
+    VertexLayout layout;
+
+    // every size is a multiple of four so every attribute stays four byte aligned
+    layout.positionOffset = layout.stride;
+    layout.stride += GetPositionSize(format.position);
+
+    if (format.normal != DirectionFormat_None)
+    {
+        layout.normalOffset = layout.stride;
+        layout.stride += GetDirectionSize(format.normal);
+    }
+
+    if (format.tangent != DirectionFormat_None)
+    {
+        layout.tangentOffset = layout.stride;
+        layout.stride += GetDirectionSize(format.tangent);
+    }
+
+    layout.textureOffset = layout.stride;
+    layout.stride += GetTextureSize(format.texture);
+
+    return layout;
+}
+
+bool VertexPacker::Pack(const Vertex* vertices, const int vertexCount, const VertexFormat& format, PackedVertices& outPackedVertices)
+{
+    if (vertices == nullptr || vertexCount <= 0)
+    {
+        return false;
+    }
+
+    const VertexLayout layout = GetLayout(format);
+
+    outPackedVertices.buffer.reset(new char[static_cast<std::size_t>(layout.stride) * vertexCount]);
+    if (outPackedVertices.buffer == nullptr)
+    {
+        return false;
+    }
+
+    outPackedVertices.vertexCount = vertexCount;
+    outPackedVertices.format = format;
+    outPackedVertices.layout = layout;
+
+    Vector3 positionMin = vertices[0].position;
+    Vector3 positionMax = vertices[0].position;
+    Vector2 textureMin = vertices[0].texture;
+    Vector2 textureMax = vertices[0].texture;
+    for (int i = 1; i < vertexCount; ++i)
+    {
+        const Vector3& position = vertices[i].position;
+        positionMin = { std::min(positionMin.x, position.x), std::min(positionMin.y, position.y), std::min(positionMin.z, position.z) };
+        positionMax = { std::max(positionMax.x, position.x), std::max(positionMax.y, position.y), std::max(positionMax.z, position.z) };
+
+        const Vector2& texture = vertices[i].texture;
+        textureMin = { std::min(textureMin.x, texture.x), std::min(textureMin.y, texture.y) };
+        textureMax = { std::max(textureMax.x, texture.x), std::max(textureMax.y, texture.y) };
+    }
+
+    const Vector3 positionExtent = { positionMax.x - positionMin.x, positionMax.y - positionMin.y, positionMax.z - positionMin.z };
+    const Vector2 textureExtent = { textureMax.x - textureMin.x, textureMax.y - textureMin.y };
+
+    // an axis the mesh is flat along gets a scale of zero so it comes back as the offset whatever is stored
+    Vector3 positionScale = { 1.0f, 1.0f, 1.0f };
+    Vector3 positionOffset = { 0.0f, 0.0f, 0.0f };
+    if (format.position == PositionFormat_Float16)
+    {
+        positionScale = { positionExtent.x * 0.5f, positionExtent.y * 0.5f, positionExtent.z * 0.5f };
+        positionOffset = { positionMin.x + positionScale.x, positionMin.y + positionScale.y, positionMin.z + positionScale.z };
+    }
+    else if (format.position == PositionFormat_Unorm16)
+    {
+        positionScale = positionExtent;
+        positionOffset = positionMin;
+    }
+
+    Vector2 textureScale = { 1.0f, 1.0f };
+    Vector2 textureOffset = { 0.0f, 0.0f };
+    if (format.texture == TextureFormat_Unorm16)
+    {
+        textureScale = textureExtent;
+        textureOffset = textureMin;
+    }
+
+    outPackedVertices.positionScale = positionScale;
+    outPackedVertices.positionOffset = positionOffset;
+    outPackedVertices.textureScale = textureScale;
+    outPackedVertices.textureOffset = textureOffset;
+
+    const auto normalize = [](const float value, const float offset, const float scale) { return scale != 0.0f ? (value - offset) / scale : 0.0f; };
+
+    for (int i = 0; i < vertexCount; ++i)
+    {
+        const Vertex& vertex = vertices[i];
+        char* packedVertex = outPackedVertices.buffer.get() + static_cast<std::size_t>(layout.stride) * i;
+
+        char* position = packedVertex + layout.positionOffset;
+        if (format.position == PositionFormat_Float32)
+        {
+            memcpy(position, &vertex.position, sizeof(float) * 3);
+        }
+        else
+        {
+            const float normalized[3] =
+            {
+                normalize(vertex.position.x, positionOffset.x, positionScale.x),
+                normalize(vertex.position.y, positionOffset.y, positionScale.y),
+                normalize(vertex.position.z, positionOffset.z, positionScale.z),
+            };
+
+            uint16_t encoded[4] = { 0, 0, 0, 0 };
+            for (int c = 0; c < 3; ++c)
+            {
+                encoded[c] = format.position == PositionFormat_Float16 ? FloatToHalf(normalized[c]) : FloatToUnorm16(normalized[c]);
+            }
+            memcpy(position, encoded, sizeof(encoded));
+        }
+
+        if (layout.normalOffset != c_vertexAttributeAbsent)
+        {
+            PackDirection(vertex.normal, format.normal, packedVertex + layout.normalOffset);
+        }
+
+        if (layout.tangentOffset != c_vertexAttributeAbsent)
+        {
+            PackDirection(vertex.tangent, format.tangent, packedVertex + layout.tangentOffset);
+        }
+
+        char* texture = packedVertex + layout.textureOffset;
+        if (format.texture == TextureFormat_Float32)
+        {
+            memcpy(texture, &vertex.texture, sizeof(float) * 2);
+        }
+        else
+        {
+            const uint16_t encoded[2] =
+            {
+                FloatToUnorm16(normalize(vertex.texture.x, textureOffset.x, textureScale.x)),
+                FloatToUnorm16(normalize(vertex.texture.y, textureOffset.y, textureScale.y)),
+            };
+            memcpy(texture, encoded, sizeof(encoded));
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "meshloader/VertexFormat.h"
+
+namespace MeshLoader
+{
+    class VertexPacker
+    {
+    public:
+        static VertexLayout GetLayout(const VertexFormat& format);
+        static bool Pack(const Vertex* vertices, const int vertexCount, const VertexFormat& format, PackedVertices& outPackedVertices);
+    };
+}
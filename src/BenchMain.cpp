@@ -0,0 +1,24 @@
+#include <string>
+
+#include "DuckDemoBench.h"
+
+int main(int argc, char** argv)
+{
+    std::string outputPath = "bench_results";
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--bench-output" && i + 1 < argc)
+        {
+            outputPath = argv[++i];
+        }
+    }
+
+    DuckDemoBench Bench(outputPath);
+    const int result = Bench.Run(argc, argv);
+    if (result != 0)
+    {
+        return result;
+    }
+
+    return Bench.WriteResults() ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+#include "CpuProfiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "DuckDemoUtils.h"
+
+// 64k events per thread is a couple of thousand frames of the main thread at 24 bytes an event
+constexpr uint64_t c_cpuProfilerRingSize = 1u << 16;
+
+struct CpuProfilerThreadBuffer
+{
+    std::unique_ptr<CpuProfilerEvent[]> m_events;
+    // only the owning thread writes, readers use it to find out which slots are complete
+    std::atomic<uint64_t> m_writeIndex;
+    uint32_t m_threadId = 0;
+    std::string m_threadName;
+};
+
+// taken at startup and compared against a second pair when a trace is written to find the tick rate
+static const int64_t s_cpuProfilerCalibrationTicks = CpuProfiler::Now();
+static const int64_t s_cpuProfilerCalibrationNanoseconds = CpuProfiler::NowNanoseconds();
+
+static std::mutex s_cpuProfilerMutex;
+// buffers are never freed while the game runs so a dump still sees the events of threads that already exited
+static std::vector<std::unique_ptr<CpuProfilerThreadBuffer>> s_cpuProfilerThreadBuffers;
+static thread_local CpuProfilerThreadBuffer* t_cpuProfilerThreadBuffer = nullptr;
+
+static CpuProfilerThreadBuffer* RegisterThreadBuffer()
+{
+    std::unique_ptr<CpuProfilerThreadBuffer> threadBuffer(new CpuProfilerThreadBuffer());
+    threadBuffer->m_events.reset(new CpuProfilerEvent[c_cpuProfilerRingSize]);
+    threadBuffer->m_writeIndex.store(0, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(s_cpuProfilerMutex);
+    threadBuffer->m_threadId = static_cast<uint32_t>(s_cpuProfilerThreadBuffers.size());
+    threadBuffer->m_threadName = DuckDemoUtils::format("Thread %u", threadBuffer->m_threadId);
+    s_cpuProfilerThreadBuffers.push_back(std::move(threadBuffer));
+    return s_cpuProfilerThreadBuffers.back().get();
+}
+
+static void WriteJsonString(FILE* file, const char* string)
+{
+    fputc('"', file);
+    for (const char* c = string; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fputc('\\', file);
+        }
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+void CpuProfiler::Record(const char* name, const int64_t start, const int64_t end)
+{
+    CpuProfilerThreadBuffer* threadBuffer = t_cpuProfilerThreadBuffer;
+    if (threadBuffer == nullptr)
+    {
+        threadBuffer = RegisterThreadBuffer();
+        t_cpuProfilerThreadBuffer = threadBuffer;
+    }
+
+    const uint64_t writeIndex = threadBuffer->m_writeIndex.load(std::memory_order_relaxed);
+    CpuProfilerEvent& event = threadBuffer->m_events[writeIndex & (c_cpuProfilerRingSize - 1)];
+    event.m_name = name;
+    event.m_start = start;
+    event.m_end = end;
+    threadBuffer->m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+}
+
+void CpuProfiler::SetThreadName(const std::string& threadName)
+{
+    if (t_cpuProfilerThreadBuffer == nullptr)
+    {
+        t_cpuProfilerThreadBuffer = RegisterThreadBuffer();
+    }
+
+    std::lock_guard<std::mutex> lock(s_cpuProfilerMutex);
+    t_cpuProfilerThreadBuffer->m_threadName = threadName;
+}
+
+bool CpuProfiler::WriteChromeTrace(const std::string& path)
+{
+    DUCK_DEMO_CPU_SCOPE("CpuProfiler::WriteChromeTrace");
+
+    struct ThreadEvents
+    {
+        uint32_t threadId = 0;
+        std::string threadName;
+        std::vector<CpuProfilerEvent> events;
+    };
+
+    std::vector<ThreadEvents> threadEvents;
+    int64_t baseTime = INT64_MAX;
+    {
+        std::lock_guard<std::mutex> lock(s_cpuProfilerMutex);
+        for (const std::unique_ptr<CpuProfilerThreadBuffer>& threadBuffer : s_cpuProfilerThreadBuffers)
+        {
+            ThreadEvents& thread = threadEvents.emplace_back();
+            thread.threadId = threadBuffer->m_threadId;
+            thread.threadName = threadBuffer->m_threadName;
+
+            const uint64_t endIndex = threadBuffer->m_writeIndex.load(std::memory_order_acquire);
+            const uint64_t beginIndex = endIndex > c_cpuProfilerRingSize ? endIndex - c_cpuProfilerRingSize : 0;
+            thread.events.reserve(static_cast<size_t>(endIndex - beginIndex));
+            for (uint64_t i = beginIndex; i < endIndex; ++i)
+            {
+                thread.events.push_back(threadBuffer->m_events[i & (c_cpuProfilerRingSize - 1)]);
+            }
+
+            // the owning thread keeps writing while we copy, anything it may have lapped in the meantime is dropped
+            const uint64_t lappedIndex = threadBuffer->m_writeIndex.load(std::memory_order_acquire);
+            if (lappedIndex > c_cpuProfilerRingSize && lappedIndex - c_cpuProfilerRingSize > beginIndex)
+            {
+                const size_t lappedCount = static_cast<size_t>(std::min(lappedIndex - c_cpuProfilerRingSize - beginIndex, endIndex - beginIndex));
+                thread.events.erase(thread.events.begin(), thread.events.begin() + lappedCount);
+            }
+
+            for (const CpuProfilerEvent& event : thread.events)
+            {
+                baseTime = std::min(baseTime, event.m_start);
+            }
+        }
+    }
+
+    const int64_t elapsedTicks = CpuProfiler::Now() - s_cpuProfilerCalibrationTicks;
+    const int64_t elapsedNanoseconds = CpuProfiler::NowNanoseconds() - s_cpuProfilerCalibrationNanoseconds;
+    const double microsecondsPerTick = elapsedTicks > 0 && elapsedNanoseconds > 0 ? 1e-3 * static_cast<double>(elapsedNanoseconds) / static_cast<double>(elapsedTicks) : 1e-3;
+
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        DUCK_DEMO_SHOW_ERROR("CpuProfiler Error", DuckDemoUtils::format("Failed to open %s for writing", path.c_str()));
+        return false;
+    }
+
+    size_t eventCount = 0;
+    bool firstEvent = true;
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (const ThreadEvents& thread : threadEvents)
+    {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":", firstEvent ? "" : ",\n", thread.threadId);
+        WriteJsonString(file, thread.threadName.c_str());
+        fprintf(file, "}}");
+        firstEvent = false;
+
+        for (const CpuProfilerEvent& event : thread.events)
+        {
+            fprintf(file, ",\n{\"name\":");
+            WriteJsonString(file, event.m_name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                thread.threadId,
+                static_cast<double>(event.m_start - baseTime) * microsecondsPerTick,
+                static_cast<double>(event.m_end - event.m_start) * microsecondsPerTick);
+        }
+        eventCount += thread.events.size();
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    SDL_Log("CpuProfiler: wrote %zu events to %s", eventCount, path.c_str());
+
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// reading the tsc is several times cheaper than going through the os clock, ticks are converted to time when a trace is written
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define DUCK_DEMO_CPU_PROFILER_TSC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #include <x86intrin.h>
+    #define DUCK_DEMO_CPU_PROFILER_TSC
+#endif
+
+struct CpuProfilerEvent
+{
+    // must point at a string literal, only the pointer is stored
+    const char* m_name = nullptr;
+    int64_t m_start = 0;
+    int64_t m_end = 0;
+};
+
+namespace CpuProfiler
+{
+    inline int64_t NowNanoseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // in ticks, not nanoseconds, unless the tsc isn't available
+    inline int64_t Now()
+    {
+#ifdef DUCK_DEMO_CPU_PROFILER_TSC
+        return static_cast<int64_t>(__rdtsc());
+#else
+        return NowNanoseconds();
+#endif // DUCK_DEMO_CPU_PROFILER_TSC
+    }
+
+    // appends to the calling thread's ring, the first call on a thread registers the ring and is the only one that locks
+    void Record(const char* name, const int64_t start, const int64_t end);
+    void SetThreadName(const std::string& threadName);
+
+    // chrome about:tracing / perfetto json of everything still in the rings
+    bool WriteChromeTrace(const std::string& path);
+}
+
+class CpuProfilerScope
+{
+public:
+    explicit CpuProfilerScope(const char* name)
+        : m_name(name)
+        , m_start(CpuProfiler::Now())
+    {
+    }
+
+    ~CpuProfilerScope()
+    {
+        CpuProfiler::Record(m_name, m_start, CpuProfiler::Now());
+    }
+
+    CpuProfilerScope(const CpuProfilerScope&) = delete;
+    CpuProfilerScope& operator=(const CpuProfilerScope&) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_start;
+};
+
+#define DUCK_DEMO_CPU_PROFILER_CONCAT_INNER(a, b) a##b
+#define DUCK_DEMO_CPU_PROFILER_CONCAT(a, b) DUCK_DEMO_CPU_PROFILER_CONCAT_INNER(a, b)
+
+#ifndef DUCK_DEMO_DISABLE_CPU_PROFILER
+    #define DUCK_DEMO_CPU_SCOPE(name) CpuProfilerScope DUCK_DEMO_CPU_PROFILER_CONCAT(cpuProfilerScope, __LINE__)(name)
+#else
+    #define DUCK_DEMO_CPU_SCOPE(name)
+#endif // DUCK_DEMO_DISABLE_CPU_PROFILER
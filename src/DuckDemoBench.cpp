@@ -0,0 +1,201 @@
+#include "DuckDemoBench.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+
+constexpr double c_benchFixedDeltaTime = 1.0 / 60.0;
+constexpr double c_benchPathDuration = 30.0;
+// the first frames pay for pipeline and descriptor first use so they are written to the csv but left out of the summary
+constexpr size_t c_benchWarmupFrameCount = 60;
+
+// closed loop around the duck, OnInit puts m_initialCameraPosition in front of these so the bench starts where the demo does
+static const std::array<glm::vec3, DuckDemoBench::c_cameraKeyCount - 1> s_benchCameraKeys =
+{
+    glm::vec3(-600.0f, -300.0f, -500.0f),
+    glm::vec3(-700.0f, -80.0f, 300.0f),
+    glm::vec3(0.0f, -40.0f, 900.0f),
+    glm::vec3(650.0f, -900.0f, 400.0f),
+    glm::vec3(300.0f, -150.0f, -200.0f),
+};
+static const glm::vec3 s_benchCameraTarget = glm::vec3(0.0f, -2.0f, 0.0f);
+
+struct BenchSummary
+{
+    size_t count = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+static glm::vec3 CatmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, const float t)
+{
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+    return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+static BenchSummary Summarize(std::vector<double> values)
+{
+    BenchSummary summary;
+    summary.count = values.size();
+    if (values.empty())
+    {
+        return summary;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    // nearest rank so every reported percentile is a frame that actually happened
+    auto percentile = [&values](const double p)
+    {
+        const size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+        return values[std::min(std::max(rank, static_cast<size_t>(1)), values.size()) - 1];
+    };
+
+    double total = 0.0;
+    for (double value : values)
+    {
+        total += value;
+    }
+
+    summary.mean = total / values.size();
+    summary.p50 = percentile(0.50);
+    summary.p95 = percentile(0.95);
+    summary.p99 = percentile(0.99);
+    summary.max = values.back();
+    return summary;
+}
+
+static void WriteSummary(FILE* file, const char* name, const BenchSummary& summary, const bool last)
+{
+    if (summary.count == 0)
+    {
+        fprintf(file, "    \"%s\": null%s\n", name, last ? "" : ",");
+        return;
+    }
+
+    fprintf(file, "    \"%s\": { \"count\": %zu, \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+        name, summary.count, summary.mean, summary.p50, summary.p95, summary.p99, summary.max, last ? "" : ",");
+}
+
+DuckDemoBench::DuckDemoBench(const std::string& outputPath)
+    : m_outputPath(outputPath)
+{
+}
+
+bool DuckDemoBench::OnInit()
+{
+    if (!DuckDemoGame::OnInit())
+    {
+        return false;
+    }
+
+    m_cameraKeys[0] = m_initialCameraPosition;
+    std::copy(s_benchCameraKeys.begin(), s_benchCameraKeys.end(), m_cameraKeys.begin() + 1);
+
+    SetFixedDeltaTime(c_benchFixedDeltaTime);
+    m_samples.reserve(static_cast<size_t>(c_benchPathDuration / c_benchFixedDeltaTime) + c_maxFramesInFlight);
+
+    return true;
+}
+
+void DuckDemoBench::UpdateCamera(const GameTimer& gameTimer)
+{
+    const double pathTime = gameTimer.TotalTime();
+    if (pathTime >= c_benchPathDuration)
+    {
+        QuitGame();
+    }
+
+    const size_t keyCount = m_cameraKeys.size();
+    const double pathPosition = std::fmod(pathTime / c_benchPathDuration, 1.0) * keyCount;
+    const size_t segment = static_cast<size_t>(pathPosition);
+    const float t = static_cast<float>(pathPosition - segment);
+
+    m_cameraPosition = CatmullRom(
+        m_cameraKeys[(segment + keyCount - 1) % keyCount],
+        m_cameraKeys[segment % keyCount],
+        m_cameraKeys[(segment + 1) % keyCount],
+        m_cameraKeys[(segment + 2) % keyCount],
+        t);
+
+    // inverse of the forward vector UpdateCamera builds from the two angles so the duck stays in view
+    const glm::vec3 cameraForward = glm::normalize(s_benchCameraTarget - m_cameraPosition);
+    m_cameraRotationX = DuckDemoUtils::WrapAngle<float>(glm::degrees(std::atan2(cameraForward.x, cameraForward.z)));
+    m_cameraRotationY = DuckDemoUtils::WrapAngle<float>(glm::degrees(std::asin(-cameraForward.y)));
+
+    m_cameraRotation = glm::quat(glm::vec3(glm::radians(m_cameraRotationY), glm::radians(m_cameraRotationX), 0.0f));
+}
+
+void DuckDemoBench::OnFrameRetired(const uint64_t frameNumber, const double cpuTime, const double gpuTime)
+{
+    BenchFrameSample& sample = m_samples.emplace_back();
+    sample.m_frameNumber = frameNumber;
+    sample.m_cpuTime = cpuTime;
+    sample.m_gpuTime = gpuTime;
+}
+
+bool DuckDemoBench::WriteResults() const
+{
+    const std::string csvPath = m_outputPath + ".csv";
+    FILE* csvFile = fopen(csvPath.c_str(), "w");
+    if (csvFile == nullptr)
+    {
+        DUCK_DEMO_SHOW_ERROR("Bench Error", DuckDemoUtils::format("Failed to open %s for writing", csvPath.c_str()));
+        return false;
+    }
+
+    fprintf(csvFile, "frame,cpu_ms,gpu_ms\n");
+    for (const BenchFrameSample& sample : m_samples)
+    {
+        if (sample.m_gpuTime >= 0.0)
+        {
+            fprintf(csvFile, "%llu,%.4f,%.4f\n", static_cast<unsigned long long>(sample.m_frameNumber), sample.m_cpuTime * 1000.0, sample.m_gpuTime * 1000.0);
+        }
+        else
+        {
+            fprintf(csvFile, "%llu,%.4f,\n", static_cast<unsigned long long>(sample.m_frameNumber), sample.m_cpuTime * 1000.0);
+        }
+    }
+    fclose(csvFile);
+
+    std::vector<double> cpuTimes;
+    std::vector<double> gpuTimes;
+    for (size_t i = c_benchWarmupFrameCount; i < m_samples.size(); ++i)
+    {
+        cpuTimes.push_back(m_samples[i].m_cpuTime * 1000.0);
+        if (m_samples[i].m_gpuTime >= 0.0)
+        {
+            gpuTimes.push_back(m_samples[i].m_gpuTime * 1000.0);
+        }
+    }
+
+    const std::string jsonPath = m_outputPath + ".json";
+    FILE* jsonFile = fopen(jsonPath.c_str(), "w");
+    if (jsonFile == nullptr)
+    {
+        DUCK_DEMO_SHOW_ERROR("Bench Error", DuckDemoUtils::format("Failed to open %s for writing", jsonPath.c_str()));
+        return false;
+    }
+
+    fprintf(jsonFile, "{\n");
+    fprintf(jsonFile, "    \"frames\": %zu,\n", m_samples.size());
+    fprintf(jsonFile, "    \"warmup_frames\": %zu,\n", std::min(c_benchWarmupFrameCount, m_samples.size()));
+    fprintf(jsonFile, "    \"fixed_delta_time\": %.6f,\n", c_benchFixedDeltaTime);
+    fprintf(jsonFile, "    \"width\": %u,\n", GetVulkanSwapchainWidth());
+    fprintf(jsonFile, "    \"height\": %u,\n", GetVulkanSwapchainHeight());
+    fprintf(jsonFile, "    \"frames_in_flight\": %u,\n", GetFramesInFlightCount());
+    fprintf(jsonFile, "    \"headless\": %s,\n", IsHeadless() ? "true" : "false");
+    WriteSummary(jsonFile, "cpu_ms", Summarize(cpuTimes), false);
+    WriteSummary(jsonFile, "gpu_ms", Summarize(gpuTimes), true);
+    fprintf(jsonFile, "}\n");
+    fclose(jsonFile);
+
+    SDL_Log("Bench: wrote %s and %s", csvPath.c_str(), jsonPath.c_str());
+
+    return true;
+}
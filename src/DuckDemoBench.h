@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "DuckDemoGame.h"
+
+struct BenchFrameSample
+{
+    uint64_t m_frameNumber = 0;
+    double m_cpuTime = 0.0;
+    double m_gpuTime = 0.0;
+};
+
+// flies DuckDemoGame along a fixed camera spline with a fixed timestep so runs can be compared across commits and machines
+class DuckDemoBench : public DuckDemoGame
+{
+public:
+    static constexpr size_t c_cameraKeyCount = 6;
+
+    DuckDemoBench(const std::string& outputPath);
+
+    // writes <outputPath>.csv with every frame and <outputPath>.json with the p50/p95/p99 summary
+    bool WriteResults() const;
+
+private:
+    virtual bool OnInit() override;
+    virtual void UpdateCamera(const GameTimer& gameTimer) override;
+    virtual void OnFrameRetired(const uint64_t frameNumber, const double cpuTime, const double gpuTime) override;
+
+    std::string m_outputPath;
+    std::array<glm::vec3, c_cameraKeyCount> m_cameraKeys;
+    std::vector<BenchFrameSample> m_samples;
+};
@@ -8,6 +8,20 @@
 
 #include "meshloader/MeshLoader.h"
 
+#include "CpuProfiler.h"
+#include "TaskGroup.h"
+
+// the duck is small enough for half positions around its own bounds, nothing reads tangents so they're left out
+static MeshLoader::VertexFormat GetMeshVertexFormat()
+{
+    MeshLoader::VertexFormat vertexFormat;
+    vertexFormat.position = MeshLoader::PositionFormat_Float16;
+    vertexFormat.normal = MeshLoader::DirectionFormat_Octahedral16;
+    vertexFormat.tangent = MeshLoader::DirectionFormat_None;
+    vertexFormat.texture = MeshLoader::TextureFormat_Unorm16;
+    return vertexFormat;
+}
+
 DuckDemoGame::~DuckDemoGame()
 {
     for (MeshRenderPass& meshRenderPass : m_meshRenderPasses)
@@ -25,23 +39,28 @@ DuckDemoGame::~DuckDemoGame()
 
 bool DuckDemoGame::OnInit()
 {
+    // the render passes only create device objects, load shaders and build pipelines so they can all go at once,
+    // the compute pass uploads through the allocator and the queue so it stays on this thread while they run
+    TaskGroup initTaskGroup;
+    Init_TaskGroup(initTaskGroup, IsParallelInitEnabled());
     {
         MeshRenderPassParams params;
         params.m_maxRenderObjectCount = 1;
+        params.m_vertexFormat = GetMeshVertexFormat();
 
         params.m_wireframe = false;
         params.m_transparencyBlending = true;
-        if (!Init_MeshRenderPass(m_meshRenderPasses[RenderPassType_Default], params))
+        Add_TaskGroup(initTaskGroup, "Init MeshRenderPass", [this, params]()
         {
-            return false;
-        }
+            return Init_MeshRenderPass(m_meshRenderPasses[RenderPassType_Default], params);
+        });
 
         params.m_wireframe = true;
         params.m_transparencyBlending = false;
-        if (!Init_MeshRenderPass(m_meshRenderPasses[RenderPassType_Wireframe], params))
+        Add_TaskGroup(initTaskGroup, "Init MeshRenderPass Wireframe", [this, params]()
         {
-            return false;
-        }
+            return Init_MeshRenderPass(m_meshRenderPasses[RenderPassType_Wireframe], params);
+        });
     }
 
     {
@@ -49,25 +68,38 @@ bool DuckDemoGame::OnInit()
         params.m_maxRenderObjectCount = 1;
 
         params.m_wireframe = false;
-        if (!Init_WaterRenderPass(m_waterRenderPasses[RenderPassType_Default], params))
+        Add_TaskGroup(initTaskGroup, "Init WaterRenderPass", [this, params]()
         {
-            return false;
-        }
+            return Init_WaterRenderPass(m_waterRenderPasses[RenderPassType_Default], params);
+        });
 
         params.m_wireframe = true;
-        if (!Init_WaterRenderPass(m_waterRenderPasses[RenderPassType_Wireframe], params))
+        Add_TaskGroup(initTaskGroup, "Init WaterRenderPass Wireframe", [this, params]()
         {
-            return false;
-        }
+            return Init_WaterRenderPass(m_waterRenderPasses[RenderPassType_Wireframe], params);
+        });
     }
 
+    const std::chrono::high_resolution_clock::time_point computeInitStartTime = std::chrono::high_resolution_clock::now();
     WaterComputePassParams waterComputePassParams;
     waterComputePassParams.width = 1024;
-    if (!Init_WaterComputePass(m_waterComputePass, waterComputePassParams))
+    waterComputePassParams.baked = IsBakedWavesEnabled();
+    const bool computeInitResult = Init_WaterComputePass(m_waterComputePass, waterComputePassParams);
+    const double computeInitTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - computeInitStartTime).count();
+
+    // has to be waited on even if the compute pass failed, the tasks write into this object
+    const bool initTaskResult = Wait_TaskGroup(initTaskGroup);
+    if (!computeInitResult || !initTaskResult)
     {
         return false;
     }
 
+    for (const std::unique_ptr<TaskGroupTask>& task : initTaskGroup.m_tasks)
+    {
+        SDL_Log("Startup: %s took %.1f ms", task->m_name, task->m_time * 1e3);
+    }
+    SDL_Log("Startup: Init WaterComputePass took %.1f ms", computeInitTime * 1e3);
+
     {
         RenderObject& renderObject = m_duckRenderObject;
         renderObject.objectBufferIndex = 0;
@@ -83,7 +115,6 @@ bool DuckDemoGame::OnInit()
         renderObject.objectBuf.uRoughness = 0.2f;
         renderObject.objectBuf.uTextureIndex = static_cast<uint>(renderObject.objectBufferIndex);
 
-        UpdateObjectBuffer(renderObject, false);
         UpdateObjectTexture(renderObject, "data/RubberDuck/10602_Rubber_Duck_v1_diffuse.png", false);
         UpdateModel(renderObject, "data/RubberDuck/10602_Rubber_Duck_v1_L3.obj");
     }
@@ -102,58 +133,59 @@ bool DuckDemoGame::OnInit()
         renderObject.objectBuf.uRoughness = 0.2f;
         renderObject.objectBuf.uTextureIndex = static_cast<uint>(renderObject.objectBufferIndex);
 
-        UpdateObjectBuffer(renderObject, true);
         UpdateObjectTexture(renderObject, "data/FloorTiles/FloorTilesDeffuse.png", true);
-        UpdateWaterPrimitive(renderObject, 50000.0f, 50000.0f, 1000, 1000);
+        UpdateWaterPatch(renderObject);
+
+        m_waterLodParams.m_maxHeight = c_waterComputePassMaxHeight;
     }
 
     m_cameraRotationX = m_initialCameraRotationX;
     m_cameraRotationY = m_initialCameraRotationY;
     m_cameraPosition = m_initialCameraPosition;
-    UpdateFrameBuffer();
 
     return true;
 }
 
-void DuckDemoGame::UpdateObjectBuffer(RenderObject& renderObject, const bool waterPass /* = false */)
+void DuckDemoGame::UpdateObjectBuffer(RenderObject& renderObject)
 {
-    if (waterPass)
-    {
-        for (WaterRenderPass& waterRenderPass : m_waterRenderPasses)
-        {
-            FillVulkanBuffer(
-                waterRenderPass.m_vulkanObjectBuffer, 
-                &renderObject.objectBuf, 
-                sizeof(renderObject.objectBuf), 
-                CalculateUniformBufferSize(sizeof(renderObject.objectBuf)) * renderObject.objectBufferIndex);
-        }
-    }
-    else
+    // the ring is reset every frame so even objects that never move are pushed again
+    renderObject.m_objectBufOffset = Push_UniformRingBuffer(m_uniformRingBuffer, &renderObject.objectBuf, sizeof(renderObject.objectBuf));
+}
+
+void DuckDemoGame::UpdateObjectTexture(RenderObject& renderObject, const std::string& texturePath, const bool waterPass /* = false */)
+{
+    DUCK_DEMO_CPU_SCOPE("DuckDemoGame::UpdateObjectTexture");
+
+    // the placeholder goes in every frame until the texture is ready, BindObjectTexture swaps them over one frame at a time
+    renderObject.m_texture = Load_TextureLoader(m_textureLoader, texturePath);
+    renderObject.m_textureBoundFrames = 0;
+    renderObject.m_waterPass = waterPass;
+
+    for (uint32_t frameIndex = 0; frameIndex < GetFramesInFlightCount(); ++frameIndex)
     {
-        for (MeshRenderPass& meshRenderPass : m_meshRenderPasses)
-        {
-            FillVulkanBuffer(
-                meshRenderPass.m_vulkanObjectBuffer, 
-                &renderObject.objectBuf, 
-                sizeof(renderObject.objectBuf), 
-                CalculateUniformBufferSize(sizeof(renderObject.objectBuf)) * renderObject.objectBufferIndex);
-        }
+        WriteObjectTextureDescriptor(renderObject, frameIndex, GetImageView_TextureLoader(m_textureLoader, nullptr));
     }
 }
 
-void DuckDemoGame::UpdateObjectTexture(RenderObject& renderObject, const std::string& texturePath, const bool waterPass /* = false */)
+void DuckDemoGame::BindObjectTexture(RenderObject& renderObject)
 {
-    renderObject.m_texture.reset(new VulkanTexture());
-    VkResult result = CreateVulkanTexture(texturePath, *renderObject.m_texture.get());
-    if (result != VK_SUCCESS)
+    const uint32_t frameIndex = GetCurrentFrameIndex();
+    const uint32_t frameBit = 1u << frameIndex;
+    if (renderObject.m_texture == nullptr || !renderObject.m_texture->m_ready || (renderObject.m_textureBoundFrames & frameBit) != 0)
     {
-        DUCK_DEMO_VULKAN_ASSERT(result);
         return;
     }
 
+    // only this frame's sets are safe to write, the others may still be in use by the gpu
+    WriteObjectTextureDescriptor(renderObject, frameIndex, renderObject.m_texture->m_imageView);
+    renderObject.m_textureBoundFrames |= frameBit;
+}
+
+void DuckDemoGame::WriteObjectTextureDescriptor(const RenderObject& renderObject, const uint32_t frameIndex, VkImageView imageView)
+{
     VkDescriptorImageInfo descriptorImageInfo;
     descriptorImageInfo.sampler = nullptr;
-    descriptorImageInfo.imageView = renderObject.m_texture->m_imageView;
+    descriptorImageInfo.imageView = imageView;
     descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
     VkWriteDescriptorSet sampledImageWriteDescriptorSet;
@@ -167,11 +199,11 @@ void DuckDemoGame::UpdateObjectTexture(RenderObject& renderObject, const std::st
     sampledImageWriteDescriptorSet.pImageInfo = &descriptorImageInfo;
     sampledImageWriteDescriptorSet.pTexelBufferView = nullptr;
 
-    if (waterPass)
+    if (renderObject.m_waterPass)
     {
         for (WaterRenderPass& waterRenderPass : m_waterRenderPasses)
         {
-            sampledImageWriteDescriptorSet.dstSet = waterRenderPass.m_vulkanDescriptorSets[3];
+            sampledImageWriteDescriptorSet.dstSet = waterRenderPass.m_vulkanDescriptorSets[frameIndex][3];
             vkUpdateDescriptorSets(m_vulkanDevice, 1, &sampledImageWriteDescriptorSet, 0, nullptr);
         }
     }
@@ -179,7 +211,7 @@ void DuckDemoGame::UpdateObjectTexture(RenderObject& renderObject, const std::st
     {
         for (MeshRenderPass& meshRenderPass : m_meshRenderPasses)
         {
-            sampledImageWriteDescriptorSet.dstSet = meshRenderPass.m_vulkanDescriptorSets[3];
+            sampledImageWriteDescriptorSet.dstSet = meshRenderPass.m_vulkanDescriptorSets[frameIndex][3];
             vkUpdateDescriptorSets(m_vulkanDevice, 1, &sampledImageWriteDescriptorSet, 0, nullptr);
         }
     }
@@ -187,50 +219,132 @@ void DuckDemoGame::UpdateObjectTexture(RenderObject& renderObject, const std::st
 
 void DuckDemoGame::UpdateModel(RenderObject& renderObject, const std::string& modelPath)
 {
+    DUCK_DEMO_CPU_SCOPE("DuckDemoGame::UpdateModel");
+
+    // the cooked cache sits next to the model and is used as long as it was written from this exact file,
+    // builds that ship only the cache take it as is since there's nothing to check it against
+    const std::string cachePath = modelPath.substr(0, modelPath.find_last_of('.')) + ".mlmesh";
+
     std::unique_ptr<DuckDemoFile> modelFile = DuckDemoUtils::LoadFileFromDisk(modelPath);
-    if (modelFile == nullptr)
-    {
-        DUCK_DEMO_ASSERT(false);
-        return;
-    }
+    const uint64_t sourceHash = modelFile != nullptr ?
+        MeshLoader::Loader::HashSource(modelFile->buffer.get(), modelFile->bufferSize) :
+        MeshLoader::c_meshCacheAnySource;
 
+    MeshLoader::MappedMesh mappedMesh;
     MeshLoader::Mesh mesh;
-    if (!MeshLoader::Loader::LoadModel(modelFile->buffer.get(), modelFile->bufferSize, mesh))
+    const MeshLoader::Vertex* vertices = nullptr;
+    const MeshLoader::IndexType* indices = nullptr;
+    int vertexCount = 0;
+    int indexCount = 0;
+
+    if (MeshLoader::Loader::LoadMeshCache(cachePath.c_str(), sourceHash, mappedMesh))
     {
-        DUCK_DEMO_ASSERT(false);
-        return;
+        vertices = mappedMesh.GetVertex();
+        vertexCount = mappedMesh.vertexCount;
+        indices = mappedMesh.GetIndex();
+        indexCount = mappedMesh.indexCount;
     }
+    else
+    {
+        if (modelFile == nullptr)
+        {
+            DUCK_DEMO_ASSERT(false);
+            return;
+        }
+
+        if (!MeshLoader::Loader::LoadModel(modelFile->buffer.get(), modelFile->bufferSize, mesh))
+        {
+            DUCK_DEMO_ASSERT(false);
+            return;
+        }
+
+        // done before the cache is written so loads from the cache get it for free
+        MeshLoader::OptimizeStats optimizeStats;
+        if (MeshLoader::Loader::Optimize(mesh, &optimizeStats))
+        {
+            SDL_Log("DuckDemoGame: optimized %s, acmr %.3f -> %.3f, atvr %.3f -> %.3f", modelPath.c_str(),
+                optimizeStats.acmrBefore, optimizeStats.acmrAfter, optimizeStats.atvrBefore, optimizeStats.atvrAfter);
+        }
+
+        if (!MeshLoader::Loader::SaveMeshCache(mesh, sourceHash, cachePath.c_str()))
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "DuckDemoGame: could not write the mesh cache %s", cachePath.c_str());
+        }
+
+        vertices = mesh.GetVertex();
+        vertexCount = mesh.vertexCount;
+        indices = mesh.GetIndex();
+        indexCount = mesh.indexCount;
+    }
+
+    // the buffers are copied into staging right away so the mapping can go once this returns
+    UpdateVertexBuffer(renderObject, vertices, vertexCount, GetMeshVertexFormat());
 
-    renderObject.m_vertexBuffer.reset(new VulkanBuffer());
     renderObject.m_indexBuffer.reset(new VulkanBuffer());
+    DUCK_DEMO_VULKAN_ASSERT(CreateVulkanDeviceBuffer(static_cast<VkDeviceSize>(sizeof(MeshLoader::IndexType) * indexCount), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indices, *renderObject.m_indexBuffer.get()));
 
-    DUCK_DEMO_VULKAN_ASSERT(CreateVulkanBuffer(static_cast<VkDeviceSize>(sizeof(MeshLoader::Vertex) * mesh.vertexCount), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, *renderObject.m_vertexBuffer.get()));
-    DUCK_DEMO_VULKAN_ASSERT(CreateVulkanBuffer(static_cast<VkDeviceSize>(sizeof(MeshLoader::IndexType) * mesh.indexCount), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, *renderObject.m_indexBuffer.get()));
+    renderObject.m_indexCount = indexCount;
+}
 
-    FillVulkanBuffer(*renderObject.m_vertexBuffer.get(), mesh.GetVertex(), sizeof(MeshLoader::Vertex) * mesh.vertexCount);
-    FillVulkanBuffer(*renderObject.m_indexBuffer.get(), mesh.GetIndex(), sizeof(MeshLoader::IndexType) * mesh.indexCount);
+void DuckDemoGame::UpdateVertexBuffer(RenderObject& renderObject, const MeshLoader::Vertex* vertices, const int vertexCount, const MeshLoader::VertexFormat& vertexFormat)
+{
+    MeshLoader::PackedVertices packedVertices;
+    if (!MeshLoader::Loader::PackVertices(vertices, vertexCount, vertexFormat, packedVertices))
+    {
+        DUCK_DEMO_ASSERT(false);
+        return;
+    }
 
-    renderObject.m_indexCount = mesh.indexCount;
+    // the shader scales the packed values back up with these
+    renderObject.objectBuf.uPositionScale = glm::vec4(packedVertices.positionScale.x, packedVertices.positionScale.y, packedVertices.positionScale.z, 0.0f);
+    renderObject.objectBuf.uPositionOffset = glm::vec4(packedVertices.positionOffset.x, packedVertices.positionOffset.y, packedVertices.positionOffset.z, 0.0f);
+    renderObject.objectBuf.uTextureScaleOffset = glm::vec4(packedVertices.textureScale.x, packedVertices.textureScale.y, packedVertices.textureOffset.x, packedVertices.textureOffset.y);
+
+    renderObject.m_vertexBuffer.reset(new VulkanBuffer());
+    const VkDeviceSize vertexBufferSize = static_cast<VkDeviceSize>(packedVertices.layout.stride) * packedVertices.vertexCount;
+    DUCK_DEMO_VULKAN_ASSERT(CreateVulkanDeviceBuffer(vertexBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, packedVertices.buffer.get(), *renderObject.m_vertexBuffer.get()));
 }
 
-void DuckDemoGame::UpdateWaterPrimitive(RenderObject& renderObject, const float width, const float depth, const uint32_t gridX, const uint32_t gridY)
+void DuckDemoGame::UpdateWaterPatch(RenderObject& renderObject)
 {
+    DUCK_DEMO_CPU_SCOPE("DuckDemoGame::UpdateWaterPatch");
+
+    // only the indices of the grid are kept, WaterShader.vert works the position out from the vertex index
+    // so the vertices can't be optimized or reordered, a 17 vertex row still mostly stays in the post transform cache
     MeshLoader::Mesh mesh;
-    if (!MeshLoader::Loader::LoadGridPrimitive(width, depth, gridX, gridY, mesh))
+    if (!MeshLoader::Loader::LoadGridPrimitive(1.0f, 1.0f, c_waterPatchQuadCount + 1, c_waterPatchQuadCount + 1, mesh))
     {
         DUCK_DEMO_ASSERT(false);
     }
 
-    renderObject.m_vertexBuffer.reset(new VulkanBuffer());
+    // a patch is a few hundred vertices so its indices fit in half the space
+    static_assert((c_waterPatchQuadCount + 1) * (c_waterPatchQuadCount + 1) <= 0x10000u, "water patch indices have to fit in 16 bits");
+    std::vector<uint16_t> indices(mesh.GetIndex(), mesh.GetIndex() + mesh.indexCount);
+
     renderObject.m_indexBuffer.reset(new VulkanBuffer());
+    DUCK_DEMO_VULKAN_ASSERT(CreateVulkanDeviceBuffer(static_cast<VkDeviceSize>(sizeof(uint16_t) * indices.size()), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indices.data(), *renderObject.m_indexBuffer.get()));
 
-    DUCK_DEMO_VULKAN_ASSERT(CreateVulkanBuffer(static_cast<VkDeviceSize>(sizeof(MeshLoader::Vertex) * mesh.vertexCount), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, *renderObject.m_vertexBuffer.get()));
-    DUCK_DEMO_VULKAN_ASSERT(CreateVulkanBuffer(static_cast<VkDeviceSize>(sizeof(MeshLoader::IndexType) * mesh.indexCount), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, *renderObject.m_indexBuffer.get()));
+    renderObject.m_indexCount = mesh.indexCount;
+    renderObject.m_indexType = VK_INDEX_TYPE_UINT16;
+}
 
-    FillVulkanBuffer(*renderObject.m_vertexBuffer.get(), mesh.GetVertex(), sizeof(MeshLoader::Vertex) * mesh.vertexCount);
-    FillVulkanBuffer(*renderObject.m_indexBuffer.get(), mesh.GetIndex(), sizeof(MeshLoader::IndexType) * mesh.indexCount);
+void DuckDemoGame::UpdateWaterPatches()
+{
+    DUCK_DEMO_CPU_SCOPE("DuckDemoGame::UpdateWaterPatches");
 
-    renderObject.m_indexCount = mesh.indexCount;
+    // the quadtree is in the water's object space, uWorld is stored transposed for the shaders
+    const glm::mat4 objectFromWorld = glm::inverse(glm::transpose(m_waterRenderObject.objectBuf.uWorld));
+    const glm::vec3 cameraPosition = glm::vec3(objectFromWorld * glm::vec4(m_cameraPosition, 1.0f));
+
+    const glm::mat4 clipFromObject = m_viewProj * glm::transpose(m_waterRenderObject.objectBuf.uWorld);
+    Select_WaterLod(m_waterLodParams, cameraPosition, clipFromObject, m_waterPatches, m_waterLodStats);
+
+    // looking straight up can leave nothing to draw
+    m_waterRenderObject.m_instanceCount = static_cast<uint32_t>(m_waterPatches.size());
+    if (!m_waterPatches.empty())
+    {
+        m_waterRenderObject.m_instanceOffset = Push_UniformRingBuffer(m_uniformRingBuffer, m_waterPatches.data(), sizeof(WaterPatch) * m_waterPatches.size());
+    }
 }
 
 void DuckDemoGame::OnResize()
@@ -362,6 +476,21 @@ CameraInput DuckDemoGame::GetCameraInput()
 }
 
 void DuckDemoGame::OnUpdate(const GameTimer& gameTimer)
+{
+    DUCK_DEMO_CPU_SCOPE("DuckDemoGame::OnUpdate");
+
+    UpdateCamera(gameTimer);
+
+    UpdateFrameBuffer();
+    UpdateWaterPatches();
+    UpdateObjectBuffer(m_duckRenderObject);
+    UpdateObjectBuffer(m_waterRenderObject);
+    BindObjectTexture(m_duckRenderObject);
+    BindObjectTexture(m_waterRenderObject);
+    Update_WaterComputePass(m_waterComputePass, gameTimer.DeltaTime());
+}
+
+void DuckDemoGame::UpdateCamera(const GameTimer& gameTimer)
 {
     CameraInput cameraInput = GetCameraInput();
 
@@ -400,13 +529,12 @@ void DuckDemoGame::OnUpdate(const GameTimer& gameTimer)
         const glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f);
         m_cameraPosition += worldUp * cameraRaiseSpeed * static_cast<float>(gameTimer.DeltaTime()) * static_cast<float>(yAxis);
     }
-
-    UpdateFrameBuffer();
-    Update_WaterComputePass(m_waterComputePass, gameTimer.DeltaTime());
 }
 
 void DuckDemoGame::UpdateFrameBuffer()
 {
+    DUCK_DEMO_CPU_SCOPE("DuckDemoGame::UpdateFrameBuffer");
+
     const glm::vec3 cameraForward = m_cameraRotation * glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
 
     const glm::vec3 lookAtUp = m_cameraRotation * glm::vec4(0.0f, 1.0f, 0.0f, 1.0f);
@@ -420,8 +548,10 @@ void DuckDemoGame::UpdateFrameBuffer()
         1.0f, 
         100000.0f);
 
+    m_viewProj = proj * view;
+
     FrameBuf frameBuf;
-    frameBuf.uViewProj = glm::transpose(proj * view);
+    frameBuf.uViewProj = glm::transpose(m_viewProj);
     frameBuf.uEyePosW = m_cameraPosition;
     
     frameBuf.uAmbientLight = glm::vec4(0.25f, 0.25f, 0.25f, 1.0f);
@@ -446,15 +576,8 @@ void DuckDemoGame::UpdateFrameBuffer()
     frameBuf.uPointLights[1].uFalloffStart = 30.0f;
     frameBuf.uPointLights[1].uFalloffEnd = 50.0f;
 
-    for (MeshRenderPass& meshRenderPass : m_meshRenderPasses)
-    {
-        FillVulkanBuffer(meshRenderPass.m_vulkanFrameBuffer, &frameBuf, sizeof(frameBuf));
-    }
-    
-    for (WaterRenderPass& waterRenderPass : m_waterRenderPasses)
-    {
-        FillVulkanBuffer(waterRenderPass.m_vulkanFrameBuffer, &frameBuf, sizeof(frameBuf));
-    }
+    // every pass reads the same copy
+    m_frameBufOffset = Push_UniformRingBuffer(m_uniformRingBuffer, &frameBuf, sizeof(frameBuf));
 }
 
 void DuckDemoGame::OnRender()
@@ -462,6 +585,7 @@ void DuckDemoGame::OnRender()
     const RenderPassType meshRenderPassType = m_wireframe ? RenderPassType_Wireframe : RenderPassType_Default;
 
     Compute_WaterComputePass(m_waterComputePass);
+    Acquire_WaterComputePass(m_waterComputePass, m_vulkanPrimaryCommandBuffer);
 
     {
        SetWaterImageView_MeshRenderPass(
@@ -470,7 +594,9 @@ void DuckDemoGame::OnRender()
     	
        std::vector<RenderObject> renderObjects;
        renderObjects.push_back(m_duckRenderObject);
-       Render_MeshRenderPass(m_meshRenderPasses[meshRenderPassType], m_vulkanPrimaryCommandBuffer, renderObjects);
+       BeginScope_GpuProfiler(m_gpuProfiler, m_vulkanPrimaryCommandBuffer, GetCurrentFrameIndex(), GpuProfilerScope_MeshRender);
+       Render_MeshRenderPass(m_meshRenderPasses[meshRenderPassType], m_vulkanPrimaryCommandBuffer, m_frameBufOffset, renderObjects);
+       EndScope_GpuProfiler(m_gpuProfiler, m_vulkanPrimaryCommandBuffer, GetCurrentFrameIndex(), GpuProfilerScope_MeshRender);
     }
 
     {
@@ -480,12 +606,16 @@ void DuckDemoGame::OnRender()
 
         std::vector<RenderObject> renderObjects;
         renderObjects.push_back(m_waterRenderObject);
-        Render_WaterRenderPass(m_waterRenderPasses[meshRenderPassType], m_vulkanPrimaryCommandBuffer, renderObjects);
+        BeginScope_GpuProfiler(m_gpuProfiler, m_vulkanPrimaryCommandBuffer, GetCurrentFrameIndex(), GpuProfilerScope_WaterRender);
+        Render_WaterRenderPass(m_waterRenderPasses[meshRenderPassType], m_vulkanPrimaryCommandBuffer, m_frameBufOffset, renderObjects);
+        EndScope_GpuProfiler(m_gpuProfiler, m_vulkanPrimaryCommandBuffer, GetCurrentFrameIndex(), GpuProfilerScope_WaterRender);
     }
 
     BeginRender_ImGuiRenderPass(m_imGuiRenderPass);
     OnImGui();
+    BeginScope_GpuProfiler(m_gpuProfiler, m_vulkanPrimaryCommandBuffer, GetCurrentFrameIndex(), GpuProfilerScope_ImGui);
     EndRender_ImGuiRenderPass(m_imGuiRenderPass, m_vulkanPrimaryCommandBuffer);
+    EndScope_GpuProfiler(m_gpuProfiler, m_vulkanPrimaryCommandBuffer, GetCurrentFrameIndex(), GpuProfilerScope_ImGui);
 }
 
 void DuckDemoGame::OnImGui()
@@ -502,5 +632,8 @@ void DuckDemoGame::OnImGui()
         m_cameraRotationY = m_initialCameraRotationY;
         m_cameraPosition = m_initialCameraPosition;
     }
+    ImGui::Text("Water patches: %u visible, %u nodes culled", m_waterLodStats.m_visiblePatchCount, m_waterLodStats.m_culledNodeCount);
+    ImGui_GpuProfiler(m_gpuProfiler);
+    ImGui_VulkanMemoryAllocator(m_vulkanMemoryAllocator);
     ImGui::End();
 }
@@ -15,6 +15,7 @@
 #include "RenderObject.h"
 #include "WaterRenderPass.h"
 #include "WaterComputePass.h"
+#include "WaterLod.h"
 
 struct CameraInput
 {
@@ -31,6 +32,24 @@ class DuckDemoGame : public Game
 public:
     virtual ~DuckDemoGame() override;
 
+protected:
+    virtual bool OnInit() override;
+    virtual void OnResize() override;
+    virtual void OnUpdate(const GameTimer& gameTimer) override;
+    virtual void OnRender() override;
+
+    // moves m_cameraPosition and m_cameraRotation for this frame, by default from the controller, keyboard and mouse
+    virtual void UpdateCamera(const GameTimer& gameTimer);
+
+    glm::quat m_cameraRotation;
+    glm::vec3 m_cameraPosition;
+    float m_cameraRotationX;
+    float m_cameraRotationY;
+
+    float m_initialCameraRotationX = 343.919769f;
+    float m_initialCameraRotationY = 315.912231f;
+    glm::vec3 m_initialCameraPosition = glm::vec3(477.618134f, -548.98877f, -573.386658f);
+
 private:
     enum RenderPassType
     {
@@ -38,19 +57,21 @@ private:
         RenderPassType_Wireframe,
         RenderPassType_COUNT,
     };
-
-    virtual bool OnInit() override;
-    virtual void OnResize() override;
-    virtual void OnUpdate(const GameTimer& gameTimer) override;
-    virtual void OnRender() override;
     
     void OnImGui();
 
     void UpdateFrameBuffer();
-    void UpdateObjectBuffer(RenderObject& renderObject, const bool waterPass = false);
+    void UpdateObjectBuffer(RenderObject& renderObject);
     void UpdateObjectTexture(RenderObject& renderObject, const std::string& texturePath, const bool waterPass = false);
+    // once the texture is ready it replaces the placeholder in the current frame's descriptor sets
+    void BindObjectTexture(RenderObject& renderObject);
+    void WriteObjectTextureDescriptor(const RenderObject& renderObject, const uint32_t frameIndex, VkImageView imageView);
     void UpdateModel(RenderObject& renderObject, const std::string& modelPath);
-    void UpdateWaterPrimitive(RenderObject& renderObject, const float width, const float depth, const uint32_t gridX, const uint32_t gridY);
+    // packs the vertices in vertexFormat and sets the object's dequantization to match
+    void UpdateVertexBuffer(RenderObject& renderObject, const MeshLoader::Vertex* vertices, const int vertexCount, const MeshLoader::VertexFormat& vertexFormat);
+    void UpdateWaterPatch(RenderObject& renderObject);
+    // picks this frame's patches around the camera and pushes them as the water's instances
+    void UpdateWaterPatches();
 
     CameraInput GetCameraInput();
 
@@ -61,15 +82,15 @@ private:
     std::array<WaterRenderPass, RenderPassType_COUNT> m_waterRenderPasses;
     WaterComputePass m_waterComputePass;
 
-    glm::quat m_cameraRotation;
-    glm::vec3 m_cameraPosition;
-    float m_cameraRotationX;
-    float m_cameraRotationY;
+    WaterLodParams m_waterLodParams;
+    std::vector<WaterPatch> m_waterPatches;
+    WaterLodStats m_waterLodStats;
+
+    // where this frame's FrameBuf was pushed in the uniform ring
+    uint32_t m_frameBufOffset = 0;
+    // untransposed copy of FrameBuf::uViewProj for culling on the cpu
+    glm::mat4 m_viewProj = glm::mat4(1.0f);
 
     bool m_wireframe = false;
     float m_cameraMoveSpeed = 500.0f;
-
-    float m_initialCameraRotationX = 343.919769f;
-    float m_initialCameraRotationY = 315.912231f;
-    glm::vec3 m_initialCameraPosition = glm::vec3(477.618134f, -548.98877f, -573.386658f);
 };
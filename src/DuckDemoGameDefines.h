@@ -47,4 +47,10 @@ struct DUCK_DEMO_ALIGN(16) ObjectBuf
     glm::vec3 uFresnelR0;
     float uRoughness;
     uint uTextureIndex;
+    uint padding0[3];
+    // undoes the quantization of MeshLoader::PackVertices, stored * scale + offset
+    glm::vec4 uPositionScale;
+    glm::vec4 uPositionOffset;
+    // xy scale, zw offset
+    glm::vec4 uTextureScaleOffset;
 };
@@ -1,8 +1,21 @@
 #include "DuckDemoUtils.h"
 
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
 #include <iostream>
 #include <fstream>
 
+#include <sys/stat.h>
+#ifdef _WIN32
+    #include <direct.h>
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif // _WIN32
+
 #include "Game.h"
 
 SDL_Window* DuckDemoUtils::GetWindow()
@@ -25,3 +38,152 @@ std::unique_ptr<DuckDemoFile> DuckDemoUtils::LoadFileFromDisk(const std::string&
     }
     return nullptr;
 }
+
+DuckDemoMappedFile::~DuckDemoMappedFile()
+{
+#ifdef _WIN32
+    if (data != nullptr)
+    {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle != nullptr)
+    {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != nullptr)
+    {
+        CloseHandle(fileHandle);
+    }
+#else
+    if (data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(data), dataSize);
+    }
+#endif // _WIN32
+}
+
+std::unique_ptr<DuckDemoMappedFile> DuckDemoUtils::MapFileFromDisk(const std::string& path)
+{
+    std::unique_ptr<DuckDemoMappedFile> mappedFile = std::make_unique<DuckDemoMappedFile>();
+
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+    mappedFile->fileHandle = fileHandle;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        return nullptr;
+    }
+    mappedFile->dataSize = static_cast<std::size_t>(fileSize.QuadPart);
+
+    mappedFile->mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappedFile->mappingHandle == nullptr)
+    {
+        return nullptr;
+    }
+
+    mappedFile->data = static_cast<const uint8_t*>(MapViewOfFile(mappedFile->mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (mappedFile->data == nullptr)
+    {
+        return nullptr;
+    }
+#else
+    const int fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        return nullptr;
+    }
+
+    // the mapping keeps the file alive so the descriptor can go right away
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(fileDescriptor, &info) == 0 && info.st_size > 0)
+    {
+        data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    }
+    close(fileDescriptor);
+    if (data == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    mappedFile->data = static_cast<const uint8_t*>(data);
+    mappedFile->dataSize = static_cast<std::size_t>(info.st_size);
+#endif // _WIN32
+
+    return mappedFile;
+}
+
+bool DuckDemoUtils::WriteFileToDisk(const std::string& path, const void* data, const std::size_t dataSize)
+{
+    // unique per write so two threads saving the same file don't share a temporary
+    static std::atomic<uint32_t> s_tempFileCounter(0);
+    const std::string tempPath = DuckDemoUtils::format("%s.%u.tmp", path.c_str(), s_tempFileCounter.fetch_add(1));
+
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    const bool written = fwrite(data, 1, dataSize, file) == dataSize;
+    const bool closed = fclose(file) == 0;
+    if (!written || !closed)
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    const bool renamed = MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    const bool renamed = std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif // _WIN32
+    if (!renamed)
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool DuckDemoUtils::CreateDirectoryOnDisk(const std::string& path)
+{
+#ifdef _WIN32
+    struct _stat info;
+    if (_stat(path.c_str(), &info) == 0)
+    {
+        return (info.st_mode & _S_IFDIR) != 0;
+    }
+    // another thread may have made it since the check
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0)
+    {
+        return S_ISDIR(info.st_mode);
+    }
+    // another thread may have made it since the check
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif // _WIN32
+}
+
+uint64_t DuckDemoUtils::HashFnv1a(const void* data, const std::size_t dataSize, const uint64_t hash /*= c_fnv1aOffsetBasis*/)
+{
+    constexpr uint64_t fnv1aPrime = 0x100000001b3ull;
+
+    uint64_t result = hash;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (std::size_t i = 0; i < dataSize; ++i)
+    {
+        result ^= bytes[i];
+        result *= fnv1aPrime;
+    }
+    return result;
+}
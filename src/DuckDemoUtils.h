@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -39,11 +40,34 @@ struct DuckDemoFile
     std::size_t bufferSize = 0;
 };
 
+// read only view of a whole file, pages are only read in once they're touched and it's unmapped when destroyed
+struct DuckDemoMappedFile
+{
+    ~DuckDemoMappedFile();
+
+    const uint8_t* data = nullptr;
+    std::size_t dataSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif // _WIN32
+};
+
 namespace DuckDemoUtils
 {
     SDL_Window* GetWindow();
 
     std::unique_ptr<DuckDemoFile> LoadFileFromDisk(const std::string& path);
+    // nullptr if the file doesn't exist or is empty
+    std::unique_ptr<DuckDemoMappedFile> MapFileFromDisk(const std::string& path);
+    // goes through a temporary file that is renamed over path so nobody ever reads a half written file
+    bool WriteFileToDisk(const std::string& path, const void* data, const std::size_t dataSize);
+    // true if the directory exists afterwards, parent directories have to exist already
+    bool CreateDirectoryOnDisk(const std::string& path);
+
+    constexpr uint64_t c_fnv1aOffsetBasis = 0xcbf29ce484222325ull;
+    // pass the previous hash back in to hash several pieces of data as one
+    uint64_t HashFnv1a(const void* data, const std::size_t dataSize, const uint64_t hash = c_fnv1aOffsetBasis);
 
     template<typename ... Args>
     std::string format(const std::string& format, Args ... args)
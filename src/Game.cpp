@@ -1,13 +1,33 @@
 #include "Game.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 
 #include <SDL_vulkan.h>
 #include "imgui.h"
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
 
+#include "CpuProfiler.h"
 #include "DuckDemoUtils.h"
+#include "MipChain.h"
+#ifdef DUCK_DEMO_PRECOMPILED_SHADERS
+    // generated by cmake/EmbeddedShaders.cmake
+    #include "EmbeddedShaders.h"
+#endif // DUCK_DEMO_PRECOMPILED_SHADERS
+
+// cmake fills this in from external/shaderc/CHANGES so updating shaderc throws the shader cache away
+#ifndef DUCK_DEMO_SHADERC_VERSION
+    #define DUCK_DEMO_SHADERC_VERSION "unknown"
+#endif // DUCK_DEMO_SHADERC_VERSION
+
+// relative to the working directory, same as data/
+constexpr const char* c_shaderCacheDirectory = "shader_cache";
+constexpr const char* c_pipelineCacheFilePath = "shader_cache/pipeline_cache.bin";
+// headerSize, headerVersion, vendorID, deviceID and pipelineCacheUUID of VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+constexpr std::size_t c_pipelineCacheHeaderSize = 16u + VK_UUID_SIZE;
+constexpr VkFormat c_textureFormat = VK_FORMAT_R8G8B8A8_SRGB;
 
 Game* Game::ms_instance = nullptr;
 Game* Game::Get()
@@ -38,7 +58,18 @@ Game::~Game()
 
     Free_ImGuiRenderPass(m_imGuiRenderPass);
 
-    shaderc_compiler_release(m_shaderCompiler);
+    if (m_vulkanPipelineCache)
+    {
+        SaveVulkanPipelineCache();
+        vkDestroyPipelineCache(m_vulkanDevice, m_vulkanPipelineCache, s_allocator);
+    }
+
+#ifndef DUCK_DEMO_PRECOMPILED_SHADERS
+    for (shaderc_compiler_t shaderCompiler : m_shaderCompilers)
+    {
+        shaderc_compiler_release(shaderCompiler);
+    }
+#endif // DUCK_DEMO_PRECOMPILED_SHADERS
 
     FreeVulkanDepthStencilImage();
 
@@ -57,29 +88,37 @@ Game::~Game()
         vkDestroyFence(m_vulkanDevice, m_vulkanTempFence, s_allocator);
     }
 
-    if (m_vulkanPrimaryCommandBuffer)
-    {
-        vkFreeCommandBuffers(m_vulkanDevice, m_vulkanPrimaryCommandPool, 1, &m_vulkanPrimaryCommandBuffer);
-    }
+    Free_GpuProfiler(m_gpuProfiler);
+    Free_UniformRingBuffer(m_uniformRingBuffer);
+    Free_TextureLoader(m_textureLoader);
+    Free_UploadManager(m_uploadManager);
 
-    if (m_vulkanPrimaryCommandPool)
+    for (GameFrame& frame : m_frames)
     {
-        vkDestroyCommandPool(m_vulkanDevice, m_vulkanPrimaryCommandPool, s_allocator);
-    }
+        if (frame.m_vulkanCommandBuffer)
+        {
+            vkFreeCommandBuffers(m_vulkanDevice, frame.m_vulkanCommandPool, 1, &frame.m_vulkanCommandBuffer);
+        }
 
-    if (m_vulkanSubmitFence)
-    {
-        vkDestroyFence(m_vulkanDevice, m_vulkanSubmitFence, s_allocator);
-    }
+        if (frame.m_vulkanCommandPool)
+        {
+            vkDestroyCommandPool(m_vulkanDevice, frame.m_vulkanCommandPool, s_allocator);
+        }
 
-    if (m_vulkanAquireSwapchain)
-    {
-        vkDestroySemaphore(m_vulkanDevice, m_vulkanAquireSwapchain, s_allocator);
-    }
+        if (frame.m_vulkanSubmitFence)
+        {
+            vkDestroyFence(m_vulkanDevice, frame.m_vulkanSubmitFence, s_allocator);
+        }
 
-    if (m_vulkanReleaseSwapchain)
-    {
-        vkDestroySemaphore(m_vulkanDevice, m_vulkanReleaseSwapchain, s_allocator);
+        if (frame.m_vulkanAquireSwapchain)
+        {
+            vkDestroySemaphore(m_vulkanDevice, frame.m_vulkanAquireSwapchain, s_allocator);
+        }
+
+        if (frame.m_vulkanReleaseSwapchain)
+        {
+            vkDestroySemaphore(m_vulkanDevice, frame.m_vulkanReleaseSwapchain, s_allocator);
+        }
     }
 
     for (VkImageView imageView : m_vulkanSwapchainImageViews)
@@ -87,6 +126,8 @@ Game::~Game()
         vkDestroyImageView(m_vulkanDevice, imageView, nullptr);
     }
 
+    FreeVulkanOffscreenImages();
+
     if (m_vulkanSwapchain)
     {
         vkDestroySwapchainKHR(m_vulkanDevice, m_vulkanSwapchain, nullptr);
@@ -97,6 +138,8 @@ Game::~Game()
         vkDestroySurfaceKHR(m_instance, m_vulkanSurface, s_allocator);
     }
 
+    Free_VulkanMemoryAllocator(m_vulkanMemoryAllocator);
+
     if (m_vulkanDevice)
     {
         vkDestroyDevice(m_vulkanDevice, s_allocator);
@@ -118,8 +161,68 @@ Game::~Game()
     ms_instance = nullptr;
 }
 
-int Game::Run(int /*argc*/, char** /*argv*/)
+int Game::Run(int argc, char** argv)
 {
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--frames-in-flight" && i + 1 < argc)
+        {
+            m_framesInFlightCount = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 0));
+        }
+        else if (arg == "--cpu-trace-frames" && i + 1 < argc)
+        {
+            m_cpuTraceFrameCount = static_cast<uint64_t>(std::max(std::atoi(argv[++i]), 0));
+        }
+#ifndef DUCK_DEMO_PRECOMPILED_SHADERS
+        else if (arg == "--no-shader-cache")
+        {
+            m_shaderCacheEnabled = false;
+        }
+#endif // DUCK_DEMO_PRECOMPILED_SHADERS
+        else if (arg == "--no-pipeline-cache")
+        {
+            m_pipelineCacheEnabled = false;
+        }
+        else if (arg == "--serial-init")
+        {
+            m_parallelInit = false;
+        }
+        else if (arg == "--baked-waves")
+        {
+            m_bakedWaves = true;
+        }
+        else if (arg == "--headless")
+        {
+            m_headless = true;
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+        {
+            m_headlessFrameCount = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 0));
+        }
+        else if (arg == "--width" && i + 1 < argc)
+        {
+            m_headlessWidth = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (arg == "--height" && i + 1 < argc)
+        {
+            m_headlessHeight = std::max(std::atoi(argv[++i]), 1);
+        }
+    }
+    m_framesInFlightCount = std::min(std::max(m_framesInFlightCount, 1u), c_maxFramesInFlight);
+
+    CpuProfiler::SetThreadName("Main");
+
+    // seconds each part of startup took, logged once the game is ready to run
+    std::chrono::high_resolution_clock::time_point startupStageTime = std::chrono::high_resolution_clock::now();
+    auto endStartupStage = [&startupStageTime]()
+    {
+        const std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+        const double stageTime = std::chrono::duration<double>(now - startupStageTime).count();
+        startupStageTime = now;
+        return stageTime;
+    };
+
     if (!InitWindow())
     {
         return 1;
@@ -139,7 +242,9 @@ int Game::Run(int /*argc*/, char** /*argv*/)
         return 1;
     }
 
-    if (!InitVulkanSwapChain(windowWidth, windowHeight))
+    const double deviceInitTime = endStartupStage();
+
+    if (m_headless ? !InitVulkanOffscreenImages(windowWidth, windowHeight) : !InitVulkanSwapChain(windowWidth, windowHeight))
     {
         return 1;
     }
@@ -154,57 +259,115 @@ int Game::Run(int /*argc*/, char** /*argv*/)
         return 1;
     }
 
-    m_shaderCompiler = shaderc_compiler_initialize();
-    if (m_shaderCompiler == nullptr)
-    {
-        return 1;
-    }
+    const double resourceInitTime = endStartupStage();
 
     if (!Init_ImGuiRenderPass(m_imGuiRenderPass))
     {
         return 1;
     }
 
+    const double imGuiInitTime = endStartupStage();
+
     if (!OnInit())
     {
         return 1;
     }
 
+    const double gameInitTime = endStartupStage();
+
+    SDL_Log("Startup: %.1f ms window and device, %.1f ms swapchain and resources, %.1f ms imgui, %.1f ms game (%s init)",
+        deviceInitTime * 1e3, resourceInitTime * 1e3, imGuiInitTime * 1e3, gameInitTime * 1e3, m_parallelInit ? "parallel" : "serial");
+#ifndef DUCK_DEMO_PRECOMPILED_SHADERS
+    SDL_Log("Shader cache: %u hits, %u misses, %.1f ms compiling across %zu compilers",
+        m_shaderCacheHitCount, m_shaderCacheMissCount, m_shaderCompileTime * 1e3, m_shaderCompilers.size());
+#endif // DUCK_DEMO_PRECOMPILED_SHADERS
+    SDL_Log("Pipeline cache: %s, %u pipelines, %.1f ms creating them",
+        !m_pipelineCacheEnabled ? "disabled" : (m_pipelineCacheWarm ? "warm" : "cold"),
+        m_pipelineCreateCount, m_pipelineCreateTime * 1e3);
+
     Resize(windowWidth, windowHeight);
 
     m_gameTimer.Reset();
+    const std::chrono::high_resolution_clock::time_point runStartTime = std::chrono::high_resolution_clock::now();
     while (!m_quit)
     {
-        SDL_Event sdlEvent;
-        while (SDL_PollEvent(&sdlEvent) != 0)
+        DUCK_DEMO_CPU_SCOPE("Game::Frame");
+
         {
-            ProcessEvent_ImGuiRenderPass(&sdlEvent);
-            if (sdlEvent.type == SDL_QUIT)
-            {
-                m_quit = true;
-                break;
-            }
-            else if (sdlEvent.type == SDL_WINDOWEVENT)
+            DUCK_DEMO_CPU_SCOPE("Game::PollEvents");
+
+            SDL_Event sdlEvent;
+            while (SDL_PollEvent(&sdlEvent) != 0)
             {
-                if (sdlEvent.window.event == SDL_WINDOWEVENT_RESIZED)
+                ProcessEvent_ImGuiRenderPass(&sdlEvent);
+                if (sdlEvent.type == SDL_QUIT)
                 {
-                    const Sint32 width = sdlEvent.window.data1;
-                    const Sint32 height = sdlEvent.window.data2;
-                    Resize(width, height);
+                    m_quit = true;
                     break;
                 }
+                else if (sdlEvent.type == SDL_KEYDOWN)
+                {
+                    if (sdlEvent.key.keysym.sym == SDLK_F12 && sdlEvent.key.repeat == 0)
+                    {
+                        m_cpuTraceRequested = true;
+                    }
+                }
+                else if (sdlEvent.type == SDL_WINDOWEVENT)
+                {
+                    if (sdlEvent.window.event == SDL_WINDOWEVENT_RESIZED)
+                    {
+                        const Sint32 width = sdlEvent.window.data1;
+                        const Sint32 height = sdlEvent.window.data2;
+                        Resize(width, height);
+                        break;
+                    }
+                }
             }
         }
 
         m_gameTimer.Tick();
 
+        WaitForCurrentFrame();
+        Update_TextureLoader(m_textureLoader);
         Update();
         if (!BeginRender())
         {
             continue;
         }
-        OnRender();
+        {
+            DUCK_DEMO_CPU_SCOPE("Game::OnRender");
+            OnRender();
+        }
         EndRender();
+
+        // a frame count of 0 keeps a headless run going until something calls QuitGame
+        if (m_headless && m_headlessFrameCount > 0 && m_gameTimer.FrameCount() >= m_headlessFrameCount)
+        {
+            m_quit = true;
+        }
+
+        // F12 or --cpu-trace-frames, the trace covers whatever is still in the rings so roughly the last few thousand frames
+        if (m_cpuTraceRequested || (m_cpuTraceFrameCount > 0 && m_gameTimer.FrameCount() == m_cpuTraceFrameCount))
+        {
+            m_cpuTraceRequested = false;
+            CpuProfiler::WriteChromeTrace("cpu_trace.json");
+        }
+    }
+
+    // hand out the timings of whatever is still in flight, oldest first
+    vkDeviceWaitIdle(m_vulkanDevice);
+    for (uint32_t i = 0; i < m_framesInFlightCount; ++i)
+    {
+        RetireFrame(m_frames[(m_currentFrameIndex + i) % m_framesInFlightCount]);
+    }
+
+    if (m_headless)
+    {
+        // wall clock on purpose, the game timer may be running on a fixed delta
+        const double totalTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - runStartTime).count();
+        const uint64_t frameCount = m_gameTimer.FrameCount();
+        SDL_Log("Headless: %" PRIu64 " frames at %ux%u in %.3fs (%.2f fps)", 
+            frameCount, m_vulkanSwapchainWidth, m_vulkanSwapchainHeight, totalTime, totalTime > 0.0 ? frameCount / totalTime : 0.0);
     }
 
     return 0;
@@ -212,6 +375,8 @@ int Game::Run(int /*argc*/, char** /*argv*/)
 
 void Game::Update()
 {
+    DUCK_DEMO_CPU_SCOPE("Game::Update");
+
     OnUpdate(m_gameTimer);
 }
 
@@ -224,12 +389,21 @@ void Game::Resize(int32_t width /*= -1*/, int32_t height /*= -1*/)
 
     DUCK_DEMO_ASSERT(m_vulkanPhysicalDevice != VK_NULL_HANDLE);
 
-    VkSurfaceCapabilitiesKHR surfaceCapabilities;
-    DUCK_DEMO_VULKAN_ASSERT(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_vulkanPhysicalDevice, m_vulkanSurface, &surfaceCapabilities));
+    if (m_headless)
+    {
+        vkDeviceWaitIdle(m_vulkanDevice);
 
-    vkDeviceWaitIdle(m_vulkanDevice);
+        InitVulkanOffscreenImages(width, height);
+    }
+    else
+    {
+        VkSurfaceCapabilitiesKHR surfaceCapabilities;
+        DUCK_DEMO_VULKAN_ASSERT(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_vulkanPhysicalDevice, m_vulkanSurface, &surfaceCapabilities));
+
+        vkDeviceWaitIdle(m_vulkanDevice);
 
-    InitVulkanSwapChain(width, height);
+        InitVulkanSwapChain(width, height);
+    }
 
     FreeVulkanDepthStencilImage();
     InitVulkanDepthStencilImage();
@@ -246,6 +420,28 @@ void Game::QuitGame()
 
 bool Game::InitWindow()
 {
+    if (m_headless)
+    {
+        // the dummy video driver gives imgui and the input code a window to talk to without needing a display,
+        // an explicit SDL_VIDEODRIVER in the environment is left alone
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+
+        if (SDL_Init(SDL_INIT_VIDEO) < 0)
+        {
+            DUCK_DEMO_SHOW_ERROR("Window Initialization Fail", DuckDemoUtils::format("SDL_Init(SDL_INIT_VIDEO)\n%s", SDL_GetError()));
+            return false;
+        }
+
+        m_window = SDL_CreateWindow("Vulkan Duck Demo", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, m_headlessWidth, m_headlessHeight, SDL_WINDOW_HIDDEN);
+        if (m_window == nullptr)
+        {
+            DUCK_DEMO_SHOW_ERROR("Window Initialization Fail", DuckDemoUtils::format("SDL_CreateWindow\n%s", SDL_GetError()));
+            return false;
+        }
+
+        return true;
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER) < 0)
     {
         DUCK_DEMO_SHOW_ERROR("Window Initialization Fail", DuckDemoUtils::format("SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER)\n%s", SDL_GetError()));
@@ -290,15 +486,16 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL vulkan_debug_callback(
 
 bool Game::InitVulkanInstance()
 {
-    uint32_t extensionCount;
-    if (!SDL_Vulkan_GetInstanceExtensions(m_window, &extensionCount, nullptr))
+    // headless has no surface so it doesn't need any of the window system extensions
+    uint32_t extensionCount = 0;
+    if (!m_headless && !SDL_Vulkan_GetInstanceExtensions(m_window, &extensionCount, nullptr))
     {
         DUCK_DEMO_SHOW_ERROR("Vulkan Initialization Fail", "Failed to get instance extension count");
         return false;
     }
 
     std::vector<const char*> activeExtensionNames(extensionCount);
-    if (!SDL_Vulkan_GetInstanceExtensions(m_window, &extensionCount, activeExtensionNames.data()))
+    if (!m_headless && !SDL_Vulkan_GetInstanceExtensions(m_window, &extensionCount, activeExtensionNames.data()))
     {
         DUCK_DEMO_SHOW_ERROR("Vulkan Initialization Fail", "Failed to get instance extension names");
         return false;
@@ -399,7 +596,7 @@ bool Game::InitVulkanInstance()
         DUCK_DEMO_VULKAN_ASSERT(result);
     }
 
-    if (!SDL_Vulkan_CreateSurface(m_window, m_instance, &m_vulkanSurface))
+    if (!m_headless && !SDL_Vulkan_CreateSurface(m_window, m_instance, &m_vulkanSurface))
     {
         DUCK_DEMO_SHOW_ERROR("Vulkan Initialization Fail", "Failed to create a surface");
         return false;
@@ -442,8 +639,11 @@ bool Game::InitVulkanDevice()
         {
             VkQueueFamilyProperties familyProperty = queueFamilyProperties[k];
 
-            VkBool32 supportsPresent = false;
-            DUCK_DEMO_VULKAN_ASSERT(vkGetPhysicalDeviceSurfaceSupportKHR(gpus[i], k, m_vulkanSurface, &supportsPresent));
+            VkBool32 supportsPresent = m_headless;
+            if (!m_headless)
+            {
+                DUCK_DEMO_VULKAN_ASSERT(vkGetPhysicalDeviceSurfaceSupportKHR(gpus[i], k, m_vulkanSurface, &supportsPresent));
+            }
 
             if ((familyProperty.queueFlags & VK_QUEUE_GRAPHICS_BIT) && supportsPresent)
             {
@@ -459,6 +659,14 @@ bool Game::InitVulkanDevice()
                     graphicsQueueIndex = k;
                     deviceTypeScore = VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU;
                 }
+                else if (m_headless && deviceTypeScore < 0 && 
+                    (deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU || deviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU))
+                {
+                    // software icds like lavapipe are only picked when there is no real gpu, that's the whole point of headless on build hosts
+                    m_vulkanPhysicalDevice = gpus[i];
+                    graphicsQueueIndex = k;
+                    deviceTypeScore = 0;
+                }
             }
 
             if (familyProperty.queueFlags & VK_QUEUE_COMPUTE_BIT)
@@ -483,6 +691,26 @@ bool Game::InitVulkanDevice()
     m_vulkanGraphicsQueueIndex = static_cast<uint32_t>(graphicsQueueIndex);
     m_vulkanComputeQueueIndex = static_cast<uint32_t>(computeQueueIndex);
 
+    // a transfer only family is usually backed by the copy engines so uploads don't take time away from rendering
+    m_vulkanTransferQueueIndex = m_vulkanGraphicsQueueIndex;
+    {
+        uint32_t queueFamilyPropertyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanPhysicalDevice, &queueFamilyPropertyCount, nullptr);
+
+        std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyPropertyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanPhysicalDevice, &queueFamilyPropertyCount, queueFamilyProperties.data());
+
+        for (uint32_t k = 0; k < queueFamilyPropertyCount; ++k)
+        {
+            const VkQueueFlags queueFlags = queueFamilyProperties[k].queueFlags;
+            if ((queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+            {
+                m_vulkanTransferQueueIndex = k;
+                break;
+            }
+        }
+    }
+
     uint32_t deviceExtensionCount;
     DUCK_DEMO_VULKAN_ASSERT(vkEnumerateDeviceExtensionProperties(m_vulkanPhysicalDevice, nullptr, &deviceExtensionCount, nullptr));
 
@@ -493,8 +721,24 @@ bool Game::InitVulkanDevice()
     vkGetPhysicalDeviceProperties(m_vulkanPhysicalDevice, &physicalDeviceProperties);
     m_minUniformBufferOffsetAlignment = physicalDeviceProperties.limits.minUniformBufferOffsetAlignment;
 
+    {
+        // the blits run on the graphics queue which can always blit, it's only the format that might not filter
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(m_vulkanPhysicalDevice, c_textureFormat, &formatProperties);
+        const VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        m_vulkanTextureMipBlit = (formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures;
+        if (!m_vulkanTextureMipBlit)
+        {
+            SDL_Log("Game: texture format can't be blitted with linear filtering, mip chains will be generated on the cpu");
+        }
+    }
+
+    // headless never creates a swapchain and its instance has no VK_KHR_surface, the render passes leave its images in general instead
     std::vector<const char*> requiredExtensionNames;
-    requiredExtensionNames.push_back("VK_KHR_swapchain");
+    if (!m_headless)
+    {
+        requiredExtensionNames.push_back("VK_KHR_swapchain");
+    }
 
     // check that requested device
     for (uint32_t i = 0; i < requiredExtensionNames.size(); ++i)
@@ -511,6 +755,9 @@ bool Game::InitVulkanDevice()
         DUCK_DEMO_ASSERT(requestedExtensionAvailableOnDevice);
     }
 
+    // has to outlive vkCreateDevice, the create infos only point at it
+    const float queuePriority = 1.0f;
+
     std::vector<VkDeviceQueueCreateInfo> deviceQueueCreateInfos;
     {
         VkDeviceQueueCreateInfo& deviceQueueCreateInfo = deviceQueueCreateInfos.emplace_back();
@@ -518,8 +765,7 @@ bool Game::InitVulkanDevice()
         deviceQueueCreateInfo.pNext = nullptr;
         deviceQueueCreateInfo.flags = 0;
         deviceQueueCreateInfo.queueCount = 1;
-        float queue_priority = 1.0f;
-        deviceQueueCreateInfo.pQueuePriorities = &queue_priority;
+        deviceQueueCreateInfo.pQueuePriorities = &queuePriority;
         deviceQueueCreateInfo.queueFamilyIndex = m_vulkanGraphicsQueueIndex;
     }
 
@@ -530,11 +776,28 @@ bool Game::InitVulkanDevice()
         deviceQueueCreateInfo.pNext = nullptr;
         deviceQueueCreateInfo.flags = 0;
         deviceQueueCreateInfo.queueCount = 1;
-        float queue_priority = 1.0f;
-        deviceQueueCreateInfo.pQueuePriorities = &queue_priority;
+        deviceQueueCreateInfo.pQueuePriorities = &queuePriority;
         deviceQueueCreateInfo.queueFamilyIndex = m_vulkanComputeQueueIndex;
     }
 
+    if (m_vulkanTransferQueueIndex != m_vulkanGraphicsQueueIndex)
+    {
+        VkDeviceQueueCreateInfo& deviceQueueCreateInfo = deviceQueueCreateInfos.emplace_back();
+        deviceQueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        deviceQueueCreateInfo.pNext = nullptr;
+        deviceQueueCreateInfo.flags = 0;
+        deviceQueueCreateInfo.queueCount = 1;
+        deviceQueueCreateInfo.pQueuePriorities = &queuePriority;
+        deviceQueueCreateInfo.queueFamilyIndex = m_vulkanTransferQueueIndex;
+    }
+
+    {
+        // cooked textures are bc compressed, without it the pngs are loaded instead
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(m_vulkanPhysicalDevice, &supportedFeatures);
+        m_vulkanTextureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
+    }
+
     VkPhysicalDeviceFeatures physicalDeviceFeatures;
     physicalDeviceFeatures.robustBufferAccess = VK_FALSE;
     physicalDeviceFeatures.fullDrawIndexUint32 = VK_FALSE;
@@ -558,7 +821,7 @@ bool Game::InitVulkanDevice()
     physicalDeviceFeatures.samplerAnisotropy = VK_TRUE;
     physicalDeviceFeatures.textureCompressionETC2 = VK_FALSE;
     physicalDeviceFeatures.textureCompressionASTC_LDR = VK_FALSE;
-    physicalDeviceFeatures.textureCompressionBC = VK_FALSE;
+    physicalDeviceFeatures.textureCompressionBC = m_vulkanTextureCompressionBC ? VK_TRUE : VK_FALSE;
     physicalDeviceFeatures.occlusionQueryPrecise = VK_FALSE;
     physicalDeviceFeatures.pipelineStatisticsQuery = VK_FALSE;
     physicalDeviceFeatures.vertexPipelineStoresAndAtomics = VK_FALSE;
@@ -606,6 +869,12 @@ bool Game::InitVulkanDevice()
 
     DUCK_DEMO_VULKAN_ASSERT(vkCreateDevice(m_vulkanPhysicalDevice, &deviceCreateInfo, s_allocator, &m_vulkanDevice));
     vkGetDeviceQueue(m_vulkanDevice, m_vulkanGraphicsQueueIndex, 0, &m_vulkanQueue);
+    vkGetDeviceQueue(m_vulkanDevice, m_vulkanTransferQueueIndex, 0, &m_vulkanTransferQueue);
+
+    if (!Init_VulkanMemoryAllocator(m_vulkanMemoryAllocator))
+    {
+        return false;
+    }
 
     return true;
 }
@@ -775,38 +1044,182 @@ bool Game::InitVulkanSwapChain(const int32_t width, const int32_t height)
     return true;
 }
 
+bool Game::InitVulkanOffscreenImages(const int32_t width, const int32_t height)
+{
+    for (VkImageView imageView : m_vulkanSwapchainImageViews)
+    {
+        vkDestroyImageView(m_vulkanDevice, imageView, nullptr);
+    }
+    m_vulkanSwapchainImageViews.clear();
+
+    FreeVulkanOffscreenImages();
+
+    // imgui wants at least two images and we rotate through them in BeginRender so there has to be one per frame in flight
+    m_vulkanSwapChainImageCount = std::max(2u, m_framesInFlightCount);
+    m_vulkanSwapchainWidth = static_cast<uint32_t>(std::max(width, 1));
+    m_vulkanSwapchainHeight = static_cast<uint32_t>(std::max(height, 1));
+    m_vulkanSwapchainPixelFormat = VK_FORMAT_R8G8B8A8_SRGB;
+
+    for (uint32_t i = 0; i < m_vulkanSwapChainImageCount; ++i)
+    {
+        VkImageCreateInfo imageCreateInfo;
+        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.pNext = nullptr;
+        imageCreateInfo.flags = 0;
+        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.format = m_vulkanSwapchainPixelFormat;
+        imageCreateInfo.extent.width = m_vulkanSwapchainWidth;
+        imageCreateInfo.extent.height = m_vulkanSwapchainHeight;
+        imageCreateInfo.extent.depth = 1;
+        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.arrayLayers = 1;
+        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageCreateInfo.queueFamilyIndexCount = 0;
+        imageCreateInfo.pQueueFamilyIndices = nullptr;
+        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        VkImage& image = m_vulkanOffscreenImages.emplace_back();
+        VkResult result = vkCreateImage(m_vulkanDevice, &imageCreateInfo, s_allocator, &image);
+        if (result != VK_SUCCESS)
+        {
+            DUCK_DEMO_VULKAN_ASSERT(result);
+            return false;
+        }
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(m_vulkanDevice, image, &memoryRequirements);
+
+        const uint32_t memoryTypeIndex = FindMemoryByFlagAndType(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memoryRequirements.memoryTypeBits);
+
+        VulkanAllocation& imageAllocation = m_vulkanOffscreenImageAllocations.emplace_back();
+        result = Allocate_VulkanMemoryAllocator(m_vulkanMemoryAllocator, memoryRequirements, memoryTypeIndex, VulkanMemoryTiling_Optimal, imageAllocation);
+        if (result != VK_SUCCESS)
+        {
+            DUCK_DEMO_VULKAN_ASSERT(result);
+            return false;
+        }
+
+        result = vkBindImageMemory(m_vulkanDevice, image, imageAllocation.m_deviceMemory, imageAllocation.m_offset);
+        if (result != VK_SUCCESS)
+        {
+            DUCK_DEMO_VULKAN_ASSERT(result);
+            return false;
+        }
+
+        VkImageViewCreateInfo imageViewCreateInfo;
+        imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        imageViewCreateInfo.pNext = nullptr;
+        imageViewCreateInfo.flags = 0;
+        imageViewCreateInfo.image = image;
+        imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        imageViewCreateInfo.format = m_vulkanSwapchainPixelFormat;
+        imageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_R;
+        imageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_G;
+        imageViewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_B;
+        imageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_A;
+        imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+        imageViewCreateInfo.subresourceRange.levelCount = 1;
+        imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+        imageViewCreateInfo.subresourceRange.layerCount = 1;
+
+        VkImageView imageView;
+        result = vkCreateImageView(m_vulkanDevice, &imageViewCreateInfo, nullptr, &imageView);
+        if (result != VK_SUCCESS)
+        {
+            DUCK_DEMO_VULKAN_ASSERT(result);
+            return false;
+        }
+
+        m_vulkanSwapchainImageViews.push_back(imageView);
+    }
+
+    m_currentSwapchainImageIndex = 0;
+
+    return true;
+}
+
+void Game::FreeVulkanOffscreenImages()
+{
+    for (VkImage image : m_vulkanOffscreenImages)
+    {
+        vkDestroyImage(m_vulkanDevice, image, s_allocator);
+    }
+    m_vulkanOffscreenImages.clear();
+
+    for (VulkanAllocation& imageAllocation : m_vulkanOffscreenImageAllocations)
+    {
+        Deallocate_VulkanMemoryAllocator(m_vulkanMemoryAllocator, imageAllocation);
+    }
+    m_vulkanOffscreenImageAllocations.clear();
+}
+
 bool Game::InitVulkanGameResources()
 {
-    VkSemaphoreCreateInfo semaphoreCreateInfo;
-    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext = nullptr;
-    semaphoreCreateInfo.flags = 0;
-    DUCK_DEMO_VULKAN_ASSERT(vkCreateSemaphore(m_vulkanDevice, &semaphoreCreateInfo, s_allocator, &m_vulkanAquireSwapchain));
-    DUCK_DEMO_VULKAN_ASSERT(vkCreateSemaphore(m_vulkanDevice, &semaphoreCreateInfo, s_allocator, &m_vulkanReleaseSwapchain));
-
-    VkCommandPoolCreateInfo commandPoolCreateInfo;
-    commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    commandPoolCreateInfo.pNext = nullptr;
-    commandPoolCreateInfo.flags = 0;
-    commandPoolCreateInfo.queueFamilyIndex = m_vulkanGraphicsQueueIndex;
-    DUCK_DEMO_VULKAN_ASSERT(vkCreateCommandPool(m_vulkanDevice, &commandPoolCreateInfo, s_allocator, &m_vulkanPrimaryCommandPool));
-
-    VkCommandBufferAllocateInfo commandBufferAllocateInfo;
-    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    commandBufferAllocateInfo.pNext = nullptr;
-    commandBufferAllocateInfo.commandPool = m_vulkanPrimaryCommandPool;
-    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    commandBufferAllocateInfo.commandBufferCount = 1;
-    DUCK_DEMO_VULKAN_ASSERT(vkAllocateCommandBuffers(m_vulkanDevice, &commandBufferAllocateInfo, &m_vulkanPrimaryCommandBuffer));
-
-    VkFenceCreateInfo fenceCreateInfo;
-    fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceCreateInfo.pNext = nullptr;
-    fenceCreateInfo.flags = 0;
-    DUCK_DEMO_VULKAN_ASSERT(vkCreateFence(m_vulkanDevice, &fenceCreateInfo, s_allocator, &m_vulkanSubmitFence));
+    for (uint32_t i = 0; i < m_framesInFlightCount; ++i)
+    {
+        GameFrame& frame = m_frames[i];
+
+        VkSemaphoreCreateInfo semaphoreCreateInfo;
+        semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreCreateInfo.pNext = nullptr;
+        semaphoreCreateInfo.flags = 0;
+        DUCK_DEMO_VULKAN_ASSERT(vkCreateSemaphore(m_vulkanDevice, &semaphoreCreateInfo, s_allocator, &frame.m_vulkanAquireSwapchain));
+        DUCK_DEMO_VULKAN_ASSERT(vkCreateSemaphore(m_vulkanDevice, &semaphoreCreateInfo, s_allocator, &frame.m_vulkanReleaseSwapchain));
+
+        VkCommandPoolCreateInfo commandPoolCreateInfo;
+        commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        commandPoolCreateInfo.pNext = nullptr;
+        commandPoolCreateInfo.flags = 0;
+        commandPoolCreateInfo.queueFamilyIndex = m_vulkanGraphicsQueueIndex;
+        DUCK_DEMO_VULKAN_ASSERT(vkCreateCommandPool(m_vulkanDevice, &commandPoolCreateInfo, s_allocator, &frame.m_vulkanCommandPool));
+
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo;
+        commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandBufferAllocateInfo.pNext = nullptr;
+        commandBufferAllocateInfo.commandPool = frame.m_vulkanCommandPool;
+        commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        commandBufferAllocateInfo.commandBufferCount = 1;
+        DUCK_DEMO_VULKAN_ASSERT(vkAllocateCommandBuffers(m_vulkanDevice, &commandBufferAllocateInfo, &frame.m_vulkanCommandBuffer));
+
+        // created signaled so the first wait on each frame of the ring doesn't block
+        VkFenceCreateInfo fenceCreateInfo;
+        fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceCreateInfo.pNext = nullptr;
+        fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        DUCK_DEMO_VULKAN_ASSERT(vkCreateFence(m_vulkanDevice, &fenceCreateInfo, s_allocator, &frame.m_vulkanSubmitFence));
+    }
 
     m_vulkanClearValue.color = {{ 0.392156869f, 0.58431375f, 0.929411769f, 1.0f }};
 
+    if (!InitVulkanPipelineCache())
+    {
+        return false;
+    }
+
+    if (!Init_GpuProfiler(m_gpuProfiler, m_framesInFlightCount))
+    {
+        return false;
+    }
+
+    if (!Init_UniformRingBuffer(m_uniformRingBuffer, c_uniformRingBufferFrameSize, m_framesInFlightCount))
+    {
+        return false;
+    }
+
+    if (!Init_UploadManager(m_uploadManager, m_vulkanTransferQueueIndex, m_vulkanTransferQueue, c_uploadManagerStagingSize))
+    {
+        return false;
+    }
+
+    if (!Init_TextureLoader(m_textureLoader))
+    {
+        return false;
+    }
+
     {
         VkCommandPoolCreateInfo commandPoolCreateInfo;
         commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -833,55 +1246,140 @@ bool Game::InitVulkanGameResources()
     return true;
 }
 
-bool Game::BeginRender()
-{   
-    VkResult acquireImageResult = vkAcquireNextImageKHR(m_vulkanDevice, m_vulkanSwapchain, UINT64_MAX, m_vulkanAquireSwapchain, VK_NULL_HANDLE, &m_currentSwapchainImageIndex);
-    if (acquireImageResult != VK_SUCCESS && acquireImageResult != VK_SUBOPTIMAL_KHR && acquireImageResult != VK_ERROR_OUT_OF_DATE_KHR)
-    {
-        // if it's VK_SUBOPTIMAL_KHR or VK_ERROR_OUT_OF_DATE_KHR we'll rebuild the swap chain after the vkQueuePresentKHR
-        // else every other error result besides VK_SUCCESS is considered an unhandled error
-        DUCK_DEMO_VULKAN_ASSERT(acquireImageResult);
-    }
+void Game::WaitForCurrentFrame()
+{
+    DUCK_DEMO_CPU_SCOPE("Game::WaitForCurrentFrame");
 
-    DUCK_DEMO_VULKAN_ASSERT(vkResetCommandPool(m_vulkanDevice, m_vulkanPrimaryCommandPool, 0));
+    // the only cpu/gpu sync point in the frame loop, we block until the gpu is done with the frame we are about to reuse
+    GameFrame& frame = m_frames[m_currentFrameIndex];
+    DUCK_DEMO_VULKAN_ASSERT(vkWaitForFences(m_vulkanDevice, 1, &frame.m_vulkanSubmitFence, VK_TRUE, UINT64_MAX));
 
-    VkCommandBufferBeginInfo commandBufferBeginInfo;
-    commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    commandBufferBeginInfo.pNext = nullptr;
-    commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    commandBufferBeginInfo.pInheritanceInfo = nullptr;
-    DUCK_DEMO_VULKAN_ASSERT(vkBeginCommandBuffer(m_vulkanPrimaryCommandBuffer, &commandBufferBeginInfo));
+    RetireFrame(frame);
+    BeginFrame_UniformRingBuffer(m_uniformRingBuffer, m_currentFrameIndex);
 
-    return true;
+    m_frameCpuStartTime = std::chrono::high_resolution_clock::now();
 }
 
-void Game::EndRender()
+void Game::RetireFrame(GameFrame& frame)
 {
-    DUCK_DEMO_VULKAN_ASSERT(vkEndCommandBuffer(m_vulkanPrimaryCommandBuffer));
+    if (frame.m_frameNumber == 0)
+    {
+        return;
+    }
 
-    VkSubmitInfo submitInfo;
+    RetireFrame_UploadManager(m_uploadManager, frame.m_frameNumber);
+
+    const uint32_t frameIndex = static_cast<uint32_t>(&frame - m_frames.data());
+    const GpuProfilerSample gpuProfilerSample = Resolve_GpuProfiler(m_gpuProfiler, frameIndex, frame.m_frameNumber);
+
+    const double gpuFrameTime = gpuProfilerSample.m_times[GpuProfilerScope_Frame];
+    const double gpuTime = gpuFrameTime >= 0.0 ? gpuFrameTime * 1e-3 : -1.0;
+
+    OnFrameRetired(frame.m_frameNumber, frame.m_cpuTime, gpuTime);
+
+    frame.m_frameNumber = 0;
+}
+
+bool Game::BeginRender()
+{   
+    DUCK_DEMO_CPU_SCOPE("Game::BeginRender");
+
+    GameFrame& frame = m_frames[m_currentFrameIndex];
+
+    if (m_headless)
+    {
+        // there are at least as many offscreen images as frames in flight so the fence we just waited on covers the one we rotate onto
+        m_currentSwapchainImageIndex = (m_currentSwapchainImageIndex + 1) % m_vulkanSwapChainImageCount;
+    }
+    else
+    {
+        VkResult acquireImageResult = vkAcquireNextImageKHR(m_vulkanDevice, m_vulkanSwapchain, UINT64_MAX, frame.m_vulkanAquireSwapchain, VK_NULL_HANDLE, &m_currentSwapchainImageIndex);
+        if (acquireImageResult != VK_SUCCESS && acquireImageResult != VK_SUBOPTIMAL_KHR && acquireImageResult != VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            // if it's VK_SUBOPTIMAL_KHR or VK_ERROR_OUT_OF_DATE_KHR we'll rebuild the swap chain after the vkQueuePresentKHR
+            // else every other error result besides VK_SUCCESS is considered an unhandled error
+            DUCK_DEMO_VULKAN_ASSERT(acquireImageResult);
+        }
+    }
+
+    DUCK_DEMO_VULKAN_ASSERT(vkResetCommandPool(m_vulkanDevice, frame.m_vulkanCommandPool, 0));
+
+    m_vulkanPrimaryCommandBuffer = frame.m_vulkanCommandBuffer;
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo;
+    commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    commandBufferBeginInfo.pNext = nullptr;
+    commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    commandBufferBeginInfo.pInheritanceInfo = nullptr;
+    DUCK_DEMO_VULKAN_ASSERT(vkBeginCommandBuffer(m_vulkanPrimaryCommandBuffer, &commandBufferBeginInfo));
+
+    BeginScope_GpuProfiler(m_gpuProfiler, m_vulkanPrimaryCommandBuffer, m_currentFrameIndex, GpuProfilerScope_Frame);
+
+    RecordMipBlits_TextureLoader(m_textureLoader, m_vulkanPrimaryCommandBuffer);
+
+    return true;
+}
+
+void Game::EndRender()
+{
+    DUCK_DEMO_CPU_SCOPE("Game::EndRender");
+
+    GameFrame& frame = m_frames[m_currentFrameIndex];
+
+    EndScope_GpuProfiler(m_gpuProfiler, m_vulkanPrimaryCommandBuffer, m_currentFrameIndex, GpuProfilerScope_Frame);
+
+    DUCK_DEMO_VULKAN_ASSERT(vkEndCommandBuffer(m_vulkanPrimaryCommandBuffer));
+
+    Flush_UniformRingBuffer(m_uniformRingBuffer);
+
+    DUCK_DEMO_VULKAN_ASSERT(vkResetFences(m_vulkanDevice, 1, &frame.m_vulkanSubmitFence));
+
+    if (!m_headless)
+    {
+        AddRenderWaitSemaphore(frame.m_vulkanAquireSwapchain, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+    }
+
+    AddRenderWaits_UploadManager(m_uploadManager, m_gameTimer.FrameCount());
+
+    VkSubmitInfo submitInfo;
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.pNext = nullptr;
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = &m_vulkanAquireSwapchain;
-    const VkPipelineStageFlags waitPipelineStageFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    submitInfo.pWaitDstStageMask = &waitPipelineStageFlags;
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(m_renderWaitSemaphores.size());
+    submitInfo.pWaitSemaphores = m_renderWaitSemaphores.data();
+    submitInfo.pWaitDstStageMask = m_renderWaitStageFlags.data();
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &m_vulkanPrimaryCommandBuffer;
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &m_vulkanReleaseSwapchain;
-    DUCK_DEMO_VULKAN_ASSERT(vkQueueSubmit(m_vulkanQueue, 1, &submitInfo, m_vulkanSubmitFence));
+    submitInfo.signalSemaphoreCount = m_headless ? 0 : 1;
+    submitInfo.pSignalSemaphores = m_headless ? nullptr : &frame.m_vulkanReleaseSwapchain;
+    DUCK_DEMO_VULKAN_ASSERT(vkQueueSubmit(m_vulkanQueue, 1, &submitInfo, frame.m_vulkanSubmitFence));
+
+    // cpu time covers update, recording and submit but not the fence wait or present which only measure the gpu
+    frame.m_frameNumber = m_gameTimer.FrameCount();
+    frame.m_cpuTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_frameCpuStartTime).count();
+
+    m_renderWaitSemaphores.clear();
+    m_renderWaitStageFlags.clear();
+
+    if (m_headless)
+    {
+        m_vulkanPrimaryCommandBuffer = VK_NULL_HANDLE;
+        m_currentFrameIndex = (m_currentFrameIndex + 1) % m_framesInFlightCount;
+        return;
+    }
 
     VkPresentInfoKHR presentInfo;
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.pNext = nullptr;
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = &m_vulkanReleaseSwapchain;
+    presentInfo.pWaitSemaphores = &frame.m_vulkanReleaseSwapchain;
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = &m_vulkanSwapchain;
     presentInfo.pImageIndices = &m_currentSwapchainImageIndex;
     presentInfo.pResults = nullptr;
 
+    m_vulkanPrimaryCommandBuffer = VK_NULL_HANDLE;
+    m_currentFrameIndex = (m_currentFrameIndex + 1) % m_framesInFlightCount;
+
     const VkResult queuePresentResult = vkQueuePresentKHR(m_vulkanQueue, &presentInfo);
     if (queuePresentResult == VK_SUBOPTIMAL_KHR || queuePresentResult == VK_ERROR_OUT_OF_DATE_KHR)
     {
@@ -891,13 +1389,102 @@ void Game::EndRender()
     {
         DUCK_DEMO_VULKAN_ASSERT(queuePresentResult);
     }
+}
+
+void Game::AddRenderWaitSemaphore(VkSemaphore semaphore, const VkPipelineStageFlags waitStageFlags)
+{
+    m_renderWaitSemaphores.push_back(semaphore);
+    m_renderWaitStageFlags.push_back(waitStageFlags);
+}
+
+static VkResult CreateShaderModuleFromSpirv(VkDevice device, const void* spirv, const size_t spirvSize, VkShaderModule* OutShaderModule)
+{
+    constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+    if (spirvSize < sizeof(uint32_t) || spirvSize % sizeof(uint32_t) != 0 || SPIRV_MAGIC != *static_cast<const uint32_t*>(spirv))
+    {
+        // shader data did not start with spir-v magic value
+        return VK_ERROR_UNKNOWN;
+    }
+
+    VkShaderModuleCreateInfo shaderModuleCreateInfo;
+    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleCreateInfo.pNext = nullptr;
+    shaderModuleCreateInfo.flags = 0;
+    shaderModuleCreateInfo.codeSize = spirvSize;
+    shaderModuleCreateInfo.pCode = static_cast<const uint32_t*>(spirv);
+
+    VkResult vulkanResult = vkCreateShaderModule(device, &shaderModuleCreateInfo, s_allocator, OutShaderModule);
+    DUCK_DEMO_VULKAN_ASSERT(vulkanResult);
+    return vulkanResult;
+}
+
+VkResult Game::LoadShader(const std::string& path, const shaderc_shader_kind shaderKind, VkShaderModule* OutShaderModule, const ShaderMacros& shaderMacros /*= ShaderMacros()*/)
+{
+#ifdef DUCK_DEMO_PRECOMPILED_SHADERS
+    (void)shaderKind;
+
+    // same key cmake/EmbeddedShaders.cmake writes out, the -D flags sorted and joined by spaces
+    std::vector<std::string> defines;
+    for (const std::pair<std::string, std::string>& shaderMacro : shaderMacros)
+    {
+        defines.push_back(shaderMacro.second.empty() ? "-D" + shaderMacro.first : "-D" + shaderMacro.first + "=" + shaderMacro.second);
+    }
+    std::sort(defines.begin(), defines.end());
 
-    DUCK_DEMO_VULKAN_ASSERT(vkWaitForFences(m_vulkanDevice, 1, &m_vulkanSubmitFence, VK_TRUE, UINT64_MAX));
-    vkResetFences(m_vulkanDevice, 1, &m_vulkanSubmitFence);
+    std::string definesKey;
+    for (const std::string& define : defines)
+    {
+        definesKey += definesKey.empty() ? define : " " + define;
+    }
+
+    for (const EmbeddedShader& embeddedShader : c_embeddedShaders)
+    {
+        if (path == embeddedShader.m_path && definesKey == embeddedShader.m_defines)
+        {
+            return CreateShaderModuleFromSpirv(m_vulkanDevice, embeddedShader.m_spirv, embeddedShader.m_spirvSize, OutShaderModule);
+        }
+    }
+
+    DUCK_DEMO_SHOW_ERROR("Shader Load Error", DuckDemoUtils::format("%s [%s] was not precompiled, add the permutation to CMakeLists.txt", path.c_str(), definesKey.c_str()));
+    return VK_ERROR_INITIALIZATION_FAILED;
+#else
+    return CompileShaderFromDisk(path, shaderKind, OutShaderModule, shaderMacros);
+#endif // DUCK_DEMO_PRECOMPILED_SHADERS
+}
+
+#ifndef DUCK_DEMO_PRECOMPILED_SHADERS
+static std::string GetShaderCachePath(const DuckDemoFile& shaderFile, const shaderc_shader_kind shaderKind, const ShaderMacros& shaderMacros)
+{
+    // bump when the way the key is built changes
+    constexpr uint32_t shaderCacheVersion = 1;
+
+    unsigned int spirvVersion = 0;
+    unsigned int spirvRevision = 0;
+    shaderc_get_spv_version(&spirvVersion, &spirvRevision);
+
+    const std::string shadercVersion = DUCK_DEMO_SHADERC_VERSION;
+    const uint32_t kind = static_cast<uint32_t>(shaderKind);
+
+    uint64_t hash = DuckDemoUtils::HashFnv1a(&shaderCacheVersion, sizeof(shaderCacheVersion));
+    hash = DuckDemoUtils::HashFnv1a(shadercVersion.c_str(), shadercVersion.size() + 1, hash);
+    hash = DuckDemoUtils::HashFnv1a(&spirvVersion, sizeof(spirvVersion), hash);
+    hash = DuckDemoUtils::HashFnv1a(&spirvRevision, sizeof(spirvRevision), hash);
+    hash = DuckDemoUtils::HashFnv1a(&kind, sizeof(kind), hash);
+    hash = DuckDemoUtils::HashFnv1a(shaderFile.buffer.get(), shaderFile.bufferSize, hash);
+    for (const std::pair<std::string, std::string>& shaderMacro : shaderMacros)
+    {
+        // the terminators keep {"AB", ""} and {"A", "B"} apart
+        hash = DuckDemoUtils::HashFnv1a(shaderMacro.first.c_str(), shaderMacro.first.size() + 1, hash);
+        hash = DuckDemoUtils::HashFnv1a(shaderMacro.second.c_str(), shaderMacro.second.size() + 1, hash);
+    }
+
+    return DuckDemoUtils::format("%s/%016llx.spv", c_shaderCacheDirectory, static_cast<unsigned long long>(hash));
 }
 
-VkResult Game::CompileShaderFromDisk(const std::string& path, const shaderc_shader_kind shaderKind, VkShaderModule* OutShaderModule, const shaderc_compile_options_t compileOptions /*= nullptr*/)
+VkResult Game::CompileShaderFromDisk(const std::string& path, const shaderc_shader_kind shaderKind, VkShaderModule* OutShaderModule, const ShaderMacros& shaderMacros /*= ShaderMacros()*/)
 {
+    DUCK_DEMO_CPU_SCOPE("Game::CompileShaderFromDisk");
+
     std::unique_ptr<DuckDemoFile> shaderFile = DuckDemoUtils::LoadFileFromDisk(path);
     DUCK_DEMO_ASSERT(shaderFile);
     if (shaderFile == nullptr)
@@ -905,12 +1492,76 @@ VkResult Game::CompileShaderFromDisk(const std::string& path, const shaderc_shad
         return VK_ERROR_UNKNOWN;
     }
 
+    const std::string cachePath = GetShaderCachePath(*shaderFile, shaderKind, shaderMacros);
+    if (m_shaderCacheEnabled)
+    {
+        std::unique_ptr<DuckDemoFile> cachedFile = DuckDemoUtils::LoadFileFromDisk(cachePath);
+        if (cachedFile != nullptr)
+        {
+            // a broken cache file is treated like a miss and written again below
+            if (CreateShaderModuleFromSpirv(m_vulkanDevice, cachedFile->buffer.get(), cachedFile->bufferSize, OutShaderModule) == VK_SUCCESS)
+            {
+                std::lock_guard<std::mutex> lock(m_shaderCompilerMutex);
+                ++m_shaderCacheHitCount;
+                return VK_SUCCESS;
+            }
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Shader cache: %s for %s is not valid spir-v", cachePath.c_str(), path.c_str());
+        }
+    }
+
+    const std::chrono::high_resolution_clock::time_point compileStartTime = std::chrono::high_resolution_clock::now();
+
+    shaderc_compiler_t shaderCompiler = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_shaderCompilerMutex);
+        ++m_shaderCacheMissCount;
+        if (!m_shaderCompilers.empty())
+        {
+            shaderCompiler = m_shaderCompilers.back();
+            m_shaderCompilers.pop_back();
+        }
+    }
+
+    if (shaderCompiler == nullptr)
+    {
+        shaderCompiler = shaderc_compiler_initialize();
+        if (shaderCompiler == nullptr)
+        {
+            DUCK_DEMO_ASSERT(false);
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+    }
+
+    shaderc_compile_options_t compileOptions = shaderc_compile_options_initialize();
+    if (compileOptions == nullptr)
+    {
+        DUCK_DEMO_ASSERT(false);
+        std::lock_guard<std::mutex> lock(m_shaderCompilerMutex);
+        m_shaderCompilers.push_back(shaderCompiler);
+        return VK_ERROR_UNKNOWN;
+    }
+
+    for (const std::pair<std::string, std::string>& shaderMacro : shaderMacros)
+    {
+        shaderc_compile_options_add_macro_definition(compileOptions,
+            shaderMacro.first.c_str(), shaderMacro.first.size(),
+            shaderMacro.second.empty() ? nullptr : shaderMacro.second.c_str(), shaderMacro.second.size());
+    }
+
     shaderc_compilation_result_t result = shaderc_compile_into_spv(
-        m_shaderCompiler,
+        shaderCompiler,
         shaderFile->buffer.get(),
         shaderFile->bufferSize, shaderKind,
         "Shader.file", "main", compileOptions);
 
+    shaderc_compile_options_release(compileOptions);
+
+    {
+        std::lock_guard<std::mutex> lock(m_shaderCompilerMutex);
+        m_shaderCompilers.push_back(shaderCompiler);
+        m_shaderCompileTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - compileStartTime).count();
+    }
+
     DUCK_DEMO_ASSERT(result);
     if (result == nullptr)
     {
@@ -931,31 +1582,143 @@ VkResult Game::CompileShaderFromDisk(const std::string& path, const shaderc_shad
         return VK_ERROR_UNKNOWN;
     }
 
-    const uint32_t* shaderData = reinterpret_cast<const uint32_t*>(shaderc_result_get_bytes(result));
+    const char* shaderData = shaderc_result_get_bytes(result);
     size_t shaderDataSize = shaderc_result_get_length(result);
 
-    constexpr uint32_t SPIRV_MAGIC = 0x07230203;
-    if (SPIRV_MAGIC != shaderData[0])
+    VkResult vulkanResult = CreateShaderModuleFromSpirv(m_vulkanDevice, shaderData, shaderDataSize, OutShaderModule);
+    if (vulkanResult == VK_SUCCESS && m_shaderCacheEnabled)
     {
-        shaderc_result_release(result);
-        // shader data did not start with spir-v magic value
-        return VK_ERROR_UNKNOWN;
+        if (!DuckDemoUtils::CreateDirectoryOnDisk(c_shaderCacheDirectory) || !DuckDemoUtils::WriteFileToDisk(cachePath, shaderData, shaderDataSize))
+        {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Shader cache: failed to write %s", cachePath.c_str());
+        }
     }
 
-    VkShaderModuleCreateInfo shaderModuleCreateInfo;
-    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    shaderModuleCreateInfo.pNext = nullptr;
-    shaderModuleCreateInfo.flags = 0;
-    shaderModuleCreateInfo.codeSize = shaderDataSize;
-    shaderModuleCreateInfo.pCode = shaderData;
-
-    VkResult vulkanResult = vkCreateShaderModule(m_vulkanDevice, &shaderModuleCreateInfo, s_allocator, OutShaderModule);
-    DUCK_DEMO_VULKAN_ASSERT(vulkanResult);
-
     shaderc_result_release(result);
 
     return vulkanResult;
 }
+#endif // DUCK_DEMO_PRECOMPILED_SHADERS
+
+bool Game::InitVulkanPipelineCache()
+{
+    DUCK_DEMO_CPU_SCOPE("Game::InitVulkanPipelineCache");
+
+    std::unique_ptr<DuckDemoFile> cacheFile;
+    if (m_pipelineCacheEnabled)
+    {
+        cacheFile = DuckDemoUtils::LoadFileFromDisk(c_pipelineCacheFilePath);
+    }
+
+    if (cacheFile != nullptr)
+    {
+        VkPhysicalDeviceProperties physicalDeviceProperties;
+        vkGetPhysicalDeviceProperties(m_vulkanPhysicalDevice, &physicalDeviceProperties);
+
+        // drivers are supposed to reject data from another device or driver version themselves but not all of them do,
+        // so anything that wasn't written by this exact device and driver is thrown away before vulkan sees it
+        bool valid = cacheFile->bufferSize >= c_pipelineCacheHeaderSize;
+        if (valid)
+        {
+            uint32_t header[4];
+            memcpy(header, cacheFile->buffer.get(), sizeof(header));
+            valid = header[0] >= c_pipelineCacheHeaderSize && header[0] <= cacheFile->bufferSize
+                && header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+                && header[2] == physicalDeviceProperties.vendorID
+                && header[3] == physicalDeviceProperties.deviceID
+                && memcmp(cacheFile->buffer.get() + sizeof(header), physicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        }
+
+        if (!valid)
+        {
+            SDL_Log("Pipeline cache: %s is from another device or driver, starting cold", c_pipelineCacheFilePath);
+            cacheFile.reset();
+        }
+    }
+
+    VkPipelineCacheCreateInfo pipelineCacheCreateInfo;
+    pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    pipelineCacheCreateInfo.pNext = nullptr;
+    pipelineCacheCreateInfo.flags = 0;
+    pipelineCacheCreateInfo.initialDataSize = cacheFile ? cacheFile->bufferSize : 0;
+    pipelineCacheCreateInfo.pInitialData = cacheFile ? cacheFile->buffer.get() : nullptr;
+
+    VkResult result = vkCreatePipelineCache(m_vulkanDevice, &pipelineCacheCreateInfo, s_allocator, &m_vulkanPipelineCache);
+    if (result != VK_SUCCESS && cacheFile != nullptr)
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Pipeline cache: driver rejected %s, starting cold", c_pipelineCacheFilePath);
+        cacheFile.reset();
+        pipelineCacheCreateInfo.initialDataSize = 0;
+        pipelineCacheCreateInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(m_vulkanDevice, &pipelineCacheCreateInfo, s_allocator, &m_vulkanPipelineCache);
+    }
+
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    m_pipelineCacheWarm = cacheFile != nullptr;
+
+    return true;
+}
+
+void Game::SaveVulkanPipelineCache()
+{
+    if (!m_pipelineCacheEnabled)
+    {
+        return;
+    }
+
+    std::size_t dataSize = 0;
+    VkResult result = vkGetPipelineCacheData(m_vulkanDevice, m_vulkanPipelineCache, &dataSize, nullptr);
+    if (result != VK_SUCCESS || dataSize == 0)
+    {
+        return;
+    }
+
+    std::unique_ptr<char[]> data(new char[dataSize]);
+    result = vkGetPipelineCacheData(m_vulkanDevice, m_vulkanPipelineCache, &dataSize, data.get());
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return;
+    }
+
+    if (!DuckDemoUtils::CreateDirectoryOnDisk(c_shaderCacheDirectory) || !DuckDemoUtils::WriteFileToDisk(c_pipelineCacheFilePath, data.get(), dataSize))
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Pipeline cache: failed to write %s", c_pipelineCacheFilePath);
+    }
+}
+
+VkResult Game::CreateVulkanGraphicsPipeline(const VkGraphicsPipelineCreateInfo& graphicsPipelineCreateInfo, VkPipeline* OutPipeline)
+{
+    DUCK_DEMO_CPU_SCOPE("Game::CreateVulkanGraphicsPipeline");
+
+    const std::chrono::high_resolution_clock::time_point createStartTime = std::chrono::high_resolution_clock::now();
+    const VkResult result = vkCreateGraphicsPipelines(m_vulkanDevice, m_vulkanPipelineCache, 1, &graphicsPipelineCreateInfo, s_allocator, OutPipeline);
+
+    std::lock_guard<std::mutex> lock(m_pipelineStatsMutex);
+    m_pipelineCreateTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - createStartTime).count();
+    ++m_pipelineCreateCount;
+
+    return result;
+}
+
+VkResult Game::CreateVulkanComputePipeline(const VkComputePipelineCreateInfo& computePipelineCreateInfo, VkPipeline* OutPipeline)
+{
+    DUCK_DEMO_CPU_SCOPE("Game::CreateVulkanComputePipeline");
+
+    const std::chrono::high_resolution_clock::time_point createStartTime = std::chrono::high_resolution_clock::now();
+    const VkResult result = vkCreateComputePipelines(m_vulkanDevice, m_vulkanPipelineCache, 1, &computePipelineCreateInfo, s_allocator, OutPipeline);
+
+    std::lock_guard<std::mutex> lock(m_pipelineStatsMutex);
+    m_pipelineCreateTime += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - createStartTime).count();
+    ++m_pipelineCreateCount;
+
+    return result;
+}
 
 int32_t Game::FindMemoryByFlagAndType(const VkMemoryPropertyFlagBits memoryFlagBits, const uint32_t memoryTypeBits) const
 {
@@ -1004,26 +1767,20 @@ VkResult Game::CreateVulkanBuffer(const VkDeviceSize deviceSize, const VkBufferU
     VkMemoryRequirements memoryRequirements;
     vkGetBufferMemoryRequirements(m_vulkanDevice, OutVulkanBuffer.m_buffer, &memoryRequirements);
 
-    VkMemoryAllocateInfo memoryAllocateInfo;
-    memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    memoryAllocateInfo.pNext = nullptr;
-    memoryAllocateInfo.allocationSize = memoryRequirements.size;
-
     const int32_t memoryTypeIndex = FindMemoryByFlagAndType(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, memoryRequirements.memoryTypeBits);
     if (memoryTypeIndex < 0)
     {
         return result;
     }
-    memoryAllocateInfo.memoryTypeIndex = static_cast<uint32_t>(memoryTypeIndex);
 
-    result = vkAllocateMemory(m_vulkanDevice, &memoryAllocateInfo, s_allocator, &OutVulkanBuffer.m_deviceMemory);
+    result = Allocate_VulkanMemoryAllocator(m_vulkanMemoryAllocator, memoryRequirements, static_cast<uint32_t>(memoryTypeIndex), VulkanMemoryTiling_Linear, OutVulkanBuffer.m_allocation);
     DUCK_DEMO_VULKAN_ASSERT(result);
     if (result != VK_SUCCESS)
     {
         return result;
     }
 
-    result = vkBindBufferMemory(m_vulkanDevice, OutVulkanBuffer.m_buffer, OutVulkanBuffer.m_deviceMemory, 0);
+    result = vkBindBufferMemory(m_vulkanDevice, OutVulkanBuffer.m_buffer, OutVulkanBuffer.m_allocation.m_deviceMemory, OutVulkanBuffer.m_allocation.m_offset);
     DUCK_DEMO_VULKAN_ASSERT(result);
     if (result != VK_SUCCESS)
     {
@@ -1035,6 +1792,65 @@ VkResult Game::CreateVulkanBuffer(const VkDeviceSize deviceSize, const VkBufferU
     return result;
 }
 
+VkResult Game::CreateVulkanDeviceBuffer(const VkDeviceSize deviceSize, const VkBufferUsageFlags bufferUsageFlags, const void* data, VulkanBuffer& OutVulkanBuffer)
+{
+    OutVulkanBuffer.Reset();
+
+    // with a transfer only family the copy and the draws happen on different queues, concurrent saves handing ownership over
+    const std::array<uint32_t, 2> queueFamilyIndices = { m_vulkanGraphicsQueueIndex, m_vulkanTransferQueueIndex };
+    const bool concurrent = m_vulkanTransferQueueIndex != m_vulkanGraphicsQueueIndex;
+
+    VkBufferCreateInfo bufferCreateInfo;
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.pNext = nullptr;
+    bufferCreateInfo.flags = 0;
+    bufferCreateInfo.size = deviceSize;
+    bufferCreateInfo.usage = bufferUsageFlags | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    bufferCreateInfo.sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+    bufferCreateInfo.queueFamilyIndexCount = concurrent ? static_cast<uint32_t>(queueFamilyIndices.size()) : 0;
+    bufferCreateInfo.pQueueFamilyIndices = concurrent ? queueFamilyIndices.data() : nullptr;
+
+    VkResult result = vkCreateBuffer(m_vulkanDevice, &bufferCreateInfo, s_allocator, &OutVulkanBuffer.m_buffer);
+    DUCK_DEMO_VULKAN_ASSERT(result);
+    if (result != VK_SUCCESS)
+    {
+        return result;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(m_vulkanDevice, OutVulkanBuffer.m_buffer, &memoryRequirements);
+
+    const uint32_t memoryTypeIndex = FindMemoryType_VulkanMemoryAllocator(m_vulkanMemoryAllocator, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (memoryTypeIndex == c_vulkanMemoryInvalidIndex)
+    {
+        DUCK_DEMO_SHOW_ERROR("Critical Vulkan Error", "Could not find device local memory for a buffer");
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+
+    result = Allocate_VulkanMemoryAllocator(m_vulkanMemoryAllocator, memoryRequirements, memoryTypeIndex, VulkanMemoryTiling_Linear, OutVulkanBuffer.m_allocation);
+    DUCK_DEMO_VULKAN_ASSERT(result);
+    if (result != VK_SUCCESS)
+    {
+        return result;
+    }
+
+    result = vkBindBufferMemory(m_vulkanDevice, OutVulkanBuffer.m_buffer, OutVulkanBuffer.m_allocation.m_deviceMemory, OutVulkanBuffer.m_allocation.m_offset);
+    DUCK_DEMO_VULKAN_ASSERT(result);
+    if (result != VK_SUCCESS)
+    {
+        return result;
+    }
+
+    OutVulkanBuffer.m_deviceSize = deviceSize;
+
+    if (data != nullptr)
+    {
+        UploadBuffer_UploadManager(m_uploadManager, OutVulkanBuffer.m_buffer, 0, data, deviceSize);
+    }
+
+    return result;
+}
+
 void Game::FillVulkanBuffer(VulkanBuffer& vulkanBuffer, const void* data, const std::size_t dataSize, const VkDeviceSize offset /*= 0*/)
 {
     //vkCmdUpdateBuffer( CommandBuffer, myBuffer.buffer, 0, myBuffer.size, data );
@@ -1042,18 +1858,17 @@ void Game::FillVulkanBuffer(VulkanBuffer& vulkanBuffer, const void* data, const
 
     DUCK_DEMO_ASSERT(dataSize <= vulkanBuffer.m_deviceSize); // copying more data into the buffer than it's total size
 
-    void* gpuMemory = nullptr;
-    vkMapMemory(m_vulkanDevice, vulkanBuffer.m_deviceMemory, offset, static_cast<VkDeviceSize>(dataSize), 0, &gpuMemory);
-    memcpy(gpuMemory, data, std::min(dataSize, vulkanBuffer.m_deviceSize));
-    vkUnmapMemory(m_vulkanDevice, vulkanBuffer.m_deviceMemory);
+    // the allocator keeps host visible pages mapped, the buffer's memory is already sitting at m_mappedData
+    DUCK_DEMO_ASSERT(vulkanBuffer.m_allocation.m_mappedData != nullptr);
+    memcpy(vulkanBuffer.m_allocation.m_mappedData + offset, data, std::min(dataSize, vulkanBuffer.m_deviceSize));
+    Flush_VulkanMemoryAllocator(m_vulkanMemoryAllocator, vulkanBuffer.m_allocation, offset, std::min(dataSize, vulkanBuffer.m_deviceSize));
 }
 
 void Game::ZeroVulkanBuffer(VulkanBuffer& vulkanBuffer)
 {
-    void* gpuMemory = nullptr;
-    vkMapMemory(m_vulkanDevice, vulkanBuffer.m_deviceMemory, 0, VK_WHOLE_SIZE, 0, &gpuMemory);
-    memset(gpuMemory, '\0', vulkanBuffer.m_deviceSize);
-    vkUnmapMemory(m_vulkanDevice, vulkanBuffer.m_deviceMemory);
+    DUCK_DEMO_ASSERT(vulkanBuffer.m_allocation.m_mappedData != nullptr);
+    memset(vulkanBuffer.m_allocation.m_mappedData, '\0', vulkanBuffer.m_deviceSize);
+    Flush_VulkanMemoryAllocator(m_vulkanMemoryAllocator, vulkanBuffer.m_allocation, 0, vulkanBuffer.m_deviceSize);
 }
 
 bool Game::InitVulkanDepthStencilImage()
@@ -1087,20 +1902,16 @@ bool Game::InitVulkanDepthStencilImage()
     VkMemoryRequirements memoryRequirements;
     vkGetImageMemoryRequirements(m_vulkanDevice, m_vulkanDepthStencilImage, &memoryRequirements);
 
-    VkMemoryAllocateInfo memoryAllocateInfo;
-    memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    memoryAllocateInfo.pNext = nullptr;
-    memoryAllocateInfo.allocationSize = memoryRequirements.size;
-    memoryAllocateInfo.memoryTypeIndex = FindMemoryByFlagAndType(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memoryRequirements.memoryTypeBits);
+    const uint32_t memoryTypeIndex = FindMemoryByFlagAndType(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memoryRequirements.memoryTypeBits);
 
-    result = vkAllocateMemory(m_vulkanDevice, &memoryAllocateInfo, s_allocator, &m_vulkanDepthStencilImageMemory);
+    result = Allocate_VulkanMemoryAllocator(m_vulkanMemoryAllocator, memoryRequirements, memoryTypeIndex, VulkanMemoryTiling_Optimal, m_vulkanDepthStencilImageAllocation);
     DUCK_DEMO_VULKAN_ASSERT(result);
     if (result != VK_SUCCESS)
     {
         return false;
     }
 
-    result = vkBindImageMemory(m_vulkanDevice, m_vulkanDepthStencilImage, m_vulkanDepthStencilImageMemory, 0);
+    result = vkBindImageMemory(m_vulkanDevice, m_vulkanDepthStencilImage, m_vulkanDepthStencilImageAllocation.m_deviceMemory, m_vulkanDepthStencilImageAllocation.m_offset);
     DUCK_DEMO_VULKAN_ASSERT(result);
     if (result != VK_SUCCESS)
     {
@@ -1146,10 +1957,7 @@ void Game::FreeVulkanDepthStencilImage()
         vkDestroyImage(m_vulkanDevice, m_vulkanDepthStencilImage, s_allocator);
     }
 
-    if (m_vulkanDepthStencilImageMemory)
-    {
-        vkFreeMemory(m_vulkanDevice, m_vulkanDepthStencilImageMemory, s_allocator);
-    }
+    Deallocate_VulkanMemoryAllocator(m_vulkanMemoryAllocator, m_vulkanDepthStencilImageAllocation);
 }
 
 VkDeviceSize Game::CalculateUniformBufferSize(const std::size_t size) const
@@ -1157,77 +1965,69 @@ VkDeviceSize Game::CalculateUniformBufferSize(const std::size_t size) const
     return m_minUniformBufferOffsetAlignment * static_cast<VkDeviceSize>(ceil(static_cast<float>(size) / m_minUniformBufferOffsetAlignment));
 }
 
-VkResult Game::CreateVulkanTexture(const std::string path, VulkanTexture& outVulkanTexture)
+VkResult Game::CreateVulkanDeviceTexture(const uint32_t width, const uint32_t height, const void* pixels, const uint32_t pixelLevelCount, VulkanTexture& OutVulkanTexture, uint64_t* OutUploadValue /*= nullptr*/)
 {
-    outVulkanTexture.Reset();
+    DUCK_DEMO_CPU_SCOPE("Game::CreateVulkanDeviceTexture");
+
+    constexpr uint32_t texelSize = 4;
+    const uint32_t mipLevelCount = GetLevelCount_MipChain(width, height);
+    DUCK_DEMO_ASSERT(pixelLevelCount >= 1 && pixelLevelCount <= mipLevelCount);
 
-    std::unique_ptr<DuckDemoFile> diffuseTexture = DuckDemoUtils::LoadFileFromDisk(path);
-    if (diffuseTexture == nullptr)
+    // only callers that didn't do it on their own thread end up here
+    std::vector<uint8_t> mipChain;
+    uint32_t uploadLevelCount = pixelLevelCount;
+    if (pixelLevelCount < mipLevelCount && !m_vulkanTextureMipBlit)
     {
-        DUCK_DEMO_ASSERT(false);
-        return VK_ERROR_UNKNOWN;
+        mipChain.resize(GetSize_MipChain(width, height, mipLevelCount, texelSize));
+        memcpy(mipChain.data(), pixels, GetSize_MipChain(width, height, pixelLevelCount, texelSize));
+        Generate_MipChain(mipChain.data(), width, height, mipLevelCount);
+        pixels = mipChain.data();
+        uploadLevelCount = mipLevelCount;
     }
 
-    int width;
-    int height;
-    int channelsInFile;
-
-    stbi_uc* imageData = stbi_load_from_memory(
-        reinterpret_cast<stbi_uc*>(diffuseTexture->buffer.get()),
-        static_cast<int>(diffuseTexture->bufferSize), 
-        &width, 
-        &height, 
-        &channelsInFile, 
-        STBI_rgb_alpha);
-
-    if (imageData == nullptr)
+    const VkResult result = CreateVulkanTextureImage(c_textureFormat, width, height, mipLevelCount, OutVulkanTexture);
+    if (result != VK_SUCCESS)
     {
-        DUCK_DEMO_ASSERT(false);
-        return VK_ERROR_UNKNOWN;
+        return result;
     }
 
-    DUCK_DEMO_ASSERT(width != 0);
-    DUCK_DEMO_ASSERT(height != 0);
-    DUCK_DEMO_ASSERT(channelsInFile != 0);
+    const uint64_t uploadValue = UploadImage_UploadManager(m_uploadManager, OutVulkanTexture.m_image, width, height, texelSize, 1, uploadLevelCount, pixels);
+    if (OutUploadValue != nullptr)
+    {
+        *OutUploadValue = uploadValue;
+    }
 
-    constexpr VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    return VK_SUCCESS;
+}
 
-    VkBuffer stagingBuffer = VK_NULL_HANDLE;
-    VkDeviceMemory stagingDeviceMemory = VK_NULL_HANDLE;
+VkResult Game::CreateVulkanCompressedTexture(const VkFormat format, const uint32_t width, const uint32_t height, const uint32_t levelCount, const uint32_t blockSize, const void* blocks, VulkanTexture& OutVulkanTexture, uint64_t* OutUploadValue /*= nullptr*/)
+{
+    DUCK_DEMO_CPU_SCOPE("Game::CreateVulkanCompressedTexture");
 
-    VkBufferCreateInfo bufferCreateInfo;
-    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferCreateInfo.pNext = nullptr;
-    bufferCreateInfo.flags = 0;
-    bufferCreateInfo.size = static_cast<VkDeviceSize>(width * height * channelsInFile);
-    bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    bufferCreateInfo.queueFamilyIndexCount = 0;
-    bufferCreateInfo.pQueueFamilyIndices = nullptr;
-    VkResult result = vkCreateBuffer(m_vulkanDevice, &bufferCreateInfo, s_allocator, &stagingBuffer);
+    const VkResult result = CreateVulkanTextureImage(format, width, height, levelCount, OutVulkanTexture);
     if (result != VK_SUCCESS)
     {
-        DUCK_DEMO_VULKAN_ASSERT(result);
         return result;
     }
 
-    VkMemoryRequirements memoryRequirements;
-    vkGetBufferMemoryRequirements(m_vulkanDevice, stagingBuffer, &memoryRequirements);
+    // every bc format is made of 4x4 blocks
+    constexpr uint32_t blockExtent = 4;
+    const uint64_t uploadValue = UploadImage_UploadManager(m_uploadManager, OutVulkanTexture.m_image, width, height, blockSize, blockExtent, levelCount, blocks);
+    if (OutUploadValue != nullptr)
+    {
+        *OutUploadValue = uploadValue;
+    }
 
-    VkMemoryAllocateInfo memoryAllocateInfo;
-    memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    memoryAllocateInfo.pNext = nullptr;
-    memoryAllocateInfo.allocationSize = memoryRequirements.size;
-    memoryAllocateInfo.memoryTypeIndex = FindMemoryByFlagAndType(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, memoryRequirements.memoryTypeBits);
+    return VK_SUCCESS;
+}
 
-    DUCK_DEMO_VULKAN_ASSERT(vkAllocateMemory(m_vulkanDevice, &memoryAllocateInfo, s_allocator, &stagingDeviceMemory));
-    DUCK_DEMO_VULKAN_ASSERT(vkBindBufferMemory(m_vulkanDevice, stagingBuffer, stagingDeviceMemory, 0));
+VkResult Game::CreateVulkanTextureImage(const VkFormat format, const uint32_t width, const uint32_t height, const uint32_t mipLevelCount, VulkanTexture& OutVulkanTexture)
+{
+    OutVulkanTexture.Reset();
 
-    uint8_t *mappedData = nullptr;
-    result = vkMapMemory(m_vulkanDevice, stagingDeviceMemory, 0, memoryRequirements.size, 0, reinterpret_cast<void**>(&mappedData));
-    DUCK_DEMO_VULKAN_ASSERT(result);
-    memcpy(mappedData, imageData, static_cast<size_t>(bufferCreateInfo.size));
-    vkUnmapMemory(m_vulkanDevice, stagingDeviceMemory);
+    // same as CreateVulkanDeviceBuffer, the copy happens on the transfer queue and the reads on the graphics one
+    const std::array<uint32_t, 2> queueFamilyIndices = { m_vulkanGraphicsQueueIndex, m_vulkanTransferQueueIndex };
+    const bool concurrent = m_vulkanTransferQueueIndex != m_vulkanGraphicsQueueIndex;
 
     VkImageCreateInfo imageCreateInfo;
     imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -1235,48 +2035,156 @@ VkResult Game::CreateVulkanTexture(const std::string path, VulkanTexture& outVul
     imageCreateInfo.flags = 0;
     imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
     imageCreateInfo.format = format;
-    imageCreateInfo.extent = { static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1 };
-    imageCreateInfo.mipLevels = 1;
+    imageCreateInfo.extent = { width, height, 1 };
+    imageCreateInfo.mipLevels = mipLevelCount;
     imageCreateInfo.arrayLayers = 1;
     imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-    imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    imageCreateInfo.queueFamilyIndexCount = 0;
-    imageCreateInfo.pQueueFamilyIndices = nullptr;
+    imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageCreateInfo.sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+    imageCreateInfo.queueFamilyIndexCount = concurrent ? static_cast<uint32_t>(queueFamilyIndices.size()) : 0;
+    imageCreateInfo.pQueueFamilyIndices = concurrent ? queueFamilyIndices.data() : nullptr;
     imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    DUCK_DEMO_VULKAN_ASSERT(vkCreateImage(m_vulkanDevice, &imageCreateInfo, s_allocator, &outVulkanTexture.m_image));
-    
-    vkGetImageMemoryRequirements(m_vulkanDevice, outVulkanTexture.m_image, &memoryRequirements);
-    memoryAllocateInfo.allocationSize = memoryRequirements.size;
-    memoryAllocateInfo.memoryTypeIndex = FindMemoryByFlagAndType(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memoryRequirements.memoryTypeBits);
 
-    DUCK_DEMO_VULKAN_ASSERT(vkAllocateMemory(m_vulkanDevice, &memoryAllocateInfo, s_allocator, &outVulkanTexture.m_deviceMemory));
-    DUCK_DEMO_VULKAN_ASSERT(vkBindImageMemory(m_vulkanDevice, outVulkanTexture.m_image, outVulkanTexture.m_deviceMemory, 0));
+    VkResult result = vkCreateImage(m_vulkanDevice, &imageCreateInfo, s_allocator, &OutVulkanTexture.m_image);
+    DUCK_DEMO_VULKAN_ASSERT(result);
+    if (result != VK_SUCCESS)
+    {
+        return result;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(m_vulkanDevice, OutVulkanTexture.m_image, &memoryRequirements);
 
-    TransferFromStagingBufferToImage(stagingBuffer, outVulkanTexture.m_image, imageCreateInfo.mipLevels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    const uint32_t memoryTypeIndex = FindMemoryType_VulkanMemoryAllocator(m_vulkanMemoryAllocator, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (memoryTypeIndex == c_vulkanMemoryInvalidIndex)
+    {
+        DUCK_DEMO_SHOW_ERROR("Critical Vulkan Error", "Could not find device local memory for a texture");
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+
+    result = Allocate_VulkanMemoryAllocator(m_vulkanMemoryAllocator, memoryRequirements, memoryTypeIndex, VulkanMemoryTiling_Optimal, OutVulkanTexture.m_allocation);
+    DUCK_DEMO_VULKAN_ASSERT(result);
+    if (result != VK_SUCCESS)
+    {
+        return result;
+    }
 
-    vkFreeMemory(m_vulkanDevice, stagingDeviceMemory, s_allocator);
-    vkDestroyBuffer(m_vulkanDevice, stagingBuffer, s_allocator);
+    result = vkBindImageMemory(m_vulkanDevice, OutVulkanTexture.m_image, OutVulkanTexture.m_allocation.m_deviceMemory, OutVulkanTexture.m_allocation.m_offset);
+    DUCK_DEMO_VULKAN_ASSERT(result);
+    if (result != VK_SUCCESS)
+    {
+        return result;
+    }
 
     VkImageViewCreateInfo imageViewCreateInfo;
     imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     imageViewCreateInfo.pNext = nullptr;
     imageViewCreateInfo.flags = 0;
-    imageViewCreateInfo.image = outVulkanTexture.m_image;
+    imageViewCreateInfo.image = OutVulkanTexture.m_image;
     imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
     imageViewCreateInfo.format = format;
     imageViewCreateInfo.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
     imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
-    imageViewCreateInfo.subresourceRange.levelCount = 1;
+    imageViewCreateInfo.subresourceRange.levelCount = imageCreateInfo.mipLevels;
     imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
-    imageViewCreateInfo.subresourceRange.layerCount = imageCreateInfo.mipLevels;
-    DUCK_DEMO_VULKAN_ASSERT(vkCreateImageView(m_vulkanDevice, &imageViewCreateInfo, s_allocator, &outVulkanTexture.m_imageView));
+    imageViewCreateInfo.subresourceRange.layerCount = 1;
+
+    result = vkCreateImageView(m_vulkanDevice, &imageViewCreateInfo, s_allocator, &OutVulkanTexture.m_imageView);
+    DUCK_DEMO_VULKAN_ASSERT(result);
+    if (result != VK_SUCCESS)
+    {
+        return result;
+    }
+
+    OutVulkanTexture.m_width = width;
+    OutVulkanTexture.m_height = height;
+    OutVulkanTexture.m_mipLevelCount = mipLevelCount;
 
     return VK_SUCCESS;
 }
 
+void Game::RecordVulkanTextureMipBlit(VkCommandBuffer commandBuffer, const VulkanTexture& vulkanTexture, const uint32_t firstLevel) const
+{
+    DUCK_DEMO_ASSERT(m_vulkanTextureMipBlit);
+    DUCK_DEMO_ASSERT(firstLevel >= 1);
+    if (firstLevel >= vulkanTexture.m_mipLevelCount)
+    {
+        return;
+    }
+
+    const uint32_t blitLevelCount = vulkanTexture.m_mipLevelCount - firstLevel;
+
+    // the last uploaded level is the source of the first blit, everything below it has never been written
+    std::array<VkImageMemoryBarrier, 2> imageMemoryBarriers;
+    for (VkImageMemoryBarrier& imageMemoryBarrier : imageMemoryBarriers)
+    {
+        imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageMemoryBarrier.pNext = nullptr;
+        imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageMemoryBarrier.image = vulkanTexture.m_image;
+        imageMemoryBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageMemoryBarrier.subresourceRange.baseArrayLayer = 0;
+        imageMemoryBarrier.subresourceRange.layerCount = 1;
+    }
+    imageMemoryBarriers[0].srcAccessMask = 0;
+    imageMemoryBarriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    imageMemoryBarriers[0].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageMemoryBarriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    imageMemoryBarriers[0].subresourceRange.baseMipLevel = firstLevel - 1;
+    imageMemoryBarriers[0].subresourceRange.levelCount = 1;
+    imageMemoryBarriers[1].srcAccessMask = 0;
+    imageMemoryBarriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageMemoryBarriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageMemoryBarriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageMemoryBarriers[1].subresourceRange.baseMipLevel = firstLevel;
+    imageMemoryBarriers[1].subresourceRange.levelCount = blitLevelCount;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(imageMemoryBarriers.size()), imageMemoryBarriers.data());
+
+    VkImageMemoryBarrier& levelBarrier = imageMemoryBarriers[1];
+    levelBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    levelBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    levelBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    levelBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    levelBarrier.subresourceRange.levelCount = 1;
+
+    for (uint32_t level = firstLevel; level < vulkanTexture.m_mipLevelCount; ++level)
+    {
+        VkImageBlit imageBlit;
+        imageBlit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageBlit.srcSubresource.mipLevel = level - 1;
+        imageBlit.srcSubresource.baseArrayLayer = 0;
+        imageBlit.srcSubresource.layerCount = 1;
+        imageBlit.srcOffsets[0] = { 0, 0, 0 };
+        imageBlit.srcOffsets[1].x = static_cast<int32_t>(GetLevelSize_MipChain(vulkanTexture.m_width, level - 1));
+        imageBlit.srcOffsets[1].y = static_cast<int32_t>(GetLevelSize_MipChain(vulkanTexture.m_height, level - 1));
+        imageBlit.srcOffsets[1].z = 1;
+        imageBlit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageBlit.dstSubresource.mipLevel = level;
+        imageBlit.dstSubresource.baseArrayLayer = 0;
+        imageBlit.dstSubresource.layerCount = 1;
+        imageBlit.dstOffsets[0] = { 0, 0, 0 };
+        imageBlit.dstOffsets[1].x = static_cast<int32_t>(GetLevelSize_MipChain(vulkanTexture.m_width, level));
+        imageBlit.dstOffsets[1].y = static_cast<int32_t>(GetLevelSize_MipChain(vulkanTexture.m_height, level));
+        imageBlit.dstOffsets[1].z = 1;
+        vkCmdBlitImage(commandBuffer, vulkanTexture.m_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vulkanTexture.m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit, VK_FILTER_LINEAR);
+
+        // each level is the source of the next one
+        levelBarrier.subresourceRange.baseMipLevel = level;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &levelBarrier);
+    }
+
+    levelBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    levelBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    levelBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    levelBarrier.subresourceRange.baseMipLevel = firstLevel - 1;
+    levelBarrier.subresourceRange.levelCount = blitLevelCount + 1;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &levelBarrier);
+}
+
 void Game::TransferFromStagingBufferToImage(VkBuffer stagingBuffer, VkImage dstImage, const uint32_t mipLevels, const uint32_t width, const uint32_t height) const
 {
     DUCK_DEMO_VULKAN_ASSERT(vkResetCommandPool(m_vulkanDevice, m_vulkanTempCommandPool, 0));
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
+#include <utility>
 #include <cinttypes>
 
 #include <SDL.h>
@@ -10,10 +14,33 @@
 #include "shaderc/shaderc.h" 
 
 #include "GameTimer.h"
+#include "GpuProfiler.h"
 #include "ImGuiRenderPass.h"
+#include "TextureLoader.h"
+#include "UniformRingBuffer.h"
+#include "UploadManager.h"
 #include "VulkanBuffer.h"
+#include "VulkanMemoryAllocator.h"
 #include "VulkanTexture.h"
 
+constexpr uint32_t c_maxFramesInFlight = 3u;
+
+// name and value of every #define a shader is compiled with, an empty value just defines the name
+using ShaderMacros = std::vector<std::pair<std::string, std::string>>;
+
+// everything the cpu needs to record and submit one frame while the gpu may still be working on the others
+struct GameFrame
+{
+    VkCommandPool m_vulkanCommandPool = VK_NULL_HANDLE;
+    VkCommandBuffer m_vulkanCommandBuffer = VK_NULL_HANDLE;
+    VkSemaphore m_vulkanAquireSwapchain = VK_NULL_HANDLE;
+    VkSemaphore m_vulkanReleaseSwapchain = VK_NULL_HANDLE;
+    VkFence m_vulkanSubmitFence = VK_NULL_HANDLE;
+    // 0 when nothing is in flight, otherwise the GameTimer frame count this frame was submitted with
+    uint64_t m_frameNumber = 0;
+    double m_cpuTime = 0.0;
+};
+
 class Game
 {
 public:
@@ -24,15 +51,38 @@ public:
 
     int Run(int argc, char** argv);
 
-    VkResult CompileShaderFromDisk(const std::string& path, const shaderc_shader_kind shaderKind, VkShaderModule* OutShaderModule, const shaderc_compile_options_t compileOptions = nullptr);
+    // LoadShader and both pipeline helpers can be called from several threads at once
+    // looks the permutation up in the spir-v embedded at build time with DUCK_DEMO_PRECOMPILED_SHADERS, otherwise compiles it
+    VkResult LoadShader(const std::string& path, const shaderc_shader_kind shaderKind, VkShaderModule* OutShaderModule, const ShaderMacros& shaderMacros = ShaderMacros());
+#ifndef DUCK_DEMO_PRECOMPILED_SHADERS
+    // spir-v is cached on disk keyed by the source, macros, shader kind and shaderc version, shaderc only runs on a miss
+    VkResult CompileShaderFromDisk(const std::string& path, const shaderc_shader_kind shaderKind, VkShaderModule* OutShaderModule, const ShaderMacros& shaderMacros = ShaderMacros());
+#endif // DUCK_DEMO_PRECOMPILED_SHADERS
+    // both go through the pipeline cache that is loaded at startup and saved on shutdown
+    VkResult CreateVulkanGraphicsPipeline(const VkGraphicsPipelineCreateInfo& graphicsPipelineCreateInfo, VkPipeline* OutPipeline);
+    VkResult CreateVulkanComputePipeline(const VkComputePipelineCreateInfo& computePipelineCreateInfo, VkPipeline* OutPipeline);
     VkResult CreateVulkanBuffer(const VkDeviceSize deviceSize, const VkBufferUsageFlagBits bufferUsageFlagBits, VulkanBuffer& OutVulkanBuffer);
+    // device local and filled through the upload manager, anything submitted from the next EndRender on sees the data
+    VkResult CreateVulkanDeviceBuffer(const VkDeviceSize deviceSize, const VkBufferUsageFlags bufferUsageFlags, const void* data, VulkanBuffer& OutVulkanBuffer);
     void FillVulkanBuffer(VulkanBuffer& vulkanBuffer, const void* data, const std::size_t dataSize, const VkDeviceSize offset = 0);
     void ZeroVulkanBuffer(VulkanBuffer& vulkanBuffer);
     VkDeviceSize CalculateUniformBufferSize(const std::size_t size) const;
     // this will take the size and make sure it will align with uniform buffer alightment rules of the gpu
-    VkResult CreateVulkanTexture(const std::string path, VulkanTexture& outVulkanTexture);
     int32_t FindMemoryByFlagAndType(const VkMemoryPropertyFlagBits memoryFlagBits, const uint32_t memoryTypeBits) const;
+    // rgba8 srgb pixels uploaded through the upload manager, the texture always gets a full mip chain and pixels holds the
+    // first pixelLevelCount levels of it. if the rest can be blitted it's left for RecordVulkanTextureMipBlit, otherwise
+    // it's filtered on the cpu here. the uploaded levels can be sampled once OutUploadValue completes
+    VkResult CreateVulkanDeviceTexture(const uint32_t width, const uint32_t height, const void* pixels, const uint32_t pixelLevelCount, VulkanTexture& OutVulkanTexture, uint64_t* OutUploadValue = nullptr);
+    // blocks holds every level one after another, the texture can be sampled once OutUploadValue completes
+    VkResult CreateVulkanCompressedTexture(const VkFormat format, const uint32_t width, const uint32_t height, const uint32_t levelCount, const uint32_t blockSize, const void* blocks, VulkanTexture& OutVulkanTexture, uint64_t* OutUploadValue = nullptr);
+    // blits the levels after firstLevel - 1 from the one above them, the recorded commands have to run before anything samples the texture
+    void RecordVulkanTextureMipBlit(VkCommandBuffer commandBuffer, const VulkanTexture& vulkanTexture, const uint32_t firstLevel) const;
+    // false if the texture format can't be linearly blitted, mip chains have to come from Generate_MipChain then
+    bool CanBlitVulkanTextureMips() const { return m_vulkanTextureMipBlit; }
+    bool IsTextureCompressionBCSupported() const { return m_vulkanTextureCompressionBC; }
     void TransferFromStagingBufferToImage(VkBuffer stagingBuffer, VkImage dstImage, const uint32_t mipLevels, const uint32_t width, const uint32_t height) const;
+    // the next EndRender submit will wait on this semaphore at the given stage, only valid between BeginRender and EndRender
+    void AddRenderWaitSemaphore(VkSemaphore semaphore, const VkPipelineStageFlags waitStageFlags);
 
     SDL_Window* GetWindow() const { return m_window; }
     VkDevice GetVulkanDevice() const { return m_vulkanDevice; }
@@ -42,13 +92,29 @@ public:
     const std::vector<VkImageView>& GetVulkanSwapchainImageViews() const { return m_vulkanSwapchainImageViews; }
     VkInstance GetVulkanInstance() const { return m_instance; }
     VkFormat GetVulkanSwapchainPixelFormat() const { return m_vulkanSwapchainPixelFormat; }
+    // the layout the last pass leaves the swapchain image in, headless has nothing to present so it stays in general
+    VkImageLayout GetVulkanSwapchainFinalLayout() const { return m_headless ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; }
     VkPhysicalDevice GetVulkanPhysicalDevice() const { return m_vulkanPhysicalDevice; }
     uint32_t GetVulkanGraphicsQueueIndex() const { return m_vulkanGraphicsQueueIndex; }
     uint32_t GetVulkanComputeQueueIndex() const { return m_vulkanComputeQueueIndex; }
+    uint32_t GetVulkanTransferQueueIndex() const { return m_vulkanTransferQueueIndex; }
     VkQueue GetVulkanQueue() const { return m_vulkanQueue; }
     uint32_t GetCurrentSwapchainImageIndex() const { return m_currentSwapchainImageIndex; }
+    VkPipelineCache GetVulkanPipelineCache() const { return m_vulkanPipelineCache; }
     VkImageView GetVulkanDepthStencilImageView() const { return m_vulkanDepthStencilImageView; }
     VkClearValue GetVulkanClearValue() const { return m_vulkanClearValue; }
+    uint32_t GetFramesInFlightCount() const { return m_framesInFlightCount; }
+    uint32_t GetCurrentFrameIndex() const { return m_currentFrameIndex; }
+    bool IsHeadless() const { return m_headless; }
+    // false with --serial-init so startup can be timed both ways
+    bool IsParallelInitEnabled() const { return m_parallelInit; }
+    // true with --baked-waves, the water plays back a loop baked at startup instead of running the waves every frame
+    bool IsBakedWavesEnabled() const { return m_bakedWaves; }
+    GpuProfiler& GetGpuProfiler() { return m_gpuProfiler; }
+    VulkanMemoryAllocator& GetVulkanMemoryAllocator() { return m_vulkanMemoryAllocator; }
+    UniformRingBuffer& GetUniformRingBuffer() { return m_uniformRingBuffer; }
+    UploadManager& GetUploadManager() { return m_uploadManager; }
+    TextureLoader& GetTextureLoader() { return m_textureLoader; }
 
     void QuitGame();
 
@@ -59,10 +125,15 @@ protected:
     virtual void OnResize() = 0;
     virtual void OnUpdate(const GameTimer& gameTimer) = 0;
     virtual void OnRender() = 0;
+    // called once the gpu is done with a frame, times are in seconds and gpuTime is negative if the queue can't do timestamps
+    virtual void OnFrameRetired(const uint64_t /*frameNumber*/, const double /*cpuTime*/, const double /*gpuTime*/) {}
+
+    void SetFixedDeltaTime(const double fixedDeltaTime) { m_gameTimer.SetFixedDeltaTime(fixedDeltaTime); }
 
     VkDevice m_vulkanDevice = VK_NULL_HANDLE;
     VkFormat m_vulkanSwapchainPixelFormat = VK_FORMAT_UNDEFINED;
     VkClearValue m_vulkanClearValue;
+    // command buffer of the frame currently being recorded, only valid between BeginRender and EndRender
     VkCommandBuffer m_vulkanPrimaryCommandBuffer = VK_NULL_HANDLE;
     uint32_t m_vulkanSwapchainWidth = 0;
     uint32_t m_vulkanSwapchainHeight = 0;
@@ -74,39 +145,94 @@ protected:
     VkFence m_vulkanTempFence = VK_NULL_HANDLE;
     VkPhysicalDevice m_vulkanPhysicalDevice = VK_NULL_HANDLE;
     ImGuiRenderPass m_imGuiRenderPass;
+    GpuProfiler m_gpuProfiler;
+    VulkanMemoryAllocator m_vulkanMemoryAllocator;
+    // reset every frame, anything pushed into it is only valid for the frame being recorded
+    UniformRingBuffer m_uniformRingBuffer;
+    UploadManager m_uploadManager;
+    TextureLoader m_textureLoader;
 
 private:
     bool InitWindow();
     bool InitVulkanInstance();
     bool InitVulkanDevice();
     bool InitVulkanSwapChain(const int32_t width, const int32_t height);
+    // headless stand-in for the swapchain, the passes only ever see the image views so they don't need to know
+    bool InitVulkanOffscreenImages(const int32_t width, const int32_t height);
+    void FreeVulkanOffscreenImages();
     bool InitVulkanGameResources();
+    bool InitVulkanPipelineCache();
+    void SaveVulkanPipelineCache();
     bool InitVulkanDepthStencilImage();
     void FreeVulkanDepthStencilImage();
+    // device local image and view with room for every level, nothing is uploaded to it
+    VkResult CreateVulkanTextureImage(const VkFormat format, const uint32_t width, const uint32_t height, const uint32_t mipLevelCount, VulkanTexture& OutVulkanTexture);
 
     void Update();
     void Resize(int32_t width = -1, int32_t height = -1);
+    void WaitForCurrentFrame();
+    void RetireFrame(GameFrame& frame);
     bool BeginRender();
     void EndRender();
 
     bool m_quit = false;
     GameTimer m_gameTimer;
 
+    uint64_t m_cpuTraceFrameCount = 0;
+    bool m_cpuTraceRequested = false;
+
+    bool m_headless = false;
+    uint32_t m_headlessFrameCount = 0;
+    int32_t m_headlessWidth = 1280;
+    int32_t m_headlessHeight = 720;
+    std::vector<VkImage> m_vulkanOffscreenImages;
+    std::vector<VulkanAllocation> m_vulkanOffscreenImageAllocations;
+
     SDL_Window* m_window = nullptr;
     VkInstance m_instance = VK_NULL_HANDLE;
     VkSurfaceKHR m_vulkanSurface = VK_NULL_HANDLE;
     uint32_t m_vulkanGraphicsQueueIndex = 0;
     uint32_t m_vulkanComputeQueueIndex = 0;
+    // same as the graphics family when the device has no transfer only family
+    uint32_t m_vulkanTransferQueueIndex = 0;
     VkQueue m_vulkanQueue = VK_NULL_HANDLE;
+    VkQueue m_vulkanTransferQueue = VK_NULL_HANDLE;
     VkSwapchainKHR m_vulkanSwapchain = VK_NULL_HANDLE;
-    VkSemaphore m_vulkanAquireSwapchain = VK_NULL_HANDLE;
-    VkSemaphore m_vulkanReleaseSwapchain = VK_NULL_HANDLE;
-    VkCommandPool m_vulkanPrimaryCommandPool = VK_NULL_HANDLE;
-    VkFence m_vulkanSubmitFence = VK_NULL_HANDLE;
-    shaderc_compiler_t m_shaderCompiler = nullptr;
+    std::array<GameFrame, c_maxFramesInFlight> m_frames;
+    uint32_t m_framesInFlightCount = 2;
+    uint32_t m_currentFrameIndex = 0;
+    std::chrono::high_resolution_clock::time_point m_frameCpuStartTime;
+    std::vector<VkSemaphore> m_renderWaitSemaphores;
+    std::vector<VkPipelineStageFlags> m_renderWaitStageFlags;
+#ifndef DUCK_DEMO_PRECOMPILED_SHADERS
+    // guards the compilers and the counts below
+    std::mutex m_shaderCompilerMutex;
+    // idle compilers, a compiler can't be shared between threads so each compile takes one out and puts it back after,
+    // new ones are only made when every existing one is busy on another thread
+    std::vector<shaderc_compiler_t> m_shaderCompilers;
+    bool m_shaderCacheEnabled = true;
+    uint32_t m_shaderCacheHitCount = 0;
+    uint32_t m_shaderCacheMissCount = 0;
+    // summed over threads so it can be more than the time startup actually took
+    double m_shaderCompileTime = 0.0;
+#endif // DUCK_DEMO_PRECOMPILED_SHADERS
+    VkPipelineCache m_vulkanPipelineCache = VK_NULL_HANDLE;
+    bool m_pipelineCacheEnabled = true;
+    // true if the cache started out with data from a previous run
+    bool m_pipelineCacheWarm = false;
+    // guards the counts below, creating pipelines with the cache needs no lock in vulkan 1.0, only reading
+    // its data or destroying it does and that only happens once every init thread is done
+    std::mutex m_pipelineStatsMutex;
+    uint32_t m_pipelineCreateCount = 0;
+    // summed over threads like m_shaderCompileTime
+    double m_pipelineCreateTime = 0.0;
+    bool m_parallelInit = true;
+    bool m_bakedWaves = false;
     VkImage m_vulkanDepthStencilImage = VK_NULL_HANDLE;
-    VkDeviceMemory m_vulkanDepthStencilImageMemory = VK_NULL_HANDLE;
+    VulkanAllocation m_vulkanDepthStencilImageAllocation;
     VkDeviceSize m_minUniformBufferOffsetAlignment = 0;
+    bool m_vulkanTextureMipBlit = false;
+    bool m_vulkanTextureCompressionBC = false;
     uint32_t m_vulkanSwapChainImageCount = 0;
 
 #ifdef DUCK_DEMO_VULKAN_DEBUG
@@ -20,6 +20,8 @@ GameTimer::GameTimer()
     , mPrevTime(0)
     , mCurrTime(0)
     , m_frameCount(0)
+    , m_fixedDeltaTime(0.0)
+    , m_fixedTotalTime(0.0)
 {
 }
 
@@ -29,6 +31,11 @@ GameTimer::~GameTimer()
 
 double GameTimer::TotalTime() const
 { 
+    if (m_fixedDeltaTime > 0.0)
+    {
+        return m_fixedTotalTime;
+    }
+
     if (mStopped)
     {
         return static_cast<double>(((mStopTime - mPausedTime) - mBaseTime) * mMilliToSec);
@@ -47,6 +54,7 @@ void GameTimer::Reset()
     mPrevTime = currentTime;
     mStopTime = 0;
     mStopped = false;
+    m_fixedTotalTime = 0.0;
 }
 
 void GameTimer::Start()
@@ -82,6 +90,14 @@ void GameTimer::Tick()
         return;
     }
 
+    if (m_fixedDeltaTime > 0.0)
+    {
+        mDeltaTime = m_fixedDeltaTime;
+        m_fixedTotalTime += m_fixedDeltaTime;
+        m_frameCount++;
+        return;
+    }
+
     TimePoint currentTime = GameTimerUtil::GetCurrentTime();
     mCurrTime = currentTime;
 
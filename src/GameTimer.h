@@ -12,6 +12,9 @@ public:
 	double DeltaTime() const { return mDeltaTime; }
 	uint64_t FrameCount() const { return m_frameCount; }
 
+	// when set above zero every Tick advances by exactly this many seconds instead of the wall clock, used for repeatable runs
+	void SetFixedDeltaTime(const double fixedDeltaTime) { m_fixedDeltaTime = fixedDeltaTime; }
+
 	void Reset();
 	void Start();
 	void Stop();
@@ -29,4 +32,6 @@ private:
 	TimePoint mPrevTime;
 	TimePoint mCurrTime;
 	uint64_t m_frameCount;
+	double m_fixedDeltaTime;
+	double m_fixedTotalTime;
 };
@@ -0,0 +1,260 @@
+#include "GpuProfiler.h"
+
+#include <cstdio>
+
+#include "imgui.h"
+
+#include "DuckDemoUtils.h"
+#include "Game.h"
+
+constexpr size_t c_gpuProfilerHistoryCount = 1024;
+constexpr double c_gpuProfilerSmoothing = 0.05;
+
+static const std::array<const char*, GpuProfilerScope_COUNT> s_gpuProfilerScopeNames =
+{
+    "Frame",
+    "WaterCompute",
+    "MeshRender",
+    "WaterRender",
+    "ImGui",
+};
+
+static uint64_t GetTimestampMask(const uint32_t timestampValidBits)
+{
+    if (timestampValidBits == 0)
+    {
+        return 0;
+    }
+
+    return timestampValidBits >= 64 ? ~0ull : (1ull << timestampValidBits) - 1ull;
+}
+
+static uint64_t GetScopeTimestampMask(const GpuProfiler& gpuProfiler, const GpuProfilerScope scope)
+{
+    return scope == GpuProfilerScope_WaterCompute ? gpuProfiler.m_computeTimestampMask : gpuProfiler.m_graphicsTimestampMask;
+}
+
+static uint32_t GetScopeQuery(const GpuProfiler& gpuProfiler, const uint32_t frameIndex, const GpuProfilerScope scope)
+{
+    DUCK_DEMO_ASSERT(frameIndex < gpuProfiler.m_frameCount);
+    return (frameIndex * GpuProfilerScope_COUNT + scope) * 2;
+}
+
+bool Init_GpuProfiler(GpuProfiler& gpuProfiler, const uint32_t frameCount)
+{
+    VkPhysicalDevice physicalDevice = Game::Get()->GetVulkanPhysicalDevice();
+
+    uint32_t queueFamilyPropertyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertyCount, nullptr);
+
+    std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyPropertyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyPropertyCount, queueFamilyProperties.data());
+
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+
+    gpuProfiler.m_frameCount = frameCount;
+    gpuProfiler.m_timestampPeriod = physicalDeviceProperties.limits.timestampPeriod;
+    gpuProfiler.m_graphicsTimestampMask = GetTimestampMask(queueFamilyProperties[Game::Get()->GetVulkanGraphicsQueueIndex()].timestampValidBits);
+    gpuProfiler.m_computeTimestampMask = GetTimestampMask(queueFamilyProperties[Game::Get()->GetVulkanComputeQueueIndex()].timestampValidBits);
+
+    gpuProfiler.m_writtenScopes.resize(frameCount);
+    for (std::array<bool, GpuProfilerScope_COUNT>& writtenScopes : gpuProfiler.m_writtenScopes)
+    {
+        writtenScopes.fill(false);
+    }
+    gpuProfiler.m_lastTimes.fill(-1.0);
+    gpuProfiler.m_smoothedTimes.fill(-1.0);
+    gpuProfiler.m_history.reserve(c_gpuProfilerHistoryCount);
+    gpuProfiler.m_historyHead = 0;
+
+    if (gpuProfiler.m_graphicsTimestampMask == 0 && gpuProfiler.m_computeTimestampMask == 0)
+    {
+        // nothing to measure but the rest of the game doesn't care, every scope just stays empty
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "GpuProfiler: neither the graphics nor the compute queue supports timestamps");
+        return true;
+    }
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo;
+    queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolCreateInfo.pNext = nullptr;
+    queryPoolCreateInfo.flags = 0;
+    queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolCreateInfo.queryCount = frameCount * GpuProfilerScope_COUNT * 2;
+    queryPoolCreateInfo.pipelineStatistics = 0;
+
+    VkResult result = vkCreateQueryPool(Game::Get()->GetVulkanDevice(), &queryPoolCreateInfo, s_allocator, &gpuProfiler.m_queryPool);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    return true;
+}
+
+void Free_GpuProfiler(GpuProfiler& gpuProfiler)
+{
+    if (gpuProfiler.m_queryPool)
+    {
+        vkDestroyQueryPool(Game::Get()->GetVulkanDevice(), gpuProfiler.m_queryPool, s_allocator);
+        gpuProfiler.m_queryPool = VK_NULL_HANDLE;
+    }
+}
+
+void BeginScope_GpuProfiler(GpuProfiler& gpuProfiler, VkCommandBuffer commandBuffer, const uint32_t frameIndex, const GpuProfilerScope scope)
+{
+    if (gpuProfiler.m_queryPool == VK_NULL_HANDLE || GetScopeTimestampMask(gpuProfiler, scope) == 0)
+    {
+        return;
+    }
+
+    const uint32_t query = GetScopeQuery(gpuProfiler, frameIndex, scope);
+    vkCmdResetQueryPool(commandBuffer, gpuProfiler.m_queryPool, query, 2);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, gpuProfiler.m_queryPool, query);
+}
+
+void EndScope_GpuProfiler(GpuProfiler& gpuProfiler, VkCommandBuffer commandBuffer, const uint32_t frameIndex, const GpuProfilerScope scope)
+{
+    if (gpuProfiler.m_queryPool == VK_NULL_HANDLE || GetScopeTimestampMask(gpuProfiler, scope) == 0)
+    {
+        return;
+    }
+
+    const uint32_t query = GetScopeQuery(gpuProfiler, frameIndex, scope);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, gpuProfiler.m_queryPool, query + 1);
+
+    gpuProfiler.m_writtenScopes[frameIndex][scope] = true;
+}
+
+GpuProfilerSample Resolve_GpuProfiler(GpuProfiler& gpuProfiler, const uint32_t frameIndex, const uint64_t frameNumber)
+{
+    GpuProfilerSample sample;
+    sample.m_frameNumber = frameNumber;
+    sample.m_times.fill(-1.0);
+
+    for (uint32_t i = 0; i < GpuProfilerScope_COUNT; ++i)
+    {
+        const GpuProfilerScope scope = static_cast<GpuProfilerScope>(i);
+        if (!gpuProfiler.m_writtenScopes[frameIndex][scope])
+        {
+            continue;
+        }
+        gpuProfiler.m_writtenScopes[frameIndex][scope] = false;
+
+        std::array<uint64_t, 2> timestamps;
+        const VkResult result = vkGetQueryPoolResults(
+            Game::Get()->GetVulkanDevice(),
+            gpuProfiler.m_queryPool,
+            GetScopeQuery(gpuProfiler, frameIndex, scope),
+            static_cast<uint32_t>(timestamps.size()),
+            sizeof(timestamps),
+            timestamps.data(),
+            sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT);
+
+        // VK_NOT_READY would mean the caller didn't wait on the frame, drop it rather than stall
+        if (result != VK_SUCCESS)
+        {
+            continue;
+        }
+
+        // the bits above timestampValidBits are undefined and the counter is allowed to wrap inside the valid range
+        const uint64_t mask = GetScopeTimestampMask(gpuProfiler, scope);
+        const uint64_t ticks = ((timestamps[1] & mask) - (timestamps[0] & mask)) & mask;
+        const double time = static_cast<double>(ticks) * gpuProfiler.m_timestampPeriod * 1e-6;
+
+        sample.m_times[scope] = time;
+        gpuProfiler.m_lastTimes[scope] = time;
+
+        double& smoothedTime = gpuProfiler.m_smoothedTimes[scope];
+        smoothedTime = smoothedTime < 0.0 ? time : smoothedTime + (time - smoothedTime) * c_gpuProfilerSmoothing;
+    }
+
+    if (gpuProfiler.m_history.size() < c_gpuProfilerHistoryCount)
+    {
+        gpuProfiler.m_history.push_back(sample);
+    }
+    else
+    {
+        gpuProfiler.m_history[gpuProfiler.m_historyHead] = sample;
+        gpuProfiler.m_historyHead = (gpuProfiler.m_historyHead + 1) % c_gpuProfilerHistoryCount;
+    }
+
+    return sample;
+}
+
+const char* GetScopeName_GpuProfiler(const GpuProfilerScope scope)
+{
+    DUCK_DEMO_ASSERT(scope < GpuProfilerScope_COUNT);
+    return s_gpuProfilerScopeNames[scope];
+}
+
+bool ExportCsv_GpuProfiler(const GpuProfiler& gpuProfiler, const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        DUCK_DEMO_SHOW_ERROR("GpuProfiler Error", DuckDemoUtils::format("Failed to open %s for writing", path.c_str()));
+        return false;
+    }
+
+    fprintf(file, "frame");
+    for (const char* scopeName : s_gpuProfilerScopeNames)
+    {
+        fprintf(file, ",%s_ms", scopeName);
+    }
+    fprintf(file, "\n");
+
+    // oldest first, the head is where the next sample would overwrite once the history is full
+    for (size_t i = 0; i < gpuProfiler.m_history.size(); ++i)
+    {
+        const GpuProfilerSample& sample = gpuProfiler.m_history[(gpuProfiler.m_historyHead + i) % gpuProfiler.m_history.size()];
+
+        fprintf(file, "%llu", static_cast<unsigned long long>(sample.m_frameNumber));
+        for (double time : sample.m_times)
+        {
+            if (time >= 0.0)
+            {
+                fprintf(file, ",%.4f", time);
+            }
+            else
+            {
+                fprintf(file, ",");
+            }
+        }
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+
+    SDL_Log("GpuProfiler: wrote %zu frames to %s", gpuProfiler.m_history.size(), path.c_str());
+
+    return true;
+}
+
+void ImGui_GpuProfiler(GpuProfiler& gpuProfiler)
+{
+    if (!ImGui::CollapsingHeader("GPU Profiler", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < GpuProfilerScope_COUNT; ++i)
+    {
+        const GpuProfilerScope scope = static_cast<GpuProfilerScope>(i);
+        if (gpuProfiler.m_smoothedTimes[scope] >= 0.0)
+        {
+            ImGui::Text("%-14s %8.3f ms", GetScopeName_GpuProfiler(scope), gpuProfiler.m_smoothedTimes[scope]);
+        }
+        else
+        {
+            ImGui::Text("%-14s      n/a", GetScopeName_GpuProfiler(scope));
+        }
+    }
+
+    if (ImGui::Button("Export GPU CSV"))
+    {
+        ExportCsv_GpuProfiler(gpuProfiler, "gpu_profile.csv");
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+enum GpuProfilerScope
+{
+    GpuProfilerScope_Frame = 0,
+    GpuProfilerScope_WaterCompute,
+    GpuProfilerScope_MeshRender,
+    GpuProfilerScope_WaterRender,
+    GpuProfilerScope_ImGui,
+    GpuProfilerScope_COUNT,
+};
+
+// times are in milliseconds, negative when the scope wasn't recorded that frame
+struct GpuProfilerSample
+{
+    uint64_t m_frameNumber = 0;
+    std::array<double, GpuProfilerScope_COUNT> m_times;
+};
+
+struct GpuProfiler
+{
+    // a begin and end timestamp per scope per frame in flight
+    VkQueryPool m_queryPool = VK_NULL_HANDLE;
+    uint32_t m_frameCount = 0;
+    float m_timestampPeriod = 0.0f;
+    // the graphics and compute queue can report a different number of valid bits, 0 means that queue can't do timestamps
+    uint64_t m_graphicsTimestampMask = 0;
+    uint64_t m_computeTimestampMask = 0;
+    std::vector<std::array<bool, GpuProfilerScope_COUNT>> m_writtenScopes;
+    std::array<double, GpuProfilerScope_COUNT> m_lastTimes;
+    std::array<double, GpuProfilerScope_COUNT> m_smoothedTimes;
+    std::vector<GpuProfilerSample> m_history;
+    size_t m_historyHead = 0;
+};
+
+bool Init_GpuProfiler(GpuProfiler& gpuProfiler, const uint32_t frameCount);
+void Free_GpuProfiler(GpuProfiler& gpuProfiler);
+
+// both have to be recorded outside of a render pass, GpuProfilerScope_WaterCompute goes on the compute queue and everything else on graphics
+void BeginScope_GpuProfiler(GpuProfiler& gpuProfiler, VkCommandBuffer commandBuffer, const uint32_t frameIndex, const GpuProfilerScope scope);
+void EndScope_GpuProfiler(GpuProfiler& gpuProfiler, VkCommandBuffer commandBuffer, const uint32_t frameIndex, const GpuProfilerScope scope);
+// only call once the frame's fence has signaled, it never waits on the gpu
+GpuProfilerSample Resolve_GpuProfiler(GpuProfiler& gpuProfiler, const uint32_t frameIndex, const uint64_t frameNumber);
+
+const char* GetScopeName_GpuProfiler(const GpuProfilerScope scope);
+bool ExportCsv_GpuProfiler(const GpuProfiler& gpuProfiler, const std::string& path);
+// draws into whatever imgui window is currently open
+void ImGui_GpuProfiler(GpuProfiler& gpuProfiler);
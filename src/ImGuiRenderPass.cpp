@@ -3,6 +3,8 @@
 #include "imgui_impl_sdl2.h"
 #include "imgui_impl_vulkan.h"
 
+#include <algorithm>
+
 #include <SDL_events.h>
 
 #include "DuckDemoUtils.h"
@@ -51,8 +53,8 @@ bool Init_ImGuiRenderPass(ImGuiRenderPass& imguiRenderPass)
         attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
         attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        attachment.initialLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-        attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        attachment.initialLayout = Game::Get()->GetVulkanSwapchainFinalLayout();
+        attachment.finalLayout = Game::Get()->GetVulkanSwapchainFinalLayout();
         VkAttachmentReference color_attachment = {};
         color_attachment.attachment = 0;
         color_attachment.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
@@ -90,11 +92,12 @@ bool Init_ImGuiRenderPass(ImGuiRenderPass& imguiRenderPass)
     initInfo.Device = Game::Get()->GetVulkanDevice();
     initInfo.QueueFamily = Game::Get()->GetVulkanGraphicsQueueIndex();
     initInfo.Queue = Game::Get()->GetVulkanQueue();
-    initInfo.PipelineCache = VK_NULL_HANDLE;
+    initInfo.PipelineCache = Game::Get()->GetVulkanPipelineCache();
     initInfo.DescriptorPool = imguiRenderPass.m_imguiDescriptorPool;
     initInfo.Subpass = 0;
     initInfo.MinImageCount = Game::Get()->GetVulkanSwapChainImageCount();
-    initInfo.ImageCount = Game::Get()->GetVulkanSwapChainImageCount();
+    // imgui keeps a vertex/index buffer per image, make sure we never overwrite one that a frame in flight still uses
+    initInfo.ImageCount = std::max(Game::Get()->GetVulkanSwapChainImageCount(), Game::Get()->GetFramesInFlightCount());
     initInfo.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
     initInfo.Allocator = s_allocator;
     initInfo.CheckVkResultFn = ImGuiInitAssert;
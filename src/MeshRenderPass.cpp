@@ -3,6 +3,8 @@
 #include "Game.h"
 #include "DuckDemoUtils.h"
 #include "DuckDemoGame.h"
+#include "ShaderSpecialization.h"
+#include "VertexInputState.h"
 
 
 bool InitFrameBuffers(MeshRenderPass& meshRenderPass);
@@ -83,17 +85,19 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
         return false;
     }
 
+    const uint32_t framesInFlightCount = Game::Get()->GetFramesInFlightCount();
+
     std::array<VkDescriptorPoolSize, 5> descriptorPoolSize;
-    descriptorPoolSize[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptorPoolSize[0].descriptorCount = 1;
+    descriptorPoolSize[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    descriptorPoolSize[0].descriptorCount = framesInFlightCount;
     descriptorPoolSize[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    descriptorPoolSize[1].descriptorCount = 1;
+    descriptorPoolSize[1].descriptorCount = framesInFlightCount;
     descriptorPoolSize[2].type = VK_DESCRIPTOR_TYPE_SAMPLER;
-    descriptorPoolSize[2].descriptorCount = 1;
+    descriptorPoolSize[2].descriptorCount = framesInFlightCount;
     descriptorPoolSize[3].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-    descriptorPoolSize[3].descriptorCount = meshRenderPassParams.m_maxRenderObjectCount;
+    descriptorPoolSize[3].descriptorCount = meshRenderPassParams.m_maxRenderObjectCount * framesInFlightCount;
     descriptorPoolSize[4].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-    descriptorPoolSize[4].descriptorCount = 1;
+    descriptorPoolSize[4].descriptorCount = framesInFlightCount;
 
     VkPhysicalDeviceFeatures physicalDeviceFeatures;
     vkGetPhysicalDeviceFeatures(Game::Get()->GetVulkanPhysicalDevice(), &physicalDeviceFeatures);
@@ -125,7 +129,7 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
     samplerCreateInfo.compareEnable = VK_FALSE;
     samplerCreateInfo.compareOp = VK_COMPARE_OP_NEVER;
     samplerCreateInfo.minLod = 0.0f;
-    samplerCreateInfo.maxLod = 0.0f;
+    samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
     samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
     samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
     DUCK_DEMO_VULKAN_ASSERT(vkCreateSampler(Game::Get()->GetVulkanDevice(), &samplerCreateInfo, s_allocator, &meshRenderPass.m_vulkanSampler));
@@ -134,7 +138,7 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
     descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     descriptorPoolCreateInfo.pNext = nullptr;
     descriptorPoolCreateInfo.flags = 0;
-    descriptorPoolCreateInfo.maxSets = static_cast<uint32_t>(descriptorPoolSize.size());
+    descriptorPoolCreateInfo.maxSets = static_cast<uint32_t>(descriptorPoolSize.size()) * framesInFlightCount;
     descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(descriptorPoolSize.size());
     descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSize.data();
 
@@ -145,12 +149,9 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
         return false;
     }
 
-    DUCK_DEMO_VULKAN_ASSERT(Game::Get()->CreateVulkanBuffer(static_cast<VkDeviceSize>(sizeof(FrameBuf)),VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, meshRenderPass.m_vulkanFrameBuffer));
-    DUCK_DEMO_VULKAN_ASSERT(Game::Get()->CreateVulkanBuffer(static_cast<VkDeviceSize>(Game::Get()->CalculateUniformBufferSize(sizeof(ObjectBuf)) * meshRenderPassParams.m_maxRenderObjectCount), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, meshRenderPass.m_vulkanObjectBuffer));
-
     VkDescriptorSetLayoutBinding frameBufDescriptorSetLayoutBindings;
     frameBufDescriptorSetLayoutBindings.binding = 0;
-    frameBufDescriptorSetLayoutBindings.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    frameBufDescriptorSetLayoutBindings.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     frameBufDescriptorSetLayoutBindings.descriptorCount = 1;
     frameBufDescriptorSetLayoutBindings.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
     frameBufDescriptorSetLayoutBindings.pImmutableSamplers = nullptr;
@@ -180,7 +181,7 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
     waterHeightSampledImageDescriptorSetLayoutBindings.binding = 0;
     waterHeightSampledImageDescriptorSetLayoutBindings.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
     waterHeightSampledImageDescriptorSetLayoutBindings.descriptorCount = 1;
-    waterHeightSampledImageDescriptorSetLayoutBindings.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    waterHeightSampledImageDescriptorSetLayoutBindings.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
     waterHeightSampledImageDescriptorSetLayoutBindings.pImmutableSamplers = nullptr;
 
     VkDescriptorSetLayoutCreateInfo frameBufDescriptorSetLayoutCreateInfo;
@@ -253,56 +254,59 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
         return false;
     }
 
-    VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
-    descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    descriptorSetAllocateInfo.pNext = nullptr;
-    descriptorSetAllocateInfo.descriptorPool = meshRenderPass.m_vulkanDescriptorPool;
-    descriptorSetAllocateInfo.descriptorSetCount = static_cast<uint32_t>(meshRenderPass.m_vulkanDescriptorSetLayouts.size());
-    descriptorSetAllocateInfo.pSetLayouts = meshRenderPass.m_vulkanDescriptorSetLayouts.data();
-
-    DUCK_DEMO_VULKAN_ASSERT(vkAllocateDescriptorSets(Game::Get()->GetVulkanDevice(), &descriptorSetAllocateInfo, meshRenderPass.m_vulkanDescriptorSets.data()));
-
-    VkDescriptorBufferInfo frameBufDescriptorBufferInfo;
-    frameBufDescriptorBufferInfo.buffer = meshRenderPass.m_vulkanFrameBuffer.m_buffer;
-    frameBufDescriptorBufferInfo.offset = 0;
-    frameBufDescriptorBufferInfo.range = sizeof(FrameBuf);
-
-    VkDescriptorBufferInfo objectBufDescriptorBufferInfo;
-    objectBufDescriptorBufferInfo.buffer = meshRenderPass.m_vulkanObjectBuffer.m_buffer;
-    objectBufDescriptorBufferInfo.offset = 0;
-    objectBufDescriptorBufferInfo.range = sizeof(ObjectBuf);
-
     VkDescriptorImageInfo samplerDescriptorImageInfo;
     samplerDescriptorImageInfo.sampler = meshRenderPass.m_vulkanSampler;
     samplerDescriptorImageInfo.imageView = nullptr;
     samplerDescriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-    VkWriteDescriptorSet frameBufWriteDescriptorSet;
-    frameBufWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    frameBufWriteDescriptorSet.pNext = nullptr;
-    frameBufWriteDescriptorSet.dstSet = meshRenderPass.m_vulkanDescriptorSets[0];
-    frameBufWriteDescriptorSet.dstBinding = 0;
-    frameBufWriteDescriptorSet.dstArrayElement = 0;
-    frameBufWriteDescriptorSet.descriptorCount = 1;
-    frameBufWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    frameBufWriteDescriptorSet.pBufferInfo = &frameBufDescriptorBufferInfo;
-    frameBufWriteDescriptorSet.pImageInfo = nullptr;
-    frameBufWriteDescriptorSet.pTexelBufferView = nullptr;
-
-    VkWriteDescriptorSet objectBufWriteDescriptorSet;
-    objectBufWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    objectBufWriteDescriptorSet.pNext = nullptr;
-    objectBufWriteDescriptorSet.dstSet = meshRenderPass.m_vulkanDescriptorSets[1];
-    objectBufWriteDescriptorSet.dstBinding = 0;
-    objectBufWriteDescriptorSet.dstArrayElement = 0;
-    objectBufWriteDescriptorSet.descriptorCount = 1;
-    objectBufWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    objectBufWriteDescriptorSet.pBufferInfo = &objectBufDescriptorBufferInfo;
-    objectBufWriteDescriptorSet.pImageInfo = nullptr;
-    objectBufWriteDescriptorSet.pTexelBufferView = nullptr;
-
-    vkUpdateDescriptorSets(Game::Get()->GetVulkanDevice(), 1, &frameBufWriteDescriptorSet, 0, nullptr);
-    vkUpdateDescriptorSets(Game::Get()->GetVulkanDevice(), 1, &objectBufWriteDescriptorSet, 0, nullptr);
+    for (uint32_t frameIndex = 0; frameIndex < framesInFlightCount; ++frameIndex)
+    {
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext = nullptr;
+        descriptorSetAllocateInfo.descriptorPool = meshRenderPass.m_vulkanDescriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = static_cast<uint32_t>(meshRenderPass.m_vulkanDescriptorSetLayouts.size());
+        descriptorSetAllocateInfo.pSetLayouts = meshRenderPass.m_vulkanDescriptorSetLayouts.data();
+
+        DUCK_DEMO_VULKAN_ASSERT(vkAllocateDescriptorSets(Game::Get()->GetVulkanDevice(), &descriptorSetAllocateInfo, meshRenderPass.m_vulkanDescriptorSets[frameIndex].data()));
+
+        VkDescriptorBufferInfo frameBufDescriptorBufferInfo;
+        frameBufDescriptorBufferInfo.buffer = Game::Get()->GetUniformRingBuffer().m_buffer;
+        frameBufDescriptorBufferInfo.offset = 0;
+        frameBufDescriptorBufferInfo.range = sizeof(FrameBuf);
+
+        VkDescriptorBufferInfo objectBufDescriptorBufferInfo;
+        objectBufDescriptorBufferInfo.buffer = Game::Get()->GetUniformRingBuffer().m_buffer;
+        objectBufDescriptorBufferInfo.offset = 0;
+        objectBufDescriptorBufferInfo.range = sizeof(ObjectBuf);
+
+        VkWriteDescriptorSet frameBufWriteDescriptorSet;
+        frameBufWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        frameBufWriteDescriptorSet.pNext = nullptr;
+        frameBufWriteDescriptorSet.dstSet = meshRenderPass.m_vulkanDescriptorSets[frameIndex][0];
+        frameBufWriteDescriptorSet.dstBinding = 0;
+        frameBufWriteDescriptorSet.dstArrayElement = 0;
+        frameBufWriteDescriptorSet.descriptorCount = 1;
+        frameBufWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        frameBufWriteDescriptorSet.pBufferInfo = &frameBufDescriptorBufferInfo;
+        frameBufWriteDescriptorSet.pImageInfo = nullptr;
+        frameBufWriteDescriptorSet.pTexelBufferView = nullptr;
+
+        VkWriteDescriptorSet objectBufWriteDescriptorSet;
+        objectBufWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        objectBufWriteDescriptorSet.pNext = nullptr;
+        objectBufWriteDescriptorSet.dstSet = meshRenderPass.m_vulkanDescriptorSets[frameIndex][1];
+        objectBufWriteDescriptorSet.dstBinding = 0;
+        objectBufWriteDescriptorSet.dstArrayElement = 0;
+        objectBufWriteDescriptorSet.descriptorCount = 1;
+        objectBufWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        objectBufWriteDescriptorSet.pBufferInfo = &objectBufDescriptorBufferInfo;
+        objectBufWriteDescriptorSet.pImageInfo = nullptr;
+        objectBufWriteDescriptorSet.pTexelBufferView = nullptr;
+
+        vkUpdateDescriptorSets(Game::Get()->GetVulkanDevice(), 1, &frameBufWriteDescriptorSet, 0, nullptr);
+        vkUpdateDescriptorSets(Game::Get()->GetVulkanDevice(), 1, &objectBufWriteDescriptorSet, 0, nullptr);
+    }
 
     VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
     pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -320,66 +324,34 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
         return false;
     }
 
+    result = Game::Get()->LoadShader("data/shader_src/MeshShader.vert", shaderc_glsl_vertex_shader, &meshRenderPass.m_vertexShader);
+    if (result != VK_SUCCESS)
     {
-        shaderc_compile_options_t compileOptions = shaderc_compile_options_initialize();
-        if (compileOptions == nullptr)
-        {
-            DUCK_DEMO_ASSERT(false);
-            return false;
-        }
-
-        const std::string useWaterTexture = "USE_WATER_TEXTURE";
-        shaderc_compile_options_add_macro_definition(compileOptions, useWaterTexture.c_str(), static_cast<size_t>(useWaterTexture.size()), nullptr, 0);
-
-        const std::string duckWaterSample = "DUCK_WATER_SAMPLE";
-        shaderc_compile_options_add_macro_definition(compileOptions, duckWaterSample.c_str(), static_cast<size_t>(duckWaterSample.size()), nullptr, 0);
-
-        result = Game::Get()->CompileShaderFromDisk("data/shader_src/MeshShader.vert", shaderc_glsl_vertex_shader, &meshRenderPass.m_vertexShader, compileOptions);
-        if (result != VK_SUCCESS)
-        {
-            DUCK_DEMO_VULKAN_ASSERT(result);
-            return false;
-        }
-    }
-    
-    shaderc_compile_options_t compileOptions = shaderc_compile_options_initialize();
-    if (compileOptions == nullptr)
-    {
-        DUCK_DEMO_ASSERT(false);
+        DUCK_DEMO_VULKAN_ASSERT(result);
         return false;
     }
 
-    if (meshRenderPassParams.m_wireframe)
-    {
-        std::string isWireframe = "IS_WIREFRAME";
-        shaderc_compile_options_add_macro_definition(compileOptions, isWireframe.c_str(), static_cast<size_t>(isWireframe.size()), nullptr, 0);
-    }
-
-    const std::string useDirectionalLight = "USE_DIRECTIONAL_LIGHT";
-    shaderc_compile_options_add_macro_definition(compileOptions, useDirectionalLight.c_str(), static_cast<size_t>(useDirectionalLight.size()), nullptr, 0);
-
-    const std::string useSpotLight = "USE_SPOT_LIGHT";
-    //shaderc_compile_options_add_macro_definition(compileOptions, useSpotLight.c_str(), static_cast<size_t>(useSpotLight.size()), nullptr, 0);
-
-    const std::string usePointLight = "USE_POINT_LIGHT";
-    //shaderc_compile_options_add_macro_definition(compileOptions, usePointLight.c_str(), static_cast<size_t>(usePointLight.size()), nullptr, 0);
-
-    const std::string useTexture = "USE_TEXTURE";
-    shaderc_compile_options_add_macro_definition(compileOptions, useTexture.c_str(), static_cast<size_t>(useTexture.size()), nullptr, 0);
-
-    const std::string maxSampledTextureCount = "MAX_SAMPLED_TEXTURE_COUNT";
-    const std::string maxSampledTextureCountValue = std::to_string(meshRenderPassParams.m_maxRenderObjectCount);
-    shaderc_compile_options_add_macro_definition(compileOptions, 
-        maxSampledTextureCount.c_str(), static_cast<size_t>(maxSampledTextureCount.size()), 
-        maxSampledTextureCountValue.c_str(),  static_cast<size_t>(maxSampledTextureCountValue.size()));
-
-    result = Game::Get()->CompileShaderFromDisk("data/shader_src/MeshShader.frag", shaderc_glsl_fragment_shader, &meshRenderPass.m_fragmentShader, compileOptions);
+    result = Game::Get()->LoadShader("data/shader_src/MeshShader.frag", shaderc_glsl_fragment_shader, &meshRenderPass.m_fragmentShader);
     if (result != VK_SUCCESS)
     {
         DUCK_DEMO_VULKAN_ASSERT(result);
         return false;
     }
 
+    // every variant of the pass shares the same spir-v, the constants pick the variant when the pipeline is created
+    ShaderSpecialization vertexSpecialization;
+    Set_ShaderSpecialization(vertexSpecialization, MeshVertexConstant_DuckWaterSample, VK_TRUE);
+
+    Set_ShaderSpecialization(vertexSpecialization, MeshVertexConstant_OctahedralNormal, meshRenderPassParams.m_vertexFormat.normal == MeshLoader::DirectionFormat_Octahedral16 ? VK_TRUE : VK_FALSE);
+
+    ShaderSpecialization fragmentSpecialization;
+    Set_ShaderSpecialization(fragmentSpecialization, MeshFragmentConstant_Wireframe, meshRenderPassParams.m_wireframe ? VK_TRUE : VK_FALSE);
+    Set_ShaderSpecialization(fragmentSpecialization, MeshFragmentConstant_UseDirectionalLight, VK_TRUE);
+    Set_ShaderSpecialization(fragmentSpecialization, MeshFragmentConstant_UseSpotLight, VK_FALSE);
+    Set_ShaderSpecialization(fragmentSpecialization, MeshFragmentConstant_UsePointLight, VK_FALSE);
+    Set_ShaderSpecialization(fragmentSpecialization, MeshFragmentConstant_UseTexture, VK_TRUE);
+    Set_ShaderSpecialization(fragmentSpecialization, MeshFragmentConstant_MaxSampledTextureCount, meshRenderPassParams.m_maxRenderObjectCount);
+
     std::array<VkPipelineShaderStageCreateInfo, 2> pipelineShaderStageCreateInfo;
     pipelineShaderStageCreateInfo[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     pipelineShaderStageCreateInfo[0].pNext = nullptr;
@@ -387,7 +359,7 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
     pipelineShaderStageCreateInfo[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
     pipelineShaderStageCreateInfo[0].module = meshRenderPass.m_vertexShader;
     pipelineShaderStageCreateInfo[0].pName = "main";
-    pipelineShaderStageCreateInfo[0].pSpecializationInfo = nullptr;
+    pipelineShaderStageCreateInfo[0].pSpecializationInfo = GetInfo_ShaderSpecialization(vertexSpecialization);
 
     pipelineShaderStageCreateInfo[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     pipelineShaderStageCreateInfo[1].pNext = nullptr;
@@ -395,37 +367,10 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
     pipelineShaderStageCreateInfo[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
     pipelineShaderStageCreateInfo[1].module = meshRenderPass.m_fragmentShader;
     pipelineShaderStageCreateInfo[1].pName = "main";
-    pipelineShaderStageCreateInfo[1].pSpecializationInfo = nullptr;
-
-    std::array<VkVertexInputAttributeDescription, 3> vertexInputAttributeDescriptions;
-    vertexInputAttributeDescriptions[0].location = 0;
-    vertexInputAttributeDescriptions[0].binding = 0;
-    vertexInputAttributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-    vertexInputAttributeDescriptions[0].offset = offsetof(MeshLoader::Vertex, position);
-
-    vertexInputAttributeDescriptions[1].location = 1;
-    vertexInputAttributeDescriptions[1].binding = 0;
-    vertexInputAttributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    vertexInputAttributeDescriptions[1].offset = offsetof(MeshLoader::Vertex, normal);
-    
-    vertexInputAttributeDescriptions[2].location = 2;
-    vertexInputAttributeDescriptions[2].binding = 0;
-    vertexInputAttributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-    vertexInputAttributeDescriptions[2].offset = offsetof(MeshLoader::Vertex, texture);
-
-    VkVertexInputBindingDescription vertexInputBindingDescription;
-    vertexInputBindingDescription.binding = 0;
-    vertexInputBindingDescription.stride = sizeof(MeshLoader::Vertex);
-    vertexInputBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-    VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo;
-    pipelineVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    pipelineVertexInputStateCreateInfo.pNext = nullptr;
-    pipelineVertexInputStateCreateInfo.flags = 0;
-    pipelineVertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-    pipelineVertexInputStateCreateInfo.pVertexBindingDescriptions = &vertexInputBindingDescription;
-    pipelineVertexInputStateCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexInputAttributeDescriptions.size());
-    pipelineVertexInputStateCreateInfo.pVertexAttributeDescriptions = vertexInputAttributeDescriptions.data();
+    pipelineShaderStageCreateInfo[1].pSpecializationInfo = GetInfo_ShaderSpecialization(fragmentSpecialization);
+
+    VertexInputState vertexInputState;
+    Init_VertexInputState(vertexInputState, meshRenderPassParams.m_vertexFormat);
 
     VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo;
     pipelineInputAssemblyStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -563,7 +508,7 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
     graphicsPipelineCreateInfo.flags = 0;
     graphicsPipelineCreateInfo.stageCount = static_cast<uint32_t>(pipelineShaderStageCreateInfo.size());
     graphicsPipelineCreateInfo.pStages = pipelineShaderStageCreateInfo.data();
-    graphicsPipelineCreateInfo.pVertexInputState = &pipelineVertexInputStateCreateInfo;
+    graphicsPipelineCreateInfo.pVertexInputState = GetInfo_VertexInputState(vertexInputState);
     graphicsPipelineCreateInfo.pInputAssemblyState = &pipelineInputAssemblyStateCreateInfo;
     graphicsPipelineCreateInfo.pTessellationState = &pipelineTessellationStateCreateInfo;
     graphicsPipelineCreateInfo.pViewportState = &pipelineViewportStateCreateInfo;
@@ -578,7 +523,7 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
     graphicsPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
     graphicsPipelineCreateInfo.basePipelineIndex = 0;
 
-    result = vkCreateGraphicsPipelines(Game::Get()->GetVulkanDevice(), VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, s_allocator, &meshRenderPass.m_vulkanPipeline);
+    result = Game::Get()->CreateVulkanGraphicsPipeline(graphicsPipelineCreateInfo, &meshRenderPass.m_vulkanPipeline);
     if (result != VK_SUCCESS)
     {
         DUCK_DEMO_VULKAN_ASSERT(result);
@@ -590,9 +535,6 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
 
 void Free_MeshRenderPass(MeshRenderPass& meshRenderPass)
 {
-    meshRenderPass.m_vulkanFrameBuffer.Reset();
-    meshRenderPass.m_vulkanObjectBuffer.Reset();
-
     if (meshRenderPass.m_vulkanSampler)
     {
         vkDestroySampler(Game::Get()->GetVulkanDevice(), meshRenderPass.m_vulkanSampler, s_allocator);
@@ -684,7 +626,7 @@ void Resize_MeshRenderPass(MeshRenderPass& meshRenderPass)
     InitFrameBuffers(meshRenderPass);
 }
 
-void Render_MeshRenderPass(MeshRenderPass& meshRenderPass, VkCommandBuffer commandBuffer, const std::vector<RenderObject>& renderObjects)
+void Render_MeshRenderPass(MeshRenderPass& meshRenderPass, VkCommandBuffer commandBuffer, const uint32_t frameBufOffset, const std::vector<RenderObject>& renderObjects)
 {
     std::array<VkClearValue, 2> clearValues;
     clearValues[0] = Game::Get()->GetVulkanClearValue();
@@ -722,19 +664,20 @@ void Render_MeshRenderPass(MeshRenderPass& meshRenderPass, VkCommandBuffer comma
     scissor.extent.height = Game::Get()->GetVulkanSwapchainHeight();
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshRenderPass.m_vulkanPipelineLayout, 0, 1, &meshRenderPass.m_vulkanDescriptorSets[0], 0, nullptr);
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshRenderPass.m_vulkanPipelineLayout, 2, 1, &meshRenderPass.m_vulkanDescriptorSets[2], 0, nullptr);
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshRenderPass.m_vulkanPipelineLayout, 3, 1, &meshRenderPass.m_vulkanDescriptorSets[3], 0, nullptr);
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshRenderPass.m_vulkanPipelineLayout, 4, 1, &meshRenderPass.m_vulkanDescriptorSets[4], 0, nullptr);
+    const std::array<VkDescriptorSet, 5>& descriptorSets = meshRenderPass.m_vulkanDescriptorSets[Game::Get()->GetCurrentFrameIndex()];
+
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshRenderPass.m_vulkanPipelineLayout, 0, 1, &descriptorSets[0], 1, &frameBufOffset);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshRenderPass.m_vulkanPipelineLayout, 2, 1, &descriptorSets[2], 0, nullptr);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshRenderPass.m_vulkanPipelineLayout, 3, 1, &descriptorSets[3], 0, nullptr);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshRenderPass.m_vulkanPipelineLayout, 4, 1, &descriptorSets[4], 0, nullptr);
 
     for (const RenderObject& renderObject : renderObjects)
     {
-        uint32_t dynamicOffsets = Game::Get()->CalculateUniformBufferSize(sizeof(renderObject.objectBuf)) * renderObject.objectBufferIndex;
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshRenderPass.m_vulkanPipelineLayout, 1, 1, &meshRenderPass.m_vulkanDescriptorSets[1], 1, &dynamicOffsets);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, meshRenderPass.m_vulkanPipelineLayout, 1, 1, &descriptorSets[1], 1, &renderObject.m_objectBufOffset);
 
         const VkDeviceSize vertexOffset = 0;
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, &renderObject.m_vertexBuffer->m_buffer, &vertexOffset);
-        vkCmdBindIndexBuffer(commandBuffer, renderObject.m_indexBuffer->m_buffer, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(commandBuffer, renderObject.m_indexBuffer->m_buffer, 0, renderObject.m_indexType);
 
         vkCmdDrawIndexed(commandBuffer, renderObject.m_indexCount, 1, 0, 0, 0);
     }
@@ -752,7 +695,7 @@ void SetWaterImageView_MeshRenderPass(MeshRenderPass& meshRenderPass, VkImageVie
     VkWriteDescriptorSet sampledImageWriteDescriptorSet;
     sampledImageWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     sampledImageWriteDescriptorSet.pNext = nullptr;
-    sampledImageWriteDescriptorSet.dstSet = meshRenderPass.m_vulkanDescriptorSets[4];
+    sampledImageWriteDescriptorSet.dstSet = meshRenderPass.m_vulkanDescriptorSets[Game::Get()->GetCurrentFrameIndex()][4];
     sampledImageWriteDescriptorSet.dstBinding = 0;
     sampledImageWriteDescriptorSet.dstArrayElement = 0;
     sampledImageWriteDescriptorSet.descriptorCount = 1;
@@ -5,6 +5,9 @@
 
 #include <vulkan/vulkan.h>
 
+#include "meshloader/VertexFormat.h"
+
+#include "Game.h"
 #include "VulkanBuffer.h"
 #include "RenderObject.h"
 
@@ -14,20 +17,21 @@ struct MeshRenderPass
     VkRenderPass m_vulkanRenderPass = VK_NULL_HANDLE;
     VkDescriptorPool m_vulkanDescriptorPool = VK_NULL_HANDLE;
     std::array<VkDescriptorSetLayout, 5> m_vulkanDescriptorSetLayouts = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
-    std::array<VkDescriptorSet, 5> m_vulkanDescriptorSets = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+    // descriptor sets are duplicated per frame in flight, frameBuf and objectBuf point into the game's uniform ring and are picked with dynamic offsets
+    std::array<std::array<VkDescriptorSet, 5>, c_maxFramesInFlight> m_vulkanDescriptorSets = {};
     VkPipelineLayout m_vulkanPipelineLayout = VK_NULL_HANDLE;
     VkShaderModule m_vertexShader = VK_NULL_HANDLE;
     VkShaderModule m_fragmentShader = VK_NULL_HANDLE;
     VkPipeline m_vulkanPipeline = VK_NULL_HANDLE;
     VkSampler m_vulkanSampler = VK_NULL_HANDLE;
-    VulkanBuffer m_vulkanFrameBuffer;
-    VulkanBuffer m_vulkanObjectBuffer;
 };
 
 struct MeshRenderPassParams
 {
     bool m_wireframe = false;
     bool m_transparencyBlending = false;
+    // has to match how the vertices of everything drawn with the pass were packed
+    MeshLoader::VertexFormat m_vertexFormat;
     uint32_t m_maxRenderObjectCount = 2;
 };
 
@@ -35,6 +39,7 @@ bool Init_MeshRenderPass(MeshRenderPass& meshRenderPass, const MeshRenderPassPar
 void Free_MeshRenderPass(MeshRenderPass& meshRenderPass);
 
 void Resize_MeshRenderPass(MeshRenderPass& meshRenderPass);
-void Render_MeshRenderPass(MeshRenderPass& meshRenderPass, VkCommandBuffer commandBuffer, const std::vector<RenderObject>& renderObjects);
+// frameBufOffset is the uniform ring offset the frame's FrameBuf was pushed at
+void Render_MeshRenderPass(MeshRenderPass& meshRenderPass, VkCommandBuffer commandBuffer, const uint32_t frameBufOffset, const std::vector<RenderObject>& renderObjects);
 
 void SetWaterImageView_MeshRenderPass(MeshRenderPass& meshRenderPass, VkImageView imageView);
@@ -0,0 +1,124 @@
+#include "MipChain.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "CpuProfiler.h"
+
+// the way back from linear is looked up at this precision, more than enough for 8 bit output
+constexpr uint32_t c_mipChainLinearSteps = 4096;
+
+struct MipChainTables
+{
+    std::array<float, 256> m_toLinear;
+    std::array<uint8_t, c_mipChainLinearSteps> m_fromLinear;
+};
+
+static MipChainTables MakeTables(const bool srgb)
+{
+    // without srgb both tables only convert between 0-255 and 0-1
+    MipChainTables tables;
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        float value = i / 255.0f;
+        if (srgb)
+        {
+            value = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+        }
+        tables.m_toLinear[i] = value;
+    }
+    for (uint32_t i = 0; i < c_mipChainLinearSteps; ++i)
+    {
+        float value = i / static_cast<float>(c_mipChainLinearSteps - 1);
+        if (srgb)
+        {
+            value = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        }
+        tables.m_fromLinear[i] = static_cast<uint8_t>(std::min(std::max(value * 255.0f + 0.5f, 0.0f), 255.0f));
+    }
+    return tables;
+}
+
+static const MipChainTables& GetTables(const bool srgb)
+{
+    // static init is thread safe, the texture loader workers can all get here at once
+    static const MipChainTables s_srgbTables = MakeTables(true);
+    static const MipChainTables s_unormTables = MakeTables(false);
+    return srgb ? s_srgbTables : s_unormTables;
+}
+
+uint32_t GetLevelCount_MipChain(const uint32_t width, const uint32_t height)
+{
+    uint32_t levelCount = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+    {
+        ++levelCount;
+    }
+    return levelCount;
+}
+
+uint32_t GetLevelSize_MipChain(const uint32_t size, const uint32_t level)
+{
+    return std::max(size >> level, 1u);
+}
+
+std::size_t GetSize_MipChain(const uint32_t width, const uint32_t height, const uint32_t levelCount, const uint32_t texelSize)
+{
+    std::size_t size = 0;
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        size += static_cast<std::size_t>(GetLevelSize_MipChain(width, level)) * GetLevelSize_MipChain(height, level) * texelSize;
+    }
+    return size;
+}
+
+static void DownsampleLevel(const MipChainTables& tables, const uint8_t* src, const uint32_t srcWidth, const uint32_t srcHeight, uint8_t* dst, const uint32_t dstWidth, const uint32_t dstHeight)
+{
+    for (uint32_t y = 0; y < dstHeight; ++y)
+    {
+        // odd sizes clamp the last row and column instead of reading past them
+        const uint8_t* srcRow0 = src + static_cast<std::size_t>(std::min(y * 2, srcHeight - 1)) * srcWidth * 4;
+        const uint8_t* srcRow1 = src + static_cast<std::size_t>(std::min(y * 2 + 1, srcHeight - 1)) * srcWidth * 4;
+        uint8_t* dstRow = dst + static_cast<std::size_t>(y) * dstWidth * 4;
+
+        for (uint32_t x = 0; x < dstWidth; ++x)
+        {
+            const uint32_t x0 = std::min(x * 2, srcWidth - 1) * 4;
+            const uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1) * 4;
+            const std::array<const uint8_t*, 4> texels = { srcRow0 + x0, srcRow0 + x1, srcRow1 + x0, srcRow1 + x1 };
+
+            for (uint32_t channel = 0; channel < 3; ++channel)
+            {
+                float sum = 0.0f;
+                for (const uint8_t* texel : texels)
+                {
+                    sum += tables.m_toLinear[texel[channel]];
+                }
+                dstRow[x * 4 + channel] = tables.m_fromLinear[static_cast<uint32_t>(sum * 0.25f * (c_mipChainLinearSteps - 1) + 0.5f)];
+            }
+
+            // alpha isn't srgb encoded
+            const uint32_t alphaSum = texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3];
+            dstRow[x * 4 + 3] = static_cast<uint8_t>((alphaSum + 2) / 4);
+        }
+    }
+}
+
+void Generate_MipChain(uint8_t* mipChain, const uint32_t width, const uint32_t height, const uint32_t levelCount, const bool srgb /*= true*/)
+{
+    DUCK_DEMO_CPU_SCOPE("MipChain::Generate");
+
+    const MipChainTables& tables = GetTables(srgb);
+
+    uint8_t* src = mipChain;
+    for (uint32_t level = 1; level < levelCount; ++level)
+    {
+        const uint32_t srcWidth = GetLevelSize_MipChain(width, level - 1);
+        const uint32_t srcHeight = GetLevelSize_MipChain(height, level - 1);
+        uint8_t* dst = src + static_cast<std::size_t>(srcWidth) * srcHeight * 4;
+
+        DownsampleLevel(tables, src, srcWidth, srcHeight, dst, GetLevelSize_MipChain(width, level), GetLevelSize_MipChain(height, level));
+        src = dst;
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// every level is half the one above it rounded down and never smaller than 1, levels are tightly packed one after another
+
+uint32_t GetLevelCount_MipChain(const uint32_t width, const uint32_t height);
+// width or height of the level
+uint32_t GetLevelSize_MipChain(const uint32_t size, const uint32_t level);
+// bytes taken by the first levelCount levels
+std::size_t GetSize_MipChain(const uint32_t width, const uint32_t height, const uint32_t levelCount, const uint32_t texelSize);
+
+// for when the gpu can't blit the format and for the texture cooker, mipChain holds the rgba8 top level and has room for
+// levelCount levels. each level is a 2x2 box filter of the one above it, srgb colour is filtered in linear space so the
+// chain doesn't darken, anything else (normals, masks) is filtered as it is
+void Generate_MipChain(uint8_t* mipChain, const uint32_t width, const uint32_t height, const uint32_t levelCount, const bool srgb = true);
@@ -11,10 +11,22 @@ struct RenderObject
 {
     ObjectBuf objectBuf;
     int32_t objectBufferIndex = -1;
+    // where this frame's objectBuf was pushed in the uniform ring
+    uint32_t m_objectBufOffset = 0;
 
     std::shared_ptr<VulkanTexture> m_texture;
+    // bit per frame index whose descriptor set has m_texture and not the placeholder
+    uint32_t m_textureBoundFrames = 0;
+    // the texture is bound in the water passes rather than the mesh passes
+    bool m_waterPass = false;
 
     std::shared_ptr<VulkanBuffer> m_indexBuffer;
     uint32_t m_indexCount = 0;
+    VkIndexType m_indexType = VK_INDEX_TYPE_UINT32;
+    // null for the water, its patch positions come from the vertex index
     std::shared_ptr<VulkanBuffer> m_vertexBuffer;
+
+    // instance data this frame pushed into the uniform ring, only the water patch is drawn instanced
+    uint32_t m_instanceOffset = 0;
+    uint32_t m_instanceCount = 1;
 };
@@ -0,0 +1,34 @@
+#include "ShaderSpecialization.h"
+
+void Set_ShaderSpecialization(ShaderSpecialization& shaderSpecialization, const uint32_t constantId, const uint32_t value)
+{
+    for (const VkSpecializationMapEntry& mapEntry : shaderSpecialization.m_mapEntries)
+    {
+        if (mapEntry.constantID == constantId)
+        {
+            shaderSpecialization.m_data[mapEntry.offset / sizeof(uint32_t)] = value;
+            return;
+        }
+    }
+
+    VkSpecializationMapEntry mapEntry;
+    mapEntry.constantID = constantId;
+    mapEntry.offset = static_cast<uint32_t>(shaderSpecialization.m_data.size() * sizeof(uint32_t));
+    mapEntry.size = sizeof(uint32_t);
+    shaderSpecialization.m_mapEntries.push_back(mapEntry);
+    shaderSpecialization.m_data.push_back(value);
+}
+
+const VkSpecializationInfo* GetInfo_ShaderSpecialization(ShaderSpecialization& shaderSpecialization)
+{
+    if (shaderSpecialization.m_mapEntries.empty())
+    {
+        return nullptr;
+    }
+
+    shaderSpecialization.m_specializationInfo.mapEntryCount = static_cast<uint32_t>(shaderSpecialization.m_mapEntries.size());
+    shaderSpecialization.m_specializationInfo.pMapEntries = shaderSpecialization.m_mapEntries.data();
+    shaderSpecialization.m_specializationInfo.dataSize = shaderSpecialization.m_data.size() * sizeof(uint32_t);
+    shaderSpecialization.m_specializationInfo.pData = shaderSpecialization.m_data.data();
+    return &shaderSpecialization.m_specializationInfo;
+}
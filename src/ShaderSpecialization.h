@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// constant_id values of data/shader_src/MeshShader.vert
+enum MeshVertexConstant
+{
+    MeshVertexConstant_DuckWaterSample = 0,
+    // normals come in as MeshLoader::DirectionFormat_Octahedral16 instead of three floats
+    MeshVertexConstant_OctahedralNormal,
+};
+
+// constant_id values of data/shader_src/WaterShader.vert
+enum WaterVertexConstant
+{
+    WaterVertexConstant_PatchQuadCount = 0,
+};
+
+// constant_id values of data/shader_src/MeshShader.frag
+enum MeshFragmentConstant
+{
+    MeshFragmentConstant_Wireframe = 0,
+    MeshFragmentConstant_UseTexture,
+    MeshFragmentConstant_UseTextureSampleScale,
+    MeshFragmentConstant_UseDirectionalLight,
+    MeshFragmentConstant_UseSpotLight,
+    MeshFragmentConstant_UsePointLight,
+    MeshFragmentConstant_MaxSampledTextureCount,
+    // normals come from the gradient in the WaterComputePass heightmap rather than the vertex shader
+    MeshFragmentConstant_WaterGradientNormal,
+};
+
+// constant_id values of data/shader_src/water.comp
+enum WaterComputeConstant
+{
+    WaterComputeConstant_LocalSizeX = 0,
+    WaterComputeConstant_LocalSizeY,
+};
+
+// every constant in the shaders is 32 bits wide, bools included, so each one takes a uint32_t of the data
+struct ShaderSpecialization
+{
+    std::vector<VkSpecializationMapEntry> m_mapEntries;
+    std::vector<uint32_t> m_data;
+    VkSpecializationInfo m_specializationInfo;
+};
+
+// constants that are never set keep the default the shader gives them
+void Set_ShaderSpecialization(ShaderSpecialization& shaderSpecialization, const uint32_t constantId, const uint32_t value);
+// only valid until the next Set_ShaderSpecialization, nullptr if nothing was set
+const VkSpecializationInfo* GetInfo_ShaderSpecialization(ShaderSpecialization& shaderSpecialization);
@@ -0,0 +1,56 @@
+#include "TaskGroup.h"
+
+#include <chrono>
+
+#include "CpuProfiler.h"
+
+static void RunTask(TaskGroupTask& task)
+{
+    const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+    {
+        CpuProfilerScope cpuProfilerScope(task.m_name);
+        task.m_result = task.m_function();
+    }
+    task.m_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void Init_TaskGroup(TaskGroup& taskGroup, const bool parallel)
+{
+    taskGroup.m_parallel = parallel;
+}
+
+void Add_TaskGroup(TaskGroup& taskGroup, const char* name, std::function<bool()> function)
+{
+    taskGroup.m_tasks.emplace_back(new TaskGroupTask());
+    TaskGroupTask& task = *taskGroup.m_tasks.back();
+    task.m_name = name;
+    task.m_function = std::move(function);
+
+    if (!taskGroup.m_parallel)
+    {
+        RunTask(task);
+        return;
+    }
+
+    taskGroup.m_threads.emplace_back([&task]()
+    {
+        CpuProfiler::SetThreadName(task.m_name);
+        RunTask(task);
+    });
+}
+
+bool Wait_TaskGroup(TaskGroup& taskGroup)
+{
+    for (std::thread& thread : taskGroup.m_threads)
+    {
+        thread.join();
+    }
+    taskGroup.m_threads.clear();
+
+    bool result = true;
+    for (const std::unique_ptr<TaskGroupTask>& task : taskGroup.m_tasks)
+    {
+        result = result && task->m_result;
+    }
+    return result;
+}
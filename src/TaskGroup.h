@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct TaskGroupTask
+{
+    // must point at a string literal, it names the worker thread in cpu traces too
+    const char* m_name = nullptr;
+    std::function<bool()> m_function;
+    bool m_result = false;
+    // seconds from the task starting to it returning
+    double m_time = 0.0;
+};
+
+// startup only has a handful of long tasks so each one simply gets a thread of its own
+struct TaskGroup
+{
+    std::vector<std::unique_ptr<TaskGroupTask>> m_tasks;
+    std::vector<std::thread> m_threads;
+    // false runs every task on the calling thread inside Add_TaskGroup, handy for comparing timings
+    bool m_parallel = true;
+};
+
+void Init_TaskGroup(TaskGroup& taskGroup, const bool parallel);
+// starts the task right away, it must not touch anything the calling thread keeps using until Wait_TaskGroup
+void Add_TaskGroup(TaskGroup& taskGroup, const char* name, std::function<bool()> function);
+// joins every task and returns false if any of them failed, the tasks stay around to read their times
+bool Wait_TaskGroup(TaskGroup& taskGroup);
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include <sys/stat.h>
+
+// .ddtex files are written by duck_texcook (tools/texcook) next to the png they were cooked from and loaded by the
+// TextureLoader in its place. the header is followed by every mip level's blocks, top level first with no gaps
+
+constexpr uint32_t c_textureContainerMagic = 0x58544444u; // "DDTX"
+// bump whenever the layout changes, files with another version are ignored and the png is loaded instead
+constexpr uint32_t c_textureContainerVersion = 2u;
+constexpr uint32_t c_textureContainerMaxLevelCount = 16u;
+constexpr const char* c_textureContainerExtension = ".ddtex";
+
+enum TextureContainerFormat : uint32_t
+{
+    // rgb, 8 bytes a block, for specular and other masks
+    TextureContainerFormat_BC1 = 0,
+    // two channels, 16 bytes a block, for tangent space normals with z rebuilt in the shader
+    TextureContainerFormat_BC5,
+    // srgb rgba, 16 bytes a block, for diffuse colour
+    TextureContainerFormat_BC7,
+    TextureContainerFormat_COUNT,
+};
+
+struct TextureContainerLevel
+{
+    // from the start of the file
+    uint64_t m_offset = 0;
+    uint64_t m_size = 0;
+};
+
+struct TextureContainerHeader
+{
+    uint32_t m_magic = c_textureContainerMagic;
+    uint32_t m_version = c_textureContainerVersion;
+    uint32_t m_format = TextureContainerFormat_COUNT;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_levelCount = 0;
+    // size and modification time of the png when it was cooked, the loader ignores the file once either changes
+    uint64_t m_sourceSize = 0;
+    int64_t m_sourceModifiedTime = 0;
+    TextureContainerLevel m_levels[c_textureContainerMaxLevelCount];
+};
+
+// every format is 4x4 blocks
+constexpr uint32_t c_textureContainerBlockExtent = 4u;
+
+inline uint32_t GetBlockSize_TextureContainer(const uint32_t format)
+{
+    return format == TextureContainerFormat_BC1 ? 8u : 16u;
+}
+
+// both the cooker and the loader go through stat so the times they compare are in the same units
+inline bool GetSourceStamp_TextureContainer(const char* path, uint64_t& OutSize, int64_t& OutModifiedTime)
+{
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_stat64(path, &info) != 0)
+#else
+    struct stat info;
+    if (stat(path, &info) != 0)
+#endif // _WIN32
+    {
+        return false;
+    }
+
+    OutSize = static_cast<uint64_t>(info.st_size);
+    OutModifiedTime = static_cast<int64_t>(info.st_mtime);
+    return true;
+}
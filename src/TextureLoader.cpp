@@ -0,0 +1,392 @@
+#include "TextureLoader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "CpuProfiler.h"
+#include "DuckDemoUtils.h"
+#include "Game.h"
+#include "MipChain.h"
+#include "TextureContainer.h"
+
+static std::size_t GetDecodedSize(const TextureLoadRequest& request)
+{
+    if (request.m_container != nullptr)
+    {
+        return request.m_container->dataSize;
+    }
+    return request.m_mipChain.empty() ? static_cast<std::size_t>(request.m_width) * request.m_height * 4u : request.m_mipChain.size();
+}
+
+static VkFormat GetContainerVkFormat(const uint32_t format)
+{
+    switch (format)
+    {
+    case TextureContainerFormat_BC1:
+        return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+    case TextureContainerFormat_BC5:
+        return VK_FORMAT_BC5_UNORM_BLOCK;
+    case TextureContainerFormat_BC7:
+        return VK_FORMAT_BC7_SRGB_BLOCK;
+    default:
+        DUCK_DEMO_ASSERT(false);
+        return VK_FORMAT_UNDEFINED;
+    }
+}
+
+static TextureContainerHeader GetContainerHeader(const DuckDemoMappedFile& container)
+{
+    TextureContainerHeader header;
+    memcpy(&header, container.data, sizeof(header));
+    return header;
+}
+
+// a stale or broken file only costs falling back to the png so everything is checked against the file size and the png
+static bool IsValidContainer(const DuckDemoMappedFile& container, const std::string& sourcePath)
+{
+    if (container.dataSize < sizeof(TextureContainerHeader))
+    {
+        return false;
+    }
+
+    const TextureContainerHeader header = GetContainerHeader(container);
+    if (header.m_magic != c_textureContainerMagic ||
+        header.m_version != c_textureContainerVersion ||
+        header.m_format >= TextureContainerFormat_COUNT ||
+        header.m_width == 0 ||
+        header.m_height == 0 ||
+        header.m_levelCount == 0 ||
+        header.m_levelCount > std::min(c_textureContainerMaxLevelCount, GetLevelCount_MipChain(header.m_width, header.m_height)))
+    {
+        return false;
+    }
+
+    // a png that's missing keeps whatever was cooked from it, one that was edited since has to be loaded instead
+    uint64_t sourceSize = 0;
+    int64_t sourceModifiedTime = 0;
+    if (GetSourceStamp_TextureContainer(sourcePath.c_str(), sourceSize, sourceModifiedTime) &&
+        (sourceSize != header.m_sourceSize || sourceModifiedTime != header.m_sourceModifiedTime))
+    {
+        return false;
+    }
+
+    // the levels are uploaded as one run of data so they have to follow each other
+    uint64_t levelOffset = header.m_levels[0].m_offset;
+    for (uint32_t level = 0; level < header.m_levelCount; ++level)
+    {
+        const uint64_t blocksWide = (GetLevelSize_MipChain(header.m_width, level) + c_textureContainerBlockExtent - 1) / c_textureContainerBlockExtent;
+        const uint64_t blocksHigh = (GetLevelSize_MipChain(header.m_height, level) + c_textureContainerBlockExtent - 1) / c_textureContainerBlockExtent;
+        const TextureContainerLevel& containerLevel = header.m_levels[level];
+        if (containerLevel.m_offset != levelOffset || containerLevel.m_size != blocksWide * blocksHigh * GetBlockSize_TextureContainer(header.m_format))
+        {
+            return false;
+        }
+        levelOffset += containerLevel.m_size;
+    }
+
+    return header.m_levels[0].m_offset >= sizeof(TextureContainerHeader) && levelOffset <= container.dataSize;
+}
+
+static bool MapContainer(TextureLoadRequest& request)
+{
+    const std::size_t extensionOffset = request.m_path.find_last_of('.');
+    const std::size_t directoryOffset = request.m_path.find_last_of("/\\");
+    const bool hasExtension = extensionOffset != std::string::npos && (directoryOffset == std::string::npos || extensionOffset > directoryOffset);
+    const std::string containerPath = (hasExtension ? request.m_path.substr(0, extensionOffset) : request.m_path) + c_textureContainerExtension;
+
+    std::unique_ptr<DuckDemoMappedFile> container = DuckDemoUtils::MapFileFromDisk(containerPath);
+    if (container == nullptr)
+    {
+        return false;
+    }
+
+    if (!IsValidContainer(*container, request.m_path))
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "TextureLoader: %s is out of date or broken, loading %s instead", containerPath.c_str(), request.m_path.c_str());
+        return false;
+    }
+
+    // touch every page here so the main thread's copy into staging doesn't end up waiting on the disk
+    constexpr std::size_t pageSize = 4096;
+    volatile uint8_t pageSum = 0;
+    for (std::size_t offset = 0; offset < container->dataSize; offset += pageSize)
+    {
+        pageSum = static_cast<uint8_t>(pageSum + container->data[offset]);
+    }
+
+    const TextureContainerHeader header = GetContainerHeader(*container);
+    request.m_width = header.m_width;
+    request.m_height = header.m_height;
+    request.m_container = std::move(container);
+    return true;
+}
+
+static const void* GetUploadPixels(const TextureLoadRequest& request, uint32_t& OutLevelCount)
+{
+    if (request.m_mipChain.empty())
+    {
+        OutLevelCount = 1;
+        return request.m_pixels;
+    }
+
+    OutLevelCount = GetLevelCount_MipChain(request.m_width, request.m_height);
+    return request.m_mipChain.data();
+}
+
+static void DecodeRequest(TextureLoadRequest& request)
+{
+    DUCK_DEMO_CPU_SCOPE("TextureLoader::Decode");
+
+    // the flags are set before any worker starts and never change
+    if (Game::Get()->IsTextureCompressionBCSupported() && MapContainer(request))
+    {
+        return;
+    }
+
+    std::unique_ptr<DuckDemoFile> file = DuckDemoUtils::LoadFileFromDisk(request.m_path);
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    int width = 0;
+    int height = 0;
+    int channelsInFile = 0;
+    request.m_pixels = stbi_load_from_memory(
+        reinterpret_cast<stbi_uc*>(file->buffer.get()),
+        static_cast<int>(file->bufferSize),
+        &width,
+        &height,
+        &channelsInFile,
+        STBI_rgb_alpha);
+
+    if (request.m_pixels == nullptr)
+    {
+        return;
+    }
+    request.m_width = static_cast<uint32_t>(width);
+    request.m_height = static_cast<uint32_t>(height);
+
+    if (!Game::Get()->CanBlitVulkanTextureMips())
+    {
+        const uint32_t levelCount = GetLevelCount_MipChain(request.m_width, request.m_height);
+        request.m_mipChain.resize(GetSize_MipChain(request.m_width, request.m_height, levelCount, 4u));
+        memcpy(request.m_mipChain.data(), request.m_pixels, static_cast<std::size_t>(request.m_width) * request.m_height * 4u);
+        Generate_MipChain(request.m_mipChain.data(), request.m_width, request.m_height, levelCount);
+
+        stbi_image_free(request.m_pixels);
+        request.m_pixels = nullptr;
+    }
+}
+
+static void RunWorker(TextureLoader& textureLoader, const uint32_t workerIndex)
+{
+    CpuProfiler::SetThreadName(DuckDemoUtils::format("TextureLoader %u", workerIndex));
+
+    std::unique_lock<std::mutex> lock(textureLoader.m_mutex);
+    while (true)
+    {
+        // a backlog of decoded images waiting on the upload budget would otherwise grow without end
+        textureLoader.m_condition.wait(lock, [&textureLoader]()
+        {
+            return textureLoader.m_quit || (!textureLoader.m_queuedRequests.empty() && textureLoader.m_decodedBytes < c_textureLoaderMaxDecodedBytes);
+        });
+
+        if (textureLoader.m_quit)
+        {
+            return;
+        }
+
+        std::unique_ptr<TextureLoadRequest> request = std::move(textureLoader.m_queuedRequests.front());
+        textureLoader.m_queuedRequests.pop_front();
+
+        lock.unlock();
+        DecodeRequest(*request);
+        lock.lock();
+
+        textureLoader.m_decodedBytes += GetDecodedSize(*request);
+        textureLoader.m_decodedRequests.push_back(std::move(request));
+    }
+}
+
+static void ReleasePixels(TextureLoadRequest& request)
+{
+    if (request.m_pixels != nullptr)
+    {
+        stbi_image_free(request.m_pixels);
+        request.m_pixels = nullptr;
+    }
+    std::vector<uint8_t>().swap(request.m_mipChain);
+    request.m_container.reset();
+}
+
+bool Init_TextureLoader(TextureLoader& textureLoader)
+{
+    // white so the material's albedo still shows through while the real texture loads
+    const uint32_t placeholderPixel = 0xffffffffu;
+    VkResult result = Game::Get()->CreateVulkanDeviceTexture(1, 1, &placeholderPixel, 1, textureLoader.m_placeholderTexture);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+    // the first frame's submit waits on the upload like it does for any other
+    textureLoader.m_placeholderTexture.m_ready = true;
+
+    // decoding is the slow part, the main thread is busy enough with rendering so it keeps a core to itself
+    const uint32_t hardwareThreadCount = std::max(std::thread::hardware_concurrency(), 2u);
+    const uint32_t threadCount = std::min(hardwareThreadCount - 1u, c_textureLoaderMaxThreadCount);
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+        textureLoader.m_threads.emplace_back(RunWorker, std::ref(textureLoader), i);
+    }
+
+    return true;
+}
+
+void Free_TextureLoader(TextureLoader& textureLoader)
+{
+    {
+        std::lock_guard<std::mutex> lock(textureLoader.m_mutex);
+        textureLoader.m_quit = true;
+    }
+    textureLoader.m_condition.notify_all();
+
+    for (std::thread& thread : textureLoader.m_threads)
+    {
+        thread.join();
+    }
+    textureLoader.m_threads.clear();
+
+    textureLoader.m_queuedRequests.clear();
+    for (std::unique_ptr<TextureLoadRequest>& request : textureLoader.m_decodedRequests)
+    {
+        ReleasePixels(*request);
+    }
+    textureLoader.m_decodedRequests.clear();
+    textureLoader.m_decodedBytes = 0;
+    textureLoader.m_uploadingRequests.clear();
+    textureLoader.m_mipBlitTextures.clear();
+
+    textureLoader.m_placeholderTexture.Reset();
+}
+
+std::shared_ptr<VulkanTexture> Load_TextureLoader(TextureLoader& textureLoader, const std::string& path)
+{
+    std::unique_ptr<TextureLoadRequest> request(new TextureLoadRequest());
+    request->m_path = path;
+    request->m_texture = std::make_shared<VulkanTexture>();
+    std::shared_ptr<VulkanTexture> texture = request->m_texture;
+
+    {
+        std::lock_guard<std::mutex> lock(textureLoader.m_mutex);
+        textureLoader.m_queuedRequests.push_back(std::move(request));
+    }
+    textureLoader.m_condition.notify_one();
+
+    return texture;
+}
+
+void Update_TextureLoader(TextureLoader& textureLoader)
+{
+    DUCK_DEMO_CPU_SCOPE("TextureLoader::Update");
+
+    Game* game = Game::Get();
+    UploadManager& uploadManager = game->GetUploadManager();
+
+    std::vector<std::unique_ptr<TextureLoadRequest>>& uploadingRequests = textureLoader.m_uploadingRequests;
+    for (std::unique_ptr<TextureLoadRequest>& request : uploadingRequests)
+    {
+        if (IsComplete_UploadManager(uploadManager, request->m_uploadValue))
+        {
+            // ready already, the blits are recorded ahead of everything else in this frame
+            if (request->m_pixelLevelCount < request->m_texture->m_mipLevelCount)
+            {
+                textureLoader.m_mipBlitTextures.push_back(request->m_texture);
+            }
+            request->m_texture->m_ready = true;
+            request.reset();
+        }
+    }
+    uploadingRequests.erase(std::remove(uploadingRequests.begin(), uploadingRequests.end(), nullptr), uploadingRequests.end());
+
+    // always takes at least one so an image bigger than the budget still gets through
+    VkDeviceSize uploadedBytes = 0;
+    while (uploadedBytes < c_textureLoaderFrameUploadBudget)
+    {
+        std::unique_ptr<TextureLoadRequest> request;
+        {
+            std::lock_guard<std::mutex> lock(textureLoader.m_mutex);
+            if (textureLoader.m_decodedRequests.empty())
+            {
+                break;
+            }
+            request = std::move(textureLoader.m_decodedRequests.front());
+            textureLoader.m_decodedRequests.pop_front();
+            textureLoader.m_decodedBytes -= GetDecodedSize(*request);
+        }
+        textureLoader.m_condition.notify_all();
+
+        VkResult result = VK_SUCCESS;
+        if (request->m_container != nullptr)
+        {
+            // the blocks are read out of the mapping as they're copied into staging, nothing is decoded
+            const TextureContainerHeader header = GetContainerHeader(*request->m_container);
+            request->m_pixelLevelCount = header.m_levelCount;
+            result = game->CreateVulkanCompressedTexture(
+                GetContainerVkFormat(header.m_format),
+                header.m_width,
+                header.m_height,
+                header.m_levelCount,
+                GetBlockSize_TextureContainer(header.m_format),
+                request->m_container->data + header.m_levels[0].m_offset,
+                *request->m_texture,
+                &request->m_uploadValue);
+        }
+        else
+        {
+            const void* pixels = GetUploadPixels(*request, request->m_pixelLevelCount);
+            if (pixels == nullptr)
+            {
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "TextureLoader: failed to load %s, keeping the placeholder", request->m_path.c_str());
+                continue;
+            }
+
+            result = game->CreateVulkanDeviceTexture(request->m_width, request->m_height, pixels, request->m_pixelLevelCount, *request->m_texture, &request->m_uploadValue);
+        }
+        uploadedBytes += GetDecodedSize(*request);
+        ReleasePixels(*request);
+        if (result != VK_SUCCESS)
+        {
+            DUCK_DEMO_VULKAN_ASSERT(result);
+            continue;
+        }
+
+        uploadingRequests.push_back(std::move(request));
+    }
+}
+
+VkImageView GetImageView_TextureLoader(TextureLoader& textureLoader, const VulkanTexture* texture)
+{
+    return texture != nullptr && texture->m_ready ? texture->m_imageView : textureLoader.m_placeholderTexture.m_imageView;
+}
+
+void RecordMipBlits_TextureLoader(TextureLoader& textureLoader, VkCommandBuffer commandBuffer)
+{
+    if (textureLoader.m_mipBlitTextures.empty())
+    {
+        return;
+    }
+
+    DUCK_DEMO_CPU_SCOPE("TextureLoader::RecordMipBlits");
+
+    Game* game = Game::Get();
+    for (const std::shared_ptr<VulkanTexture>& texture : textureLoader.m_mipBlitTextures)
+    {
+        game->RecordVulkanTextureMipBlit(commandBuffer, *texture, 1);
+    }
+    textureLoader.m_mipBlitTextures.clear();
+}
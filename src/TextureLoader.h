@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "DuckDemoUtils.h"
+#include "VulkanTexture.h"
+
+// decoded images are uploaded over several frames when there's more than this, so a burst of loads doesn't stall one
+constexpr VkDeviceSize c_textureLoaderFrameUploadBudget = 8u * 1024u * 1024u;
+// workers stop decoding once this much is waiting on the main thread
+constexpr std::size_t c_textureLoaderMaxDecodedBytes = 256u * 1024u * 1024u;
+constexpr uint32_t c_textureLoaderMaxThreadCount = 4u;
+
+struct TextureLoadRequest
+{
+    std::string m_path;
+    // kept alive by the request until the upload is done even if whoever asked for it lets go
+    std::shared_ptr<VulkanTexture> m_texture;
+    // the cooked .ddtex when there is one, its blocks are copied straight into staging and the png is never read
+    std::unique_ptr<DuckDemoMappedFile> m_container;
+    // rgba8, freed with stbi_image_free
+    unsigned char* m_pixels = nullptr;
+    // the whole chain when the gpu can't blit mips, m_pixels is freed once this is filled
+    std::vector<uint8_t> m_mipChain;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    // levels that went through the upload manager, anything after them is blitted
+    uint32_t m_pixelLevelCount = 0;
+    uint64_t m_uploadValue = 0;
+};
+
+// files are read and decoded on worker threads, the main thread creates the images and records the uploads,
+// a texture is only marked ready once its upload has finished on the gpu
+struct TextureLoader
+{
+    std::vector<std::thread> m_threads;
+
+    // guards everything up to m_quit
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::unique_ptr<TextureLoadRequest>> m_queuedRequests;
+    std::deque<std::unique_ptr<TextureLoadRequest>> m_decodedRequests;
+    std::size_t m_decodedBytes = 0;
+    bool m_quit = false;
+
+    // main thread only
+    std::vector<std::unique_ptr<TextureLoadRequest>> m_uploadingRequests;
+    // uploaded with only their top level, the rest of the chain is blitted at the start of the next frame
+    std::vector<std::shared_ptr<VulkanTexture>> m_mipBlitTextures;
+    // bound in place of every texture that isn't ready yet
+    VulkanTexture m_placeholderTexture;
+};
+
+bool Init_TextureLoader(TextureLoader& textureLoader);
+void Free_TextureLoader(TextureLoader& textureLoader);
+
+// returns right away, the texture has no image until it's ready so bind GetImageView_TextureLoader instead of it
+std::shared_ptr<VulkanTexture> Load_TextureLoader(TextureLoader& textureLoader, const std::string& path);
+// main thread once a frame before anything is recorded, uploads what was decoded and marks finished uploads ready
+void Update_TextureLoader(TextureLoader& textureLoader);
+// records the mip blits of the textures made ready this frame, has to come before anything in the frame samples them
+void RecordMipBlits_TextureLoader(TextureLoader& textureLoader, VkCommandBuffer commandBuffer);
+// the texture's view once it's ready, the placeholder's until then
+VkImageView GetImageView_TextureLoader(TextureLoader& textureLoader, const VulkanTexture* texture);
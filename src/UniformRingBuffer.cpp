@@ -0,0 +1,125 @@
+#include "UniformRingBuffer.h"
+
+#include <cstring>
+
+#include "DuckDemoUtils.h"
+#include "Game.h"
+
+bool Init_UniformRingBuffer(UniformRingBuffer& uniformRingBuffer, const VkDeviceSize frameSize, const uint32_t frameCount)
+{
+    Game* game = Game::Get();
+    VkDevice device = game->GetVulkanDevice();
+    VulkanMemoryAllocator& vulkanMemoryAllocator = game->GetVulkanMemoryAllocator();
+
+    // every slice has to start on a valid dynamic offset so the offsets handed out inside it are too
+    uniformRingBuffer.m_frameSize = game->CalculateUniformBufferSize(static_cast<std::size_t>(frameSize));
+    uniformRingBuffer.m_frameCount = frameCount;
+
+    VkBufferCreateInfo bufferCreateInfo;
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.pNext = nullptr;
+    bufferCreateInfo.flags = 0;
+    bufferCreateInfo.size = uniformRingBuffer.m_frameSize * frameCount;
+    // per instance data is pushed in here too so it can be bound as a vertex buffer
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    bufferCreateInfo.queueFamilyIndexCount = 0;
+    bufferCreateInfo.pQueueFamilyIndices = nullptr;
+
+    VkResult result = vkCreateBuffer(device, &bufferCreateInfo, s_allocator, &uniformRingBuffer.m_buffer);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(device, uniformRingBuffer.m_buffer, &memoryRequirements);
+
+    // coherent memory saves the flush every frame but any host visible memory will do
+    const uint32_t memoryTypeIndex = FindMemoryType_VulkanMemoryAllocator(
+        vulkanMemoryAllocator,
+        memoryRequirements.memoryTypeBits,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (memoryTypeIndex == c_vulkanMemoryInvalidIndex)
+    {
+        DUCK_DEMO_SHOW_ERROR("UniformRingBuffer Error", "Could not find host visible memory for the uniform ring buffer");
+        return false;
+    }
+
+    result = Allocate_VulkanMemoryAllocator(vulkanMemoryAllocator, memoryRequirements, memoryTypeIndex, VulkanMemoryTiling_Linear, uniformRingBuffer.m_allocation);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    result = vkBindBufferMemory(device, uniformRingBuffer.m_buffer, uniformRingBuffer.m_allocation.m_deviceMemory, uniformRingBuffer.m_allocation.m_offset);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    if (!IsHostCoherent_VulkanMemoryAllocator(vulkanMemoryAllocator, uniformRingBuffer.m_allocation))
+    {
+        SDL_Log("UniformRingBuffer: no host coherent memory, pushed uniforms will be flushed before every submit");
+    }
+
+    BeginFrame_UniformRingBuffer(uniformRingBuffer, 0);
+
+    return true;
+}
+
+void Free_UniformRingBuffer(UniformRingBuffer& uniformRingBuffer)
+{
+    Game* game = Game::Get();
+
+    if (uniformRingBuffer.m_buffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(game->GetVulkanDevice(), uniformRingBuffer.m_buffer, s_allocator);
+        uniformRingBuffer.m_buffer = VK_NULL_HANDLE;
+    }
+
+    Deallocate_VulkanMemoryAllocator(game->GetVulkanMemoryAllocator(), uniformRingBuffer.m_allocation);
+}
+
+void BeginFrame_UniformRingBuffer(UniformRingBuffer& uniformRingBuffer, const uint32_t frameIndex)
+{
+    DUCK_DEMO_ASSERT(frameIndex < uniformRingBuffer.m_frameCount);
+
+    uniformRingBuffer.m_frameIndex = frameIndex;
+    uniformRingBuffer.m_head = uniformRingBuffer.m_frameSize * frameIndex;
+    uniformRingBuffer.m_flushedHead = uniformRingBuffer.m_head;
+}
+
+uint32_t Push_UniformRingBuffer(UniformRingBuffer& uniformRingBuffer, const void* data, const std::size_t dataSize)
+{
+    DUCK_DEMO_ASSERT(uniformRingBuffer.m_allocation.m_mappedData != nullptr);
+
+    const VkDeviceSize frameBegin = uniformRingBuffer.m_frameSize * uniformRingBuffer.m_frameIndex;
+    const VkDeviceSize alignedSize = Game::Get()->CalculateUniformBufferSize(dataSize);
+    if (uniformRingBuffer.m_head + alignedSize > frameBegin + uniformRingBuffer.m_frameSize)
+    {
+        // the slice is too small for the frame, c_uniformRingBufferFrameSize needs to go up
+        DUCK_DEMO_ASSERT(false);
+        return static_cast<uint32_t>(frameBegin);
+    }
+
+    const VkDeviceSize offset = uniformRingBuffer.m_head;
+    memcpy(uniformRingBuffer.m_allocation.m_mappedData + offset, data, dataSize);
+    uniformRingBuffer.m_head += alignedSize;
+
+    return static_cast<uint32_t>(offset);
+}
+
+void Flush_UniformRingBuffer(UniformRingBuffer& uniformRingBuffer)
+{
+    Flush_VulkanMemoryAllocator(
+        Game::Get()->GetVulkanMemoryAllocator(),
+        uniformRingBuffer.m_allocation,
+        uniformRingBuffer.m_flushedHead,
+        uniformRingBuffer.m_head - uniformRingBuffer.m_flushedHead);
+    uniformRingBuffer.m_flushedHead = uniformRingBuffer.m_head;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanMemoryAllocator.h"
+
+// a frame's worth of uniforms and instance data for every pass, the duck and water only need a few tens of kb of it
+constexpr VkDeviceSize c_uniformRingBufferFrameSize = 256u * 1024u;
+
+// one persistently mapped buffer split into a slice per frame in flight, the cpu only ever writes into the slice
+// of the frame it's recording which the gpu is done with since the frame's fence was waited on
+struct UniformRingBuffer
+{
+    VkBuffer m_buffer = VK_NULL_HANDLE;
+    VulkanAllocation m_allocation;
+    VkDeviceSize m_frameSize = 0;
+    uint32_t m_frameCount = 0;
+    uint32_t m_frameIndex = 0;
+    // offsets from the start of the buffer
+    VkDeviceSize m_head = 0;
+    VkDeviceSize m_flushedHead = 0;
+};
+
+bool Init_UniformRingBuffer(UniformRingBuffer& uniformRingBuffer, const VkDeviceSize frameSize, const uint32_t frameCount);
+void Free_UniformRingBuffer(UniformRingBuffer& uniformRingBuffer);
+
+// only call once the frame's fence has signaled, everything pushed the last time this frame was recorded is thrown away
+void BeginFrame_UniformRingBuffer(UniformRingBuffer& uniformRingBuffer, const uint32_t frameIndex);
+// copies the data into the current frame's slice and returns the dynamic offset to bind it with, or the vertex buffer offset
+uint32_t Push_UniformRingBuffer(UniformRingBuffer& uniformRingBuffer, const void* data, const std::size_t dataSize);
+// has to happen before the submit that reads what was pushed, does nothing on host coherent memory
+void Flush_UniformRingBuffer(UniformRingBuffer& uniformRingBuffer);
@@ -0,0 +1,474 @@
+#include "UploadManager.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "CpuProfiler.h"
+#include "DuckDemoUtils.h"
+#include "Game.h"
+#include "MipChain.h"
+
+static bool IsBatchFree(const UploadBatch& batch)
+{
+    return !batch.m_submitted && !batch.m_renderWaitPending && batch.m_renderWaitFrameNumber == 0;
+}
+
+static void UpdateCompleted(UploadManager& uploadManager)
+{
+    VkDevice device = Game::Get()->GetVulkanDevice();
+    for (std::unique_ptr<UploadBatch>& batch : uploadManager.m_batches)
+    {
+        if (batch->m_submitted && vkGetFenceStatus(device, batch->m_fence) == VK_SUCCESS)
+        {
+            batch->m_submitted = false;
+            uploadManager.m_completedValue = std::max(uploadManager.m_completedValue, batch->m_value);
+            uploadManager.m_stagingRead = std::max(uploadManager.m_stagingRead, batch->m_stagingEnd);
+        }
+    }
+}
+
+static UploadBatch* CreateBatch(UploadManager& uploadManager)
+{
+    VkDevice device = Game::Get()->GetVulkanDevice();
+    std::unique_ptr<UploadBatch> batch(new UploadBatch());
+
+    VkCommandPoolCreateInfo commandPoolCreateInfo;
+    commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolCreateInfo.pNext = nullptr;
+    commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    commandPoolCreateInfo.queueFamilyIndex = uploadManager.m_queueFamilyIndex;
+    DUCK_DEMO_VULKAN_ASSERT(vkCreateCommandPool(device, &commandPoolCreateInfo, s_allocator, &batch->m_commandPool));
+
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo;
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.pNext = nullptr;
+    commandBufferAllocateInfo.commandPool = batch->m_commandPool;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = 1;
+    DUCK_DEMO_VULKAN_ASSERT(vkAllocateCommandBuffers(device, &commandBufferAllocateInfo, &batch->m_commandBuffer));
+
+    VkFenceCreateInfo fenceCreateInfo;
+    fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceCreateInfo.pNext = nullptr;
+    fenceCreateInfo.flags = 0;
+    DUCK_DEMO_VULKAN_ASSERT(vkCreateFence(device, &fenceCreateInfo, s_allocator, &batch->m_fence));
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo;
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = nullptr;
+    semaphoreCreateInfo.flags = 0;
+    DUCK_DEMO_VULKAN_ASSERT(vkCreateSemaphore(device, &semaphoreCreateInfo, s_allocator, &batch->m_semaphore));
+
+    uploadManager.m_batches.push_back(std::move(batch));
+    return uploadManager.m_batches.back().get();
+}
+
+static UploadBatch* GetRecordingBatch(UploadManager& uploadManager)
+{
+    if (uploadManager.m_recordingBatch != nullptr)
+    {
+        return uploadManager.m_recordingBatch;
+    }
+
+    VkDevice device = Game::Get()->GetVulkanDevice();
+
+    UploadBatch* batch = nullptr;
+    for (std::unique_ptr<UploadBatch>& freeBatch : uploadManager.m_batches)
+    {
+        if (IsBatchFree(*freeBatch))
+        {
+            batch = freeBatch.get();
+            DUCK_DEMO_VULKAN_ASSERT(vkResetFences(device, 1, &batch->m_fence));
+            DUCK_DEMO_VULKAN_ASSERT(vkResetCommandPool(device, batch->m_commandPool, 0));
+            break;
+        }
+    }
+
+    if (batch == nullptr)
+    {
+        batch = CreateBatch(uploadManager);
+    }
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo;
+    commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    commandBufferBeginInfo.pNext = nullptr;
+    commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    commandBufferBeginInfo.pInheritanceInfo = nullptr;
+    DUCK_DEMO_VULKAN_ASSERT(vkBeginCommandBuffer(batch->m_commandBuffer, &commandBufferBeginInfo));
+
+    batch->m_value = uploadManager.m_nextValue;
+    uploadManager.m_recordingBatch = batch;
+    return batch;
+}
+
+// blocks on the oldest batch in flight so its staging space can be written again, false if nothing is in flight
+static bool WaitForOldestBatch(UploadManager& uploadManager)
+{
+    UploadBatch* oldestBatch = nullptr;
+    for (std::unique_ptr<UploadBatch>& batch : uploadManager.m_batches)
+    {
+        if (batch->m_submitted && (oldestBatch == nullptr || batch->m_value < oldestBatch->m_value))
+        {
+            oldestBatch = batch.get();
+        }
+    }
+
+    if (oldestBatch == nullptr)
+    {
+        return false;
+    }
+
+    DUCK_DEMO_CPU_SCOPE("UploadManager::WaitForOldestBatch");
+    DUCK_DEMO_VULKAN_ASSERT(vkWaitForFences(Game::Get()->GetVulkanDevice(), 1, &oldestBatch->m_fence, VK_TRUE, UINT64_MAX));
+    UpdateCompleted(uploadManager);
+    return true;
+}
+
+bool Init_UploadManager(UploadManager& uploadManager, const uint32_t queueFamilyIndex, VkQueue queue, const VkDeviceSize stagingSize)
+{
+    Game* game = Game::Get();
+    VkDevice device = game->GetVulkanDevice();
+    VulkanMemoryAllocator& vulkanMemoryAllocator = game->GetVulkanMemoryAllocator();
+
+    uploadManager.m_queue = queue;
+    uploadManager.m_queueFamilyIndex = queueFamilyIndex;
+    uploadManager.m_stagingSize = stagingSize / c_uploadManagerStagingAlignment * c_uploadManagerStagingAlignment;
+
+    VkBufferCreateInfo bufferCreateInfo;
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.pNext = nullptr;
+    bufferCreateInfo.flags = 0;
+    bufferCreateInfo.size = uploadManager.m_stagingSize;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    bufferCreateInfo.queueFamilyIndexCount = 0;
+    bufferCreateInfo.pQueueFamilyIndices = nullptr;
+
+    VkResult result = vkCreateBuffer(device, &bufferCreateInfo, s_allocator, &uploadManager.m_stagingBuffer);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(device, uploadManager.m_stagingBuffer, &memoryRequirements);
+
+    const uint32_t memoryTypeIndex = FindMemoryType_VulkanMemoryAllocator(
+        vulkanMemoryAllocator,
+        memoryRequirements.memoryTypeBits,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (memoryTypeIndex == c_vulkanMemoryInvalidIndex)
+    {
+        DUCK_DEMO_SHOW_ERROR("UploadManager Error", "Could not find host visible memory for the staging buffer");
+        return false;
+    }
+
+    result = Allocate_VulkanMemoryAllocator(vulkanMemoryAllocator, memoryRequirements, memoryTypeIndex, VulkanMemoryTiling_Linear, uploadManager.m_stagingAllocation);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    result = vkBindBufferMemory(device, uploadManager.m_stagingBuffer, uploadManager.m_stagingAllocation.m_deviceMemory, uploadManager.m_stagingAllocation.m_offset);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    return true;
+}
+
+void Free_UploadManager(UploadManager& uploadManager)
+{
+    Game* game = Game::Get();
+    VkDevice device = game->GetVulkanDevice();
+
+    if (uploadManager.m_queue != VK_NULL_HANDLE)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(vkQueueWaitIdle(uploadManager.m_queue));
+    }
+
+    for (std::unique_ptr<UploadBatch>& batch : uploadManager.m_batches)
+    {
+        vkFreeCommandBuffers(device, batch->m_commandPool, 1, &batch->m_commandBuffer);
+        vkDestroyCommandPool(device, batch->m_commandPool, s_allocator);
+        vkDestroyFence(device, batch->m_fence, s_allocator);
+        vkDestroySemaphore(device, batch->m_semaphore, s_allocator);
+    }
+    uploadManager.m_batches.clear();
+    uploadManager.m_recordingBatch = nullptr;
+
+    if (uploadManager.m_stagingBuffer != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(device, uploadManager.m_stagingBuffer, s_allocator);
+        uploadManager.m_stagingBuffer = VK_NULL_HANDLE;
+    }
+
+    Deallocate_VulkanMemoryAllocator(game->GetVulkanMemoryAllocator(), uploadManager.m_stagingAllocation);
+}
+
+// waits until at least granularity bytes of staging are free in one piece and returns how much of size fits there,
+// always a multiple of granularity so copies with fixed size rows never get split inside a row
+static VkDeviceSize AcquireStaging(UploadManager& uploadManager, const VkDeviceSize size, const VkDeviceSize granularity, VkDeviceSize& outStagingOffset)
+{
+    DUCK_DEMO_ASSERT(granularity <= uploadManager.m_stagingSize);
+
+    while (true)
+    {
+        UpdateCompleted(uploadManager);
+
+        const uint64_t stagingWrite = (uploadManager.m_stagingWrite + c_uploadManagerStagingAlignment - 1) / c_uploadManagerStagingAlignment * c_uploadManagerStagingAlignment;
+        const VkDeviceSize stagingOffset = stagingWrite % uploadManager.m_stagingSize;
+        const uint64_t stagingUsed = stagingWrite - uploadManager.m_stagingRead;
+        const VkDeviceSize stagingFree = stagingUsed < uploadManager.m_stagingSize ? uploadManager.m_stagingSize - stagingUsed : 0;
+        const VkDeviceSize stagingToEnd = uploadManager.m_stagingSize - stagingOffset;
+
+        if (stagingFree >= granularity && stagingToEnd < granularity)
+        {
+            // not even one piece fits before the end, skip to the start, the skipped bytes free up with this batch
+            uploadManager.m_stagingWrite = stagingWrite + stagingToEnd;
+            continue;
+        }
+
+        const VkDeviceSize chunkSize = std::min(std::min(size, stagingFree), stagingToEnd) / granularity * granularity;
+        if (chunkSize != 0)
+        {
+            uploadManager.m_stagingWrite = stagingWrite;
+            outStagingOffset = stagingOffset;
+            return chunkSize;
+        }
+
+        // the copies still being recorded hold on to staging too, they have to go out before anything can free up
+        if (uploadManager.m_recordingBatch != nullptr)
+        {
+            Submit_UploadManager(uploadManager);
+        }
+        if (!WaitForOldestBatch(uploadManager))
+        {
+            // can't happen unless the positions got out of sync
+            DUCK_DEMO_ASSERT(false);
+            return 0;
+        }
+    }
+}
+
+static void CopyToStaging(UploadManager& uploadManager, const VkDeviceSize stagingOffset, const void* data, const VkDeviceSize dataSize)
+{
+    memcpy(uploadManager.m_stagingAllocation.m_mappedData + stagingOffset, data, static_cast<size_t>(dataSize));
+    Flush_VulkanMemoryAllocator(Game::Get()->GetVulkanMemoryAllocator(), uploadManager.m_stagingAllocation, stagingOffset, dataSize);
+    uploadManager.m_stagingWrite += dataSize;
+}
+
+static uint64_t GetLastValue(UploadManager& uploadManager)
+{
+    // an empty upload has nothing to wait for, the last submitted value is as good as any
+    return uploadManager.m_recordingBatch != nullptr ? uploadManager.m_recordingBatch->m_value : uploadManager.m_nextValue - 1;
+}
+
+uint64_t UploadBuffer_UploadManager(UploadManager& uploadManager, VkBuffer dstBuffer, const VkDeviceSize dstOffset, const void* data, const VkDeviceSize dataSize)
+{
+    DUCK_DEMO_CPU_SCOPE("UploadManager::UploadBuffer");
+    DUCK_DEMO_ASSERT(uploadManager.m_stagingAllocation.m_mappedData != nullptr);
+
+    const uint8_t* srcData = static_cast<const uint8_t*>(data);
+    VkDeviceSize uploadedSize = 0;
+    while (uploadedSize < dataSize)
+    {
+        VkDeviceSize stagingOffset = 0;
+        const VkDeviceSize chunkSize = AcquireStaging(uploadManager, dataSize - uploadedSize, 1, stagingOffset);
+        if (chunkSize == 0)
+        {
+            break;
+        }
+
+        UploadBatch* batch = GetRecordingBatch(uploadManager);
+        CopyToStaging(uploadManager, stagingOffset, srcData + uploadedSize, chunkSize);
+
+        VkBufferCopy bufferCopy;
+        bufferCopy.srcOffset = stagingOffset;
+        bufferCopy.dstOffset = dstOffset + uploadedSize;
+        bufferCopy.size = chunkSize;
+        vkCmdCopyBuffer(batch->m_commandBuffer, uploadManager.m_stagingBuffer, dstBuffer, 1, &bufferCopy);
+
+        uploadedSize += chunkSize;
+    }
+
+    return GetLastValue(uploadManager);
+}
+
+uint64_t UploadImage_UploadManager(UploadManager& uploadManager, VkImage dstImage, const uint32_t width, const uint32_t height, const uint32_t blockSize, const uint32_t blockExtent, const uint32_t levelCount, const void* data)
+{
+    DUCK_DEMO_CPU_SCOPE("UploadManager::UploadImage");
+    DUCK_DEMO_ASSERT(uploadManager.m_stagingAllocation.m_mappedData != nullptr);
+
+    VkImageSubresourceRange imageSubresourceRange;
+    imageSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageSubresourceRange.baseMipLevel = 0;
+    imageSubresourceRange.levelCount = levelCount;
+    imageSubresourceRange.baseArrayLayer = 0;
+    imageSubresourceRange.layerCount = 1;
+
+    VkImageMemoryBarrier imageMemoryBarrier;
+    imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageMemoryBarrier.pNext = nullptr;
+    imageMemoryBarrier.srcAccessMask = 0;
+    imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.image = dstImage;
+    imageMemoryBarrier.subresourceRange = imageSubresourceRange;
+    vkCmdPipelineBarrier(GetRecordingBatch(uploadManager)->m_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+
+    const uint8_t* srcData = static_cast<const uint8_t*>(data);
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        const uint32_t levelWidth = GetLevelSize_MipChain(width, level);
+        const uint32_t levelHeight = GetLevelSize_MipChain(height, level);
+        const uint32_t levelRows = (levelHeight + blockExtent - 1) / blockExtent;
+
+        // split on whole rows of blocks so every copy is a plain rectangle of the image
+        const VkDeviceSize rowSize = static_cast<VkDeviceSize>((levelWidth + blockExtent - 1) / blockExtent) * blockSize;
+        uint32_t uploadedRows = 0;
+        while (uploadedRows < levelRows)
+        {
+            VkDeviceSize stagingOffset = 0;
+            const VkDeviceSize chunkSize = AcquireStaging(uploadManager, rowSize * (levelRows - uploadedRows), rowSize, stagingOffset);
+            if (chunkSize == 0)
+            {
+                break;
+            }
+            const uint32_t chunkRows = static_cast<uint32_t>(chunkSize / rowSize);
+
+            // staging may have been submitted while waiting for space, the copy goes into whichever batch records now
+            UploadBatch* batch = GetRecordingBatch(uploadManager);
+            CopyToStaging(uploadManager, stagingOffset, srcData + rowSize * uploadedRows, chunkSize);
+
+            VkBufferImageCopy bufferImageCopy;
+            bufferImageCopy.bufferOffset = stagingOffset;
+            bufferImageCopy.bufferRowLength = 0;
+            bufferImageCopy.bufferImageHeight = 0;
+            bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            bufferImageCopy.imageSubresource.mipLevel = level;
+            bufferImageCopy.imageSubresource.baseArrayLayer = 0;
+            bufferImageCopy.imageSubresource.layerCount = 1;
+            bufferImageCopy.imageOffset.x = 0;
+            // compressed copies are in texels too, the last row of blocks can hang over the edge of the level
+            bufferImageCopy.imageOffset.y = static_cast<int32_t>(uploadedRows * blockExtent);
+            bufferImageCopy.imageOffset.z = 0;
+            bufferImageCopy.imageExtent.width = levelWidth;
+            bufferImageCopy.imageExtent.height = std::min(chunkRows * blockExtent, levelHeight - uploadedRows * blockExtent);
+            bufferImageCopy.imageExtent.depth = 1;
+            vkCmdCopyBufferToImage(batch->m_commandBuffer, uploadManager.m_stagingBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &bufferImageCopy);
+
+            uploadedRows += chunkRows;
+        }
+
+        srcData += rowSize * levelRows;
+    }
+
+    // the transfer queue may not know the shader stages, the semaphore the frame waits on orders the reads after this
+    imageMemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageMemoryBarrier.dstAccessMask = 0;
+    imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    vkCmdPipelineBarrier(GetRecordingBatch(uploadManager)->m_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+
+    return GetLastValue(uploadManager);
+}
+
+uint64_t Submit_UploadManager(UploadManager& uploadManager)
+{
+    UploadBatch* batch = uploadManager.m_recordingBatch;
+    if (batch == nullptr)
+    {
+        return uploadManager.m_nextValue - 1;
+    }
+
+    DUCK_DEMO_CPU_SCOPE("UploadManager::Submit");
+
+    DUCK_DEMO_VULKAN_ASSERT(vkEndCommandBuffer(batch->m_commandBuffer));
+
+    VkSubmitInfo submitInfo;
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = nullptr;
+    submitInfo.waitSemaphoreCount = 0;
+    submitInfo.pWaitSemaphores = nullptr;
+    submitInfo.pWaitDstStageMask = nullptr;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch->m_commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &batch->m_semaphore;
+    DUCK_DEMO_VULKAN_ASSERT(vkQueueSubmit(uploadManager.m_queue, 1, &submitInfo, batch->m_fence));
+
+    batch->m_stagingEnd = uploadManager.m_stagingWrite;
+    batch->m_submitted = true;
+    batch->m_renderWaitPending = true;
+
+    uploadManager.m_recordingBatch = nullptr;
+    ++uploadManager.m_nextValue;
+
+    return batch->m_value;
+}
+
+bool IsComplete_UploadManager(UploadManager& uploadManager, const uint64_t value)
+{
+    if (value <= uploadManager.m_completedValue)
+    {
+        return true;
+    }
+
+    UpdateCompleted(uploadManager);
+    return value <= uploadManager.m_completedValue;
+}
+
+void Wait_UploadManager(UploadManager& uploadManager, const uint64_t value)
+{
+    if (uploadManager.m_recordingBatch != nullptr && uploadManager.m_recordingBatch->m_value <= value)
+    {
+        Submit_UploadManager(uploadManager);
+    }
+
+    while (!IsComplete_UploadManager(uploadManager, value))
+    {
+        if (!WaitForOldestBatch(uploadManager))
+        {
+            DUCK_DEMO_ASSERT(false);
+            break;
+        }
+    }
+}
+
+void AddRenderWaits_UploadManager(UploadManager& uploadManager, const uint64_t frameNumber)
+{
+    DUCK_DEMO_ASSERT(frameNumber != 0);
+
+    // everything recorded during the frame goes out together right before the frame's own submit
+    Submit_UploadManager(uploadManager);
+
+    for (std::unique_ptr<UploadBatch>& batch : uploadManager.m_batches)
+    {
+        if (batch->m_renderWaitPending)
+        {
+            Game::Get()->AddRenderWaitSemaphore(batch->m_semaphore, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+            batch->m_renderWaitPending = false;
+            batch->m_renderWaitFrameNumber = frameNumber;
+        }
+    }
+}
+
+void RetireFrame_UploadManager(UploadManager& uploadManager, const uint64_t frameNumber)
+{
+    for (std::unique_ptr<UploadBatch>& batch : uploadManager.m_batches)
+    {
+        if (batch->m_renderWaitFrameNumber != 0 && batch->m_renderWaitFrameNumber <= frameNumber)
+        {
+            batch->m_renderWaitFrameNumber = 0;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "VulkanMemoryAllocator.h"
+
+// bigger uploads are split up and go out in several batches, a big model can be a couple of these
+constexpr VkDeviceSize c_uploadManagerStagingSize = 32u * 1024u * 1024u;
+// staging offsets are kept aligned so image copies can use them too
+constexpr VkDeviceSize c_uploadManagerStagingAlignment = 16u;
+
+// one submit worth of copies
+struct UploadBatch
+{
+    VkCommandPool m_commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+    VkFence m_fence = VK_NULL_HANDLE;
+    // the next graphics submit waits on this so nothing reads the copies before they are done
+    VkSemaphore m_semaphore = VK_NULL_HANDLE;
+    uint64_t m_value = 0;
+    // staging position the batch's copies end at, space before it is free again once the fence signals
+    uint64_t m_stagingEnd = 0;
+    // GameTimer frame count of the graphics submit that waited on m_semaphore
+    uint64_t m_renderWaitFrameNumber = 0;
+    bool m_submitted = false;
+    bool m_renderWaitPending = false;
+};
+
+struct UploadManager
+{
+    VkQueue m_queue = VK_NULL_HANDLE;
+    uint32_t m_queueFamilyIndex = 0;
+    VkBuffer m_stagingBuffer = VK_NULL_HANDLE;
+    VulkanAllocation m_stagingAllocation;
+    VkDeviceSize m_stagingSize = 0;
+    // positions only ever grow, the offset in the staging buffer is the position modulo its size
+    uint64_t m_stagingWrite = 0;
+    uint64_t m_stagingRead = 0;
+    // grows whenever every batch is still busy, which only really happens while loading
+    std::vector<std::unique_ptr<UploadBatch>> m_batches;
+    UploadBatch* m_recordingBatch = nullptr;
+    // values are handed out in submit order and the queue finishes them in that order too
+    uint64_t m_nextValue = 1;
+    uint64_t m_completedValue = 0;
+};
+
+bool Init_UploadManager(UploadManager& uploadManager, const uint32_t queueFamilyIndex, VkQueue queue, const VkDeviceSize stagingSize);
+void Free_UploadManager(UploadManager& uploadManager);
+
+// data is copied into staging right away so it can be freed as soon as this returns, the returned value completes with the copy
+uint64_t UploadBuffer_UploadManager(UploadManager& uploadManager, VkBuffer dstBuffer, const VkDeviceSize dstOffset, const void* data, const VkDeviceSize dataSize);
+// leaves the first levelCount levels in SHADER_READ_ONLY_OPTIMAL, data is those levels laid out like MipChain.h made of
+// blockExtent x blockExtent blocks of blockSize bytes, uncompressed formats are 1x1 blocks of one texel
+uint64_t UploadImage_UploadManager(UploadManager& uploadManager, VkImage dstImage, const uint32_t width, const uint32_t height, const uint32_t blockSize, const uint32_t blockExtent, const uint32_t levelCount, const void* data);
+// sends everything recorded so far in one submit, returns the value of the last upload
+uint64_t Submit_UploadManager(UploadManager& uploadManager);
+bool IsComplete_UploadManager(UploadManager& uploadManager, const uint64_t value);
+// submits first if the value is still being recorded
+void Wait_UploadManager(UploadManager& uploadManager, const uint64_t value);
+
+// the graphics submit of frameNumber has to wait on every semaphore added here
+void AddRenderWaits_UploadManager(UploadManager& uploadManager, const uint64_t frameNumber);
+// once a frame is retired its waits are done and the batches it waited on can be reused
+void RetireFrame_UploadManager(UploadManager& uploadManager, const uint64_t frameNumber);
@@ -0,0 +1,90 @@
+#include "VertexInputState.h"
+
+#include "meshloader/MeshLoader.h"
+
+#include "DuckDemoUtils.h"
+
+static VkFormat GetPositionFormat(const MeshLoader::PositionFormat format)
+{
+    switch (format)
+    {
+    case MeshLoader::PositionFormat_Float16:
+        return VK_FORMAT_R16G16B16A16_SFLOAT;
+    case MeshLoader::PositionFormat_Unorm16:
+        return VK_FORMAT_R16G16B16A16_UNORM;
+    case MeshLoader::PositionFormat_Float32:
+    default:
+        return VK_FORMAT_R32G32B32_SFLOAT;
+    }
+}
+
+static VkFormat GetDirectionFormat(const MeshLoader::DirectionFormat format)
+{
+    return format == MeshLoader::DirectionFormat_Octahedral16 ? VK_FORMAT_R16G16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
+}
+
+static VkFormat GetTextureFormat(const MeshLoader::TextureFormat format)
+{
+    return format == MeshLoader::TextureFormat_Unorm16 ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R32G32_SFLOAT;
+}
+
+static void AddAttribute(VertexInputState& vertexInputState, const uint32_t binding, const VertexInputLocation location, const VkFormat format, const uint32_t offset)
+{
+    DUCK_DEMO_ASSERT(vertexInputState.m_attributeDescriptionCount < vertexInputState.m_attributeDescriptions.size());
+
+    VkVertexInputAttributeDescription& attributeDescription = vertexInputState.m_attributeDescriptions[vertexInputState.m_attributeDescriptionCount++];
+    attributeDescription.location = location;
+    attributeDescription.binding = binding;
+    attributeDescription.format = format;
+    attributeDescription.offset = offset;
+}
+
+void Init_VertexInputState(VertexInputState& vertexInputState, const MeshLoader::VertexFormat& vertexFormat)
+{
+    const MeshLoader::VertexLayout layout = MeshLoader::Loader::GetVertexLayout(vertexFormat);
+
+    // the shader always reads a normal
+    DUCK_DEMO_ASSERT(layout.normalOffset != MeshLoader::c_vertexAttributeAbsent);
+
+    vertexInputState.m_attributeDescriptionCount = 0;
+    AddAttribute(vertexInputState, c_vertexInputVertexBinding, VertexInputLocation_Position, GetPositionFormat(vertexFormat.position), layout.positionOffset);
+    AddAttribute(vertexInputState, c_vertexInputVertexBinding, VertexInputLocation_Normal, GetDirectionFormat(vertexFormat.normal), layout.normalOffset);
+    AddAttribute(vertexInputState, c_vertexInputVertexBinding, VertexInputLocation_Texture, GetTextureFormat(vertexFormat.texture), layout.textureOffset);
+    if (layout.tangentOffset != MeshLoader::c_vertexAttributeAbsent)
+    {
+        AddAttribute(vertexInputState, c_vertexInputVertexBinding, VertexInputLocation_Tangent, GetDirectionFormat(vertexFormat.tangent), layout.tangentOffset);
+    }
+
+    vertexInputState.m_bindingDescriptions[0].binding = c_vertexInputVertexBinding;
+    vertexInputState.m_bindingDescriptions[0].stride = layout.stride;
+    vertexInputState.m_bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    vertexInputState.m_bindingDescriptionCount = 1;
+}
+
+void AddInstanceBinding_VertexInputState(VertexInputState& vertexInputState, const uint32_t stride)
+{
+    DUCK_DEMO_ASSERT(vertexInputState.m_bindingDescriptionCount < vertexInputState.m_bindingDescriptions.size());
+
+    VkVertexInputBindingDescription& bindingDescription = vertexInputState.m_bindingDescriptions[vertexInputState.m_bindingDescriptionCount++];
+    bindingDescription.binding = c_vertexInputInstanceBinding;
+    bindingDescription.stride = stride;
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+}
+
+void AddInstanceAttribute_VertexInputState(VertexInputState& vertexInputState, const VertexInputLocation location, const VkFormat format, const uint32_t offset)
+{
+    AddAttribute(vertexInputState, c_vertexInputInstanceBinding, location, format, offset);
+}
+
+const VkPipelineVertexInputStateCreateInfo* GetInfo_VertexInputState(VertexInputState& vertexInputState)
+{
+    vertexInputState.m_createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputState.m_createInfo.pNext = nullptr;
+    vertexInputState.m_createInfo.flags = 0;
+    vertexInputState.m_createInfo.vertexBindingDescriptionCount = vertexInputState.m_bindingDescriptionCount;
+    vertexInputState.m_createInfo.pVertexBindingDescriptions = vertexInputState.m_bindingDescriptions.data();
+    vertexInputState.m_createInfo.vertexAttributeDescriptionCount = vertexInputState.m_attributeDescriptionCount;
+    vertexInputState.m_createInfo.pVertexAttributeDescriptions = vertexInputState.m_attributeDescriptions.data();
+
+    return &vertexInputState.m_createInfo;
+}
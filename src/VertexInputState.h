@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+
+#include <vulkan/vulkan.h>
+
+#include "meshloader/VertexFormat.h"
+
+// input locations of data/shader_src/MeshShader.vert and data/shader_src/WaterShader.vert
+enum VertexInputLocation
+{
+    VertexInputLocation_Position = 0,
+    VertexInputLocation_Normal,
+    VertexInputLocation_Texture,
+    // not read by any shader yet, only bound when the format keeps tangents
+    VertexInputLocation_Tangent,
+    // per instance, see WaterPatch
+    VertexInputLocation_PatchOriginSize,
+    VertexInputLocation_PatchUvOriginScale,
+    VertexInputLocation_PatchMorphRange,
+};
+
+constexpr uint32_t c_vertexInputVertexBinding = 0;
+constexpr uint32_t c_vertexInputInstanceBinding = 1;
+
+// binding and attributes for vertices packed with MeshLoader::Loader::PackVertices, plus optionally per instance data
+struct VertexInputState
+{
+    std::array<VkVertexInputBindingDescription, 2> m_bindingDescriptions;
+    uint32_t m_bindingDescriptionCount = 0;
+    std::array<VkVertexInputAttributeDescription, 8> m_attributeDescriptions;
+    uint32_t m_attributeDescriptionCount = 0;
+    VkPipelineVertexInputStateCreateInfo m_createInfo;
+};
+
+void Init_VertexInputState(VertexInputState& vertexInputState, const MeshLoader::VertexFormat& vertexFormat);
+// adds c_vertexInputInstanceBinding, stepped once per instance
+void AddInstanceBinding_VertexInputState(VertexInputState& vertexInputState, const uint32_t stride);
+void AddInstanceAttribute_VertexInputState(VertexInputState& vertexInputState, const VertexInputLocation location, const VkFormat format, const uint32_t offset);
+// points into vertexInputState so it's only valid while that stays where it is
+const VkPipelineVertexInputStateCreateInfo* GetInfo_VertexInputState(VertexInputState& vertexInputState);
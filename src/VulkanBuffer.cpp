@@ -5,7 +5,7 @@
 
 void VulkanBuffer::Reset()
 {
-    if (m_buffer == VK_NULL_HANDLE && m_deviceMemory == VK_NULL_HANDLE)
+    if (m_buffer == VK_NULL_HANDLE && m_allocation.m_deviceMemory == VK_NULL_HANDLE)
     {
         return;
     }
@@ -32,9 +32,5 @@ void VulkanBuffer::Reset()
         m_buffer = VK_NULL_HANDLE;
     }
 
-    if (m_deviceMemory != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(vulkanDevice, m_deviceMemory, s_allocator);
-        m_deviceMemory = VK_NULL_HANDLE;
-    }
+    Deallocate_VulkanMemoryAllocator(game->GetVulkanMemoryAllocator(), m_allocation);
 }
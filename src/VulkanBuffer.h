@@ -2,6 +2,8 @@
 
 #include <vulkan/vulkan.h>
 
+#include "VulkanMemoryAllocator.h"
+
 struct VulkanBuffer
 {
     ~VulkanBuffer()
@@ -11,6 +13,6 @@ struct VulkanBuffer
     void Reset();
 
 	VkBuffer m_buffer = VK_NULL_HANDLE;
-	VkDeviceMemory m_deviceMemory = VK_NULL_HANDLE;
+	VulkanAllocation m_allocation;
 	VkDeviceSize m_deviceSize = 0;
 };
@@ -0,0 +1,666 @@
+#include "VulkanMemoryAllocator.h"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif // _MSC_VER
+
+#include "imgui.h"
+
+#include "DuckDemoUtils.h"
+#include "Game.h"
+
+// big enough that the duck scene fits in a page or two per memory type, small heaps (like a 256MB bar) get an eighth of the heap instead
+constexpr VkDeviceSize c_vulkanMemoryPageSize = 64ull * 1024ull * 1024ull;
+
+static uint32_t BitScanReverse64(const uint64_t value)
+{
+    DUCK_DEMO_ASSERT(value != 0);
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif // _MSC_VER
+}
+
+static uint32_t BitScanForward64(const uint64_t value)
+{
+    DUCK_DEMO_ASSERT(value != 0);
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif // _MSC_VER
+}
+
+static VkDeviceSize AlignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+{
+    return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+}
+
+static void MapSize(const VkDeviceSize size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+    if (size < (1ull << c_vulkanMemoryFirstLevelShift))
+    {
+        firstLevel = 0;
+        secondLevel = static_cast<uint32_t>(size >> (c_vulkanMemoryFirstLevelShift - c_vulkanMemorySecondLevelLog2));
+        return;
+    }
+
+    const uint32_t log2 = BitScanReverse64(size);
+    firstLevel = log2 - c_vulkanMemoryFirstLevelShift + 1;
+    secondLevel = static_cast<uint32_t>(size >> (log2 - c_vulkanMemorySecondLevelLog2)) - c_vulkanMemorySecondLevelCount;
+}
+
+// rounding up to the next bucket means whatever block the search finds is guaranteed to be big enough
+static VkDeviceSize RoundUpForSearch(const VkDeviceSize size)
+{
+    if (size < (1ull << c_vulkanMemoryFirstLevelShift))
+    {
+        return size + (1ull << (c_vulkanMemoryFirstLevelShift - c_vulkanMemorySecondLevelLog2)) - 1;
+    }
+
+    return size + (1ull << (BitScanReverse64(size) - c_vulkanMemorySecondLevelLog2)) - 1;
+}
+
+static VkDeviceSize GetPageSize(const VulkanMemoryAllocator& vulkanMemoryAllocator, const uint32_t memoryTypeIndex)
+{
+    const uint32_t heapIndex = vulkanMemoryAllocator.m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+    return std::min(c_vulkanMemoryPageSize, vulkanMemoryAllocator.m_memoryProperties.memoryHeaps[heapIndex].size / 8);
+}
+
+static bool IsHostVisible(const VulkanMemoryAllocator& vulkanMemoryAllocator, const uint32_t memoryTypeIndex)
+{
+    return (vulkanMemoryAllocator.m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+}
+
+static uint32_t AcquireBlock(VulkanMemoryPage& page)
+{
+    if (!page.m_unusedBlocks.empty())
+    {
+        const uint32_t blockIndex = page.m_unusedBlocks.back();
+        page.m_unusedBlocks.pop_back();
+        page.m_blocks[blockIndex] = VulkanMemoryBlock();
+        return blockIndex;
+    }
+
+    page.m_blocks.emplace_back();
+    return static_cast<uint32_t>(page.m_blocks.size() - 1);
+}
+
+static void InsertFreeBlock(VulkanMemoryPage& page, const uint32_t blockIndex)
+{
+    VulkanMemoryBlock& block = page.m_blocks[blockIndex];
+
+    uint32_t firstLevel;
+    uint32_t secondLevel;
+    MapSize(block.m_size, firstLevel, secondLevel);
+
+    uint32_t& freeHead = page.m_freeHeads[firstLevel * c_vulkanMemorySecondLevelCount + secondLevel];
+    block.m_free = true;
+    block.m_prevFree = c_vulkanMemoryInvalidIndex;
+    block.m_nextFree = freeHead;
+    if (freeHead != c_vulkanMemoryInvalidIndex)
+    {
+        page.m_blocks[freeHead].m_prevFree = blockIndex;
+    }
+    freeHead = blockIndex;
+
+    page.m_firstLevelBitmap |= 1ull << firstLevel;
+    page.m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+    ++page.m_freeBlockCount;
+}
+
+static void RemoveFreeBlock(VulkanMemoryPage& page, const uint32_t blockIndex)
+{
+    VulkanMemoryBlock& block = page.m_blocks[blockIndex];
+    DUCK_DEMO_ASSERT(block.m_free);
+
+    uint32_t firstLevel;
+    uint32_t secondLevel;
+    MapSize(block.m_size, firstLevel, secondLevel);
+
+    uint32_t& freeHead = page.m_freeHeads[firstLevel * c_vulkanMemorySecondLevelCount + secondLevel];
+    if (block.m_prevFree != c_vulkanMemoryInvalidIndex)
+    {
+        page.m_blocks[block.m_prevFree].m_nextFree = block.m_nextFree;
+    }
+    else
+    {
+        freeHead = block.m_nextFree;
+    }
+
+    if (block.m_nextFree != c_vulkanMemoryInvalidIndex)
+    {
+        page.m_blocks[block.m_nextFree].m_prevFree = block.m_prevFree;
+    }
+
+    if (freeHead == c_vulkanMemoryInvalidIndex)
+    {
+        page.m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+        if (page.m_secondLevelBitmaps[firstLevel] == 0)
+        {
+            page.m_firstLevelBitmap &= ~(1ull << firstLevel);
+        }
+    }
+
+    block.m_free = false;
+    block.m_prevFree = c_vulkanMemoryInvalidIndex;
+    block.m_nextFree = c_vulkanMemoryInvalidIndex;
+    --page.m_freeBlockCount;
+}
+
+static uint32_t FindFreeBlock(const VulkanMemoryPage& page, const VkDeviceSize size)
+{
+    uint32_t firstLevel;
+    uint32_t secondLevel;
+    MapSize(RoundUpForSearch(size), firstLevel, secondLevel);
+    if (firstLevel >= c_vulkanMemoryFirstLevelCount)
+    {
+        return c_vulkanMemoryInvalidIndex;
+    }
+
+    uint32_t secondLevelBitmap = page.m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+    if (secondLevelBitmap == 0)
+    {
+        // nothing left in this power of two, take the smallest bucket of the next one that has anything
+        const uint64_t firstLevelBitmap = firstLevel + 1 < 64 ? page.m_firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+        if (firstLevelBitmap == 0)
+        {
+            return c_vulkanMemoryInvalidIndex;
+        }
+
+        firstLevel = BitScanForward64(firstLevelBitmap);
+        secondLevelBitmap = page.m_secondLevelBitmaps[firstLevel];
+    }
+
+    secondLevel = BitScanForward64(secondLevelBitmap);
+    return page.m_freeHeads[firstLevel * c_vulkanMemorySecondLevelCount + secondLevel];
+}
+
+static uint32_t AllocateFromPage(VulkanMemoryPage& page, const VkDeviceSize size, const VkDeviceSize alignment)
+{
+    // asking for the worst case padding up front keeps the search O(1) at the cost of sometimes skipping a block that would have fit
+    const uint32_t blockIndex = FindFreeBlock(page, size + alignment - 1);
+    if (blockIndex == c_vulkanMemoryInvalidIndex)
+    {
+        return c_vulkanMemoryInvalidIndex;
+    }
+
+    RemoveFreeBlock(page, blockIndex);
+
+    const VkDeviceSize blockOffset = page.m_blocks[blockIndex].m_offset;
+    const VkDeviceSize padding = AlignUp(blockOffset, alignment) - blockOffset;
+    if (padding > 0)
+    {
+        const uint32_t paddingIndex = AcquireBlock(page);
+        VulkanMemoryBlock& paddingBlock = page.m_blocks[paddingIndex];
+        VulkanMemoryBlock& block = page.m_blocks[blockIndex];
+
+        paddingBlock.m_offset = block.m_offset;
+        paddingBlock.m_size = padding;
+        paddingBlock.m_prevPhysical = block.m_prevPhysical;
+        paddingBlock.m_nextPhysical = blockIndex;
+        if (block.m_prevPhysical != c_vulkanMemoryInvalidIndex)
+        {
+            page.m_blocks[block.m_prevPhysical].m_nextPhysical = paddingIndex;
+        }
+
+        block.m_prevPhysical = paddingIndex;
+        block.m_offset += padding;
+        block.m_size -= padding;
+
+        InsertFreeBlock(page, paddingIndex);
+    }
+
+    const VkDeviceSize remainder = page.m_blocks[blockIndex].m_size - size;
+    if (remainder > 0)
+    {
+        const uint32_t remainderIndex = AcquireBlock(page);
+        VulkanMemoryBlock& remainderBlock = page.m_blocks[remainderIndex];
+        VulkanMemoryBlock& block = page.m_blocks[blockIndex];
+
+        remainderBlock.m_offset = block.m_offset + size;
+        remainderBlock.m_size = remainder;
+        remainderBlock.m_prevPhysical = blockIndex;
+        remainderBlock.m_nextPhysical = block.m_nextPhysical;
+        if (block.m_nextPhysical != c_vulkanMemoryInvalidIndex)
+        {
+            page.m_blocks[block.m_nextPhysical].m_prevPhysical = remainderIndex;
+        }
+
+        block.m_nextPhysical = remainderIndex;
+        block.m_size = size;
+
+        InsertFreeBlock(page, remainderIndex);
+    }
+
+    page.m_usedBytes += size;
+    ++page.m_allocationCount;
+
+    return blockIndex;
+}
+
+static void FreeFromPage(VulkanMemoryPage& page, uint32_t blockIndex)
+{
+    DUCK_DEMO_ASSERT(!page.m_blocks[blockIndex].m_free);
+
+    page.m_usedBytes -= page.m_blocks[blockIndex].m_size;
+    --page.m_allocationCount;
+
+    // free blocks never sit next to each other so there is at most one merge on each side
+    const uint32_t prevIndex = page.m_blocks[blockIndex].m_prevPhysical;
+    if (prevIndex != c_vulkanMemoryInvalidIndex && page.m_blocks[prevIndex].m_free)
+    {
+        RemoveFreeBlock(page, prevIndex);
+
+        VulkanMemoryBlock& prevBlock = page.m_blocks[prevIndex];
+        const VulkanMemoryBlock& block = page.m_blocks[blockIndex];
+        prevBlock.m_size += block.m_size;
+        prevBlock.m_nextPhysical = block.m_nextPhysical;
+        if (block.m_nextPhysical != c_vulkanMemoryInvalidIndex)
+        {
+            page.m_blocks[block.m_nextPhysical].m_prevPhysical = prevIndex;
+        }
+
+        page.m_unusedBlocks.push_back(blockIndex);
+        blockIndex = prevIndex;
+    }
+
+    const uint32_t nextIndex = page.m_blocks[blockIndex].m_nextPhysical;
+    if (nextIndex != c_vulkanMemoryInvalidIndex && page.m_blocks[nextIndex].m_free)
+    {
+        RemoveFreeBlock(page, nextIndex);
+
+        VulkanMemoryBlock& block = page.m_blocks[blockIndex];
+        const VulkanMemoryBlock& nextBlock = page.m_blocks[nextIndex];
+        block.m_size += nextBlock.m_size;
+        block.m_nextPhysical = nextBlock.m_nextPhysical;
+        if (nextBlock.m_nextPhysical != c_vulkanMemoryInvalidIndex)
+        {
+            page.m_blocks[nextBlock.m_nextPhysical].m_prevPhysical = blockIndex;
+        }
+
+        page.m_unusedBlocks.push_back(nextIndex);
+    }
+
+    InsertFreeBlock(page, blockIndex);
+}
+
+static VkDeviceSize GetLargestFreeBlock(const VulkanMemoryPage& page)
+{
+    if (page.m_firstLevelBitmap == 0)
+    {
+        return 0;
+    }
+
+    // only the highest bucket can hold the largest block but the blocks inside a bucket aren't sorted
+    const uint32_t firstLevel = BitScanReverse64(page.m_firstLevelBitmap);
+    const uint32_t secondLevel = BitScanReverse64(page.m_secondLevelBitmaps[firstLevel]);
+
+    VkDeviceSize largestFreeBlock = 0;
+    for (uint32_t blockIndex = page.m_freeHeads[firstLevel * c_vulkanMemorySecondLevelCount + secondLevel];
+        blockIndex != c_vulkanMemoryInvalidIndex;
+        blockIndex = page.m_blocks[blockIndex].m_nextFree)
+    {
+        largestFreeBlock = std::max(largestFreeBlock, page.m_blocks[blockIndex].m_size);
+    }
+
+    return largestFreeBlock;
+}
+
+static VkResult AllocateDeviceMemory(VulkanMemoryAllocator& vulkanMemoryAllocator, const VkDeviceSize size, const uint32_t memoryTypeIndex, VkDeviceMemory& outDeviceMemory, uint8_t*& outMappedData)
+{
+    const VulkanMemoryAllocatorStats stats = GetStats_VulkanMemoryAllocator(vulkanMemoryAllocator);
+    if (stats.m_deviceMemoryCount >= vulkanMemoryAllocator.m_maxMemoryAllocationCount)
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "VulkanMemoryAllocator: %u device memory allocations is over the device limit of %u", stats.m_deviceMemoryCount + 1, vulkanMemoryAllocator.m_maxMemoryAllocationCount);
+    }
+
+    VkMemoryAllocateInfo memoryAllocateInfo;
+    memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memoryAllocateInfo.pNext = nullptr;
+    memoryAllocateInfo.allocationSize = size;
+    memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+
+    VkResult result = vkAllocateMemory(Game::Get()->GetVulkanDevice(), &memoryAllocateInfo, s_allocator, &outDeviceMemory);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return result;
+    }
+
+    outMappedData = nullptr;
+    if (IsHostVisible(vulkanMemoryAllocator, memoryTypeIndex))
+    {
+        // a VkDeviceMemory can only be mapped once so it's mapped for its whole life and shared by everything in it
+        result = vkMapMemory(Game::Get()->GetVulkanDevice(), outDeviceMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&outMappedData));
+        if (result != VK_SUCCESS)
+        {
+            DUCK_DEMO_VULKAN_ASSERT(result);
+            vkFreeMemory(Game::Get()->GetVulkanDevice(), outDeviceMemory, s_allocator);
+            outDeviceMemory = VK_NULL_HANDLE;
+            return result;
+        }
+    }
+
+    return VK_SUCCESS;
+}
+
+static uint32_t CreatePage(VulkanMemoryAllocator& vulkanMemoryAllocator, const uint32_t memoryTypeIndex)
+{
+    std::unique_ptr<VulkanMemoryPage> page(new VulkanMemoryPage());
+    page->m_size = GetPageSize(vulkanMemoryAllocator, memoryTypeIndex);
+    page->m_memoryTypeIndex = memoryTypeIndex;
+    page->m_freeHeads.fill(c_vulkanMemoryInvalidIndex);
+    page->m_secondLevelBitmaps.fill(0);
+
+    if (AllocateDeviceMemory(vulkanMemoryAllocator, page->m_size, memoryTypeIndex, page->m_deviceMemory, page->m_mappedData) != VK_SUCCESS)
+    {
+        return c_vulkanMemoryInvalidIndex;
+    }
+
+    const uint32_t blockIndex = AcquireBlock(*page);
+    page->m_blocks[blockIndex].m_offset = 0;
+    page->m_blocks[blockIndex].m_size = page->m_size;
+    InsertFreeBlock(*page, blockIndex);
+
+    for (uint32_t i = 0; i < vulkanMemoryAllocator.m_pages.size(); ++i)
+    {
+        if (vulkanMemoryAllocator.m_pages[i] == nullptr)
+        {
+            vulkanMemoryAllocator.m_pages[i] = std::move(page);
+            return i;
+        }
+    }
+
+    vulkanMemoryAllocator.m_pages.push_back(std::move(page));
+    return static_cast<uint32_t>(vulkanMemoryAllocator.m_pages.size() - 1);
+}
+
+static void DestroyPage(VulkanMemoryAllocator& vulkanMemoryAllocator, const uint32_t pageIndex)
+{
+    std::unique_ptr<VulkanMemoryPage>& page = vulkanMemoryAllocator.m_pages[pageIndex];
+    if (page->m_allocationCount != 0)
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "VulkanMemoryAllocator: freeing a page that still has %u allocations in it", page->m_allocationCount);
+    }
+
+    // freeing the memory unmaps it
+    vkFreeMemory(Game::Get()->GetVulkanDevice(), page->m_deviceMemory, s_allocator);
+    page.reset();
+}
+
+bool Init_VulkanMemoryAllocator(VulkanMemoryAllocator& vulkanMemoryAllocator)
+{
+    VkPhysicalDevice physicalDevice = Game::Get()->GetVulkanPhysicalDevice();
+
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &vulkanMemoryAllocator.m_memoryProperties);
+
+    vulkanMemoryAllocator.m_bufferImageGranularity = std::max<VkDeviceSize>(physicalDeviceProperties.limits.bufferImageGranularity, 1);
+    vulkanMemoryAllocator.m_nonCoherentAtomSize = std::max<VkDeviceSize>(physicalDeviceProperties.limits.nonCoherentAtomSize, 1);
+    vulkanMemoryAllocator.m_maxMemoryAllocationCount = physicalDeviceProperties.limits.maxMemoryAllocationCount;
+
+    return true;
+}
+
+void Free_VulkanMemoryAllocator(VulkanMemoryAllocator& vulkanMemoryAllocator)
+{
+    for (uint32_t i = 0; i < vulkanMemoryAllocator.m_pages.size(); ++i)
+    {
+        if (vulkanMemoryAllocator.m_pages[i] != nullptr)
+        {
+            DestroyPage(vulkanMemoryAllocator, i);
+        }
+    }
+    vulkanMemoryAllocator.m_pages.clear();
+
+    if (vulkanMemoryAllocator.m_dedicatedCount != 0)
+    {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "VulkanMemoryAllocator: %u dedicated allocations were never freed", vulkanMemoryAllocator.m_dedicatedCount);
+    }
+}
+
+VkResult Allocate_VulkanMemoryAllocator(
+    VulkanMemoryAllocator& vulkanMemoryAllocator,
+    const VkMemoryRequirements& memoryRequirements,
+    const uint32_t memoryTypeIndex,
+    const VulkanMemoryTiling tiling,
+    VulkanAllocation& outAllocation)
+{
+    Deallocate_VulkanMemoryAllocator(vulkanMemoryAllocator, outAllocation);
+
+    DUCK_DEMO_ASSERT(memoryTypeIndex < vulkanMemoryAllocator.m_memoryProperties.memoryTypeCount);
+    DUCK_DEMO_ASSERT((memoryRequirements.memoryTypeBits & (1u << memoryTypeIndex)) != 0);
+
+    VkDeviceSize size = std::max<VkDeviceSize>(memoryRequirements.size, 1);
+    VkDeviceSize alignment = std::max<VkDeviceSize>(memoryRequirements.alignment, 1);
+    if (tiling == VulkanMemoryTiling_Optimal)
+    {
+        // giving optimal images whole granularity pages means no buffer can ever end up next to one inside the same page
+        alignment = std::max(alignment, vulkanMemoryAllocator.m_bufferImageGranularity);
+        size = AlignUp(size, vulkanMemoryAllocator.m_bufferImageGranularity);
+    }
+
+    outAllocation.m_memoryTypeIndex = memoryTypeIndex;
+
+    // anything taking up most of a page would just waste the rest of it
+    if (size > GetPageSize(vulkanMemoryAllocator, memoryTypeIndex) / 2)
+    {
+        const VkResult result = AllocateDeviceMemory(vulkanMemoryAllocator, size, memoryTypeIndex, outAllocation.m_deviceMemory, outAllocation.m_mappedData);
+        if (result != VK_SUCCESS)
+        {
+            return result;
+        }
+
+        outAllocation.m_offset = 0;
+        outAllocation.m_size = size;
+        ++vulkanMemoryAllocator.m_dedicatedCount;
+        vulkanMemoryAllocator.m_dedicatedBytes += size;
+        return VK_SUCCESS;
+    }
+
+    uint32_t pageIndex = c_vulkanMemoryInvalidIndex;
+    uint32_t blockIndex = c_vulkanMemoryInvalidIndex;
+    for (uint32_t i = 0; i < vulkanMemoryAllocator.m_pages.size() && blockIndex == c_vulkanMemoryInvalidIndex; ++i)
+    {
+        VulkanMemoryPage* page = vulkanMemoryAllocator.m_pages[i].get();
+        if (page != nullptr && page->m_memoryTypeIndex == memoryTypeIndex)
+        {
+            pageIndex = i;
+            blockIndex = AllocateFromPage(*page, size, alignment);
+        }
+    }
+
+    if (blockIndex == c_vulkanMemoryInvalidIndex)
+    {
+        pageIndex = CreatePage(vulkanMemoryAllocator, memoryTypeIndex);
+        if (pageIndex == c_vulkanMemoryInvalidIndex)
+        {
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+
+        blockIndex = AllocateFromPage(*vulkanMemoryAllocator.m_pages[pageIndex], size, alignment);
+        if (blockIndex == c_vulkanMemoryInvalidIndex)
+        {
+            DUCK_DEMO_ASSERT(false);
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+    }
+
+    const VulkanMemoryPage& page = *vulkanMemoryAllocator.m_pages[pageIndex];
+    const VulkanMemoryBlock& block = page.m_blocks[blockIndex];
+    outAllocation.m_deviceMemory = page.m_deviceMemory;
+    outAllocation.m_offset = block.m_offset;
+    outAllocation.m_size = block.m_size;
+    outAllocation.m_mappedData = page.m_mappedData != nullptr ? page.m_mappedData + block.m_offset : nullptr;
+    outAllocation.m_pageIndex = pageIndex;
+    outAllocation.m_blockIndex = blockIndex;
+
+    return VK_SUCCESS;
+}
+
+void Deallocate_VulkanMemoryAllocator(VulkanMemoryAllocator& vulkanMemoryAllocator, VulkanAllocation& allocation)
+{
+    if (allocation.m_deviceMemory == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    if (allocation.m_pageIndex == c_vulkanMemoryInvalidIndex)
+    {
+        vkFreeMemory(Game::Get()->GetVulkanDevice(), allocation.m_deviceMemory, s_allocator);
+        --vulkanMemoryAllocator.m_dedicatedCount;
+        vulkanMemoryAllocator.m_dedicatedBytes -= allocation.m_size;
+    }
+    else
+    {
+        VulkanMemoryPage& page = *vulkanMemoryAllocator.m_pages[allocation.m_pageIndex];
+        FreeFromPage(page, allocation.m_blockIndex);
+
+        // keep one empty page per memory type around so something like a resize doesn't go back to the driver every time
+        if (page.m_allocationCount == 0)
+        {
+            for (uint32_t i = 0; i < vulkanMemoryAllocator.m_pages.size(); ++i)
+            {
+                const VulkanMemoryPage* otherPage = vulkanMemoryAllocator.m_pages[i].get();
+                if (i != allocation.m_pageIndex && otherPage != nullptr && otherPage->m_memoryTypeIndex == page.m_memoryTypeIndex)
+                {
+                    DestroyPage(vulkanMemoryAllocator, allocation.m_pageIndex);
+                    break;
+                }
+            }
+        }
+    }
+
+    allocation = VulkanAllocation();
+}
+
+uint32_t FindMemoryType_VulkanMemoryAllocator(
+    const VulkanMemoryAllocator& vulkanMemoryAllocator,
+    const uint32_t memoryTypeBits,
+    const VkMemoryPropertyFlags requiredFlags,
+    const VkMemoryPropertyFlags preferredFlags /*= 0*/)
+{
+    uint32_t memoryTypeIndex = c_vulkanMemoryInvalidIndex;
+    for (uint32_t i = 0; i < vulkanMemoryAllocator.m_memoryProperties.memoryTypeCount; ++i)
+    {
+        const VkMemoryPropertyFlags propertyFlags = vulkanMemoryAllocator.m_memoryProperties.memoryTypes[i].propertyFlags;
+        if ((memoryTypeBits & (1u << i)) == 0 || (propertyFlags & requiredFlags) != requiredFlags)
+        {
+            continue;
+        }
+
+        if ((propertyFlags & preferredFlags) == preferredFlags)
+        {
+            return i;
+        }
+
+        if (memoryTypeIndex == c_vulkanMemoryInvalidIndex)
+        {
+            memoryTypeIndex = i;
+        }
+    }
+
+    return memoryTypeIndex;
+}
+
+bool IsHostCoherent_VulkanMemoryAllocator(const VulkanMemoryAllocator& vulkanMemoryAllocator, const VulkanAllocation& allocation)
+{
+    DUCK_DEMO_ASSERT(allocation.m_memoryTypeIndex < vulkanMemoryAllocator.m_memoryProperties.memoryTypeCount);
+    return (vulkanMemoryAllocator.m_memoryProperties.memoryTypes[allocation.m_memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+}
+
+void Flush_VulkanMemoryAllocator(VulkanMemoryAllocator& vulkanMemoryAllocator, const VulkanAllocation& allocation, const VkDeviceSize offset, const VkDeviceSize size)
+{
+    if (allocation.m_mappedData == nullptr || size == 0 || IsHostCoherent_VulkanMemoryAllocator(vulkanMemoryAllocator, allocation))
+    {
+        return;
+    }
+
+    // the range has to be in whole atoms of the VkDeviceMemory, widening it into a neighbour's bytes is harmless
+    const VkDeviceSize atomSize = vulkanMemoryAllocator.m_nonCoherentAtomSize;
+    const VkDeviceSize memorySize = allocation.m_pageIndex != c_vulkanMemoryInvalidIndex ? vulkanMemoryAllocator.m_pages[allocation.m_pageIndex]->m_size : allocation.m_size;
+    const VkDeviceSize begin = (allocation.m_offset + offset) / atomSize * atomSize;
+    const VkDeviceSize end = std::min(AlignUp(allocation.m_offset + offset + size, atomSize), memorySize);
+
+    VkMappedMemoryRange mappedMemoryRange;
+    mappedMemoryRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    mappedMemoryRange.pNext = nullptr;
+    mappedMemoryRange.memory = allocation.m_deviceMemory;
+    mappedMemoryRange.offset = begin;
+    mappedMemoryRange.size = end - begin;
+    DUCK_DEMO_VULKAN_ASSERT(vkFlushMappedMemoryRanges(Game::Get()->GetVulkanDevice(), 1, &mappedMemoryRange));
+}
+
+VulkanMemoryAllocatorStats GetStats_VulkanMemoryAllocator(const VulkanMemoryAllocator& vulkanMemoryAllocator)
+{
+    VulkanMemoryAllocatorStats stats;
+    VkDeviceSize pageFreeBytes = 0;
+    VkDeviceSize pageLargestFreeBytes = 0;
+
+    for (const std::unique_ptr<VulkanMemoryPage>& page : vulkanMemoryAllocator.m_pages)
+    {
+        if (page == nullptr)
+        {
+            continue;
+        }
+
+        const VkDeviceSize largestFreeBlock = GetLargestFreeBlock(*page);
+
+        ++stats.m_pageCount;
+        stats.m_allocationCount += page->m_allocationCount;
+        stats.m_freeBlockCount += page->m_freeBlockCount;
+        stats.m_reservedBytes += page->m_size;
+        stats.m_usedBytes += page->m_usedBytes;
+        stats.m_largestFreeBlock = std::max(stats.m_largestFreeBlock, largestFreeBlock);
+
+        pageFreeBytes += page->m_size - page->m_usedBytes;
+        pageLargestFreeBytes += largestFreeBlock;
+    }
+
+    stats.m_dedicatedCount = vulkanMemoryAllocator.m_dedicatedCount;
+    stats.m_allocationCount += vulkanMemoryAllocator.m_dedicatedCount;
+    stats.m_reservedBytes += vulkanMemoryAllocator.m_dedicatedBytes;
+    stats.m_usedBytes += vulkanMemoryAllocator.m_dedicatedBytes;
+    stats.m_deviceMemoryCount = stats.m_pageCount + stats.m_dedicatedCount;
+
+    // measured per page, two empty pages aren't fragmented just because they can't be merged into one block
+    stats.m_fragmentation = pageFreeBytes > 0 ? 1.0 - static_cast<double>(pageLargestFreeBytes) / static_cast<double>(pageFreeBytes) : 0.0;
+
+    return stats;
+}
+
+void ImGui_VulkanMemoryAllocator(const VulkanMemoryAllocator& vulkanMemoryAllocator)
+{
+    if (!ImGui::CollapsingHeader("GPU Memory"))
+    {
+        return;
+    }
+
+    constexpr double bytesToMegabytes = 1.0 / (1024.0 * 1024.0);
+
+    const VulkanMemoryAllocatorStats stats = GetStats_VulkanMemoryAllocator(vulkanMemoryAllocator);
+    ImGui::Text("vkAllocateMemory  %u / %u", stats.m_deviceMemoryCount, vulkanMemoryAllocator.m_maxMemoryAllocationCount);
+    ImGui::Text("Pages             %u (dedicated %u)", stats.m_pageCount, stats.m_dedicatedCount);
+    ImGui::Text("Allocations       %u", stats.m_allocationCount);
+    ImGui::Text("Used / Reserved   %.1f / %.1f MB", stats.m_usedBytes * bytesToMegabytes, stats.m_reservedBytes * bytesToMegabytes);
+    ImGui::Text("Free blocks       %u (largest %.2f MB)", stats.m_freeBlockCount, stats.m_largestFreeBlock * bytesToMegabytes);
+    ImGui::Text("Fragmentation     %.1f%%", stats.m_fragmentation * 100.0);
+
+    for (const std::unique_ptr<VulkanMemoryPage>& page : vulkanMemoryAllocator.m_pages)
+    {
+        if (page != nullptr)
+        {
+            const std::string overlay = DuckDemoUtils::format("type %u: %.1f / %.1f MB", page->m_memoryTypeIndex, page->m_usedBytes * bytesToMegabytes, page->m_size * bytesToMegabytes);
+            ImGui::ProgressBar(static_cast<float>(page->m_usedBytes) / static_cast<float>(page->m_size), ImVec2(-1.0f, 0.0f), overlay.c_str());
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// pages are carved up with a two level segregated fit (tlsf) allocator, the second level splits every power of two into 16 buckets
+constexpr uint32_t c_vulkanMemorySecondLevelLog2 = 4u;
+constexpr uint32_t c_vulkanMemorySecondLevelCount = 1u << c_vulkanMemorySecondLevelLog2;
+// everything below 256 bytes shares the first bucket row
+constexpr uint32_t c_vulkanMemoryFirstLevelShift = 8u;
+constexpr uint32_t c_vulkanMemoryFirstLevelCount = 64u - c_vulkanMemoryFirstLevelShift + 1u;
+constexpr uint32_t c_vulkanMemoryInvalidIndex = UINT32_MAX;
+
+enum VulkanMemoryTiling
+{
+    // buffers and linear images
+    VulkanMemoryTiling_Linear = 0,
+    // optimal images, these can't share a bufferImageGranularity sized page with linear resources
+    VulkanMemoryTiling_Optimal,
+};
+
+struct VulkanAllocation
+{
+    VkDeviceMemory m_deviceMemory = VK_NULL_HANDLE;
+    VkDeviceSize m_offset = 0;
+    VkDeviceSize m_size = 0;
+    // host visible memory stays mapped for as long as it's allocated, null for everything else
+    uint8_t* m_mappedData = nullptr;
+    uint32_t m_memoryTypeIndex = c_vulkanMemoryInvalidIndex;
+    // c_vulkanMemoryInvalidIndex when the allocation was too big for a page and owns its VkDeviceMemory
+    uint32_t m_pageIndex = c_vulkanMemoryInvalidIndex;
+    uint32_t m_blockIndex = c_vulkanMemoryInvalidIndex;
+};
+
+struct VulkanMemoryBlock
+{
+    VkDeviceSize m_offset = 0;
+    VkDeviceSize m_size = 0;
+    // neighbours in address order, used to merge free blocks back together
+    uint32_t m_prevPhysical = c_vulkanMemoryInvalidIndex;
+    uint32_t m_nextPhysical = c_vulkanMemoryInvalidIndex;
+    // neighbours in the free list of the block's bucket, only valid while the block is free
+    uint32_t m_prevFree = c_vulkanMemoryInvalidIndex;
+    uint32_t m_nextFree = c_vulkanMemoryInvalidIndex;
+    bool m_free = false;
+};
+
+struct VulkanMemoryPage
+{
+    VkDeviceMemory m_deviceMemory = VK_NULL_HANDLE;
+    VkDeviceSize m_size = 0;
+    uint8_t* m_mappedData = nullptr;
+    uint32_t m_memoryTypeIndex = 0;
+    std::vector<VulkanMemoryBlock> m_blocks;
+    // slots in m_blocks that were merged away and can be reused
+    std::vector<uint32_t> m_unusedBlocks;
+    std::array<uint32_t, c_vulkanMemoryFirstLevelCount * c_vulkanMemorySecondLevelCount> m_freeHeads;
+    uint64_t m_firstLevelBitmap = 0;
+    std::array<uint32_t, c_vulkanMemoryFirstLevelCount> m_secondLevelBitmaps;
+    VkDeviceSize m_usedBytes = 0;
+    uint32_t m_allocationCount = 0;
+    uint32_t m_freeBlockCount = 0;
+};
+
+struct VulkanMemoryAllocatorStats
+{
+    uint32_t m_deviceMemoryCount = 0;
+    uint32_t m_pageCount = 0;
+    uint32_t m_dedicatedCount = 0;
+    uint32_t m_allocationCount = 0;
+    uint32_t m_freeBlockCount = 0;
+    VkDeviceSize m_reservedBytes = 0;
+    VkDeviceSize m_usedBytes = 0;
+    VkDeviceSize m_largestFreeBlock = 0;
+    // 0 when all free space in the pages is one block, approaching 1 as it gets split up into many small ones
+    double m_fragmentation = 0.0;
+};
+
+struct VulkanMemoryAllocator
+{
+    VkPhysicalDeviceMemoryProperties m_memoryProperties;
+    VkDeviceSize m_bufferImageGranularity = 1;
+    VkDeviceSize m_nonCoherentAtomSize = 1;
+    uint32_t m_maxMemoryAllocationCount = 0;
+    // pages are never moved so an allocation's m_pageIndex stays valid, freed pages leave a null slot behind
+    std::vector<std::unique_ptr<VulkanMemoryPage>> m_pages;
+    uint32_t m_dedicatedCount = 0;
+    VkDeviceSize m_dedicatedBytes = 0;
+};
+
+bool Init_VulkanMemoryAllocator(VulkanMemoryAllocator& vulkanMemoryAllocator);
+void Free_VulkanMemoryAllocator(VulkanMemoryAllocator& vulkanMemoryAllocator);
+
+VkResult Allocate_VulkanMemoryAllocator(
+    VulkanMemoryAllocator& vulkanMemoryAllocator,
+    const VkMemoryRequirements& memoryRequirements,
+    const uint32_t memoryTypeIndex,
+    const VulkanMemoryTiling tiling,
+    VulkanAllocation& outAllocation);
+// resets the allocation, does nothing if it was never allocated
+void Deallocate_VulkanMemoryAllocator(VulkanMemoryAllocator& vulkanMemoryAllocator, VulkanAllocation& allocation);
+// first memory type with all the required flags, one that also has the preferred flags wins, c_vulkanMemoryInvalidIndex if nothing fits
+uint32_t FindMemoryType_VulkanMemoryAllocator(
+    const VulkanMemoryAllocator& vulkanMemoryAllocator,
+    const uint32_t memoryTypeBits,
+    const VkMemoryPropertyFlags requiredFlags,
+    const VkMemoryPropertyFlags preferredFlags = 0);
+bool IsHostCoherent_VulkanMemoryAllocator(const VulkanMemoryAllocator& vulkanMemoryAllocator, const VulkanAllocation& allocation);
+// makes cpu writes to a mapped allocation visible to the gpu, does nothing for host coherent memory
+void Flush_VulkanMemoryAllocator(VulkanMemoryAllocator& vulkanMemoryAllocator, const VulkanAllocation& allocation, const VkDeviceSize offset, const VkDeviceSize size);
+
+VulkanMemoryAllocatorStats GetStats_VulkanMemoryAllocator(const VulkanMemoryAllocator& vulkanMemoryAllocator);
+// draws into whatever imgui window is currently open
+void ImGui_VulkanMemoryAllocator(const VulkanMemoryAllocator& vulkanMemoryAllocator);
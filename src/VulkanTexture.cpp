@@ -5,7 +5,12 @@
 
 void VulkanTexture::Reset()
 {
-    if (m_image == VK_NULL_HANDLE && m_deviceMemory == VK_NULL_HANDLE)
+    m_ready = false;
+    m_width = 0;
+    m_height = 0;
+    m_mipLevelCount = 0;
+
+    if (m_image == VK_NULL_HANDLE && m_allocation.m_deviceMemory == VK_NULL_HANDLE)
     {
         return;
     }
@@ -30,11 +35,7 @@ void VulkanTexture::Reset()
         m_imageView = VK_NULL_HANDLE;
     }
 
-    if (m_deviceMemory != VK_NULL_HANDLE)
-    {
-        vkFreeMemory(vulkanDevice, m_deviceMemory, s_allocator);
-        m_deviceMemory = VK_NULL_HANDLE;
-    }
+    Deallocate_VulkanMemoryAllocator(game->GetVulkanMemoryAllocator(), m_allocation);
 
     if (m_image != VK_NULL_HANDLE)
     {
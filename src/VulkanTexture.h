@@ -2,6 +2,8 @@
 
 #include <vulkan/vulkan.h>
 
+#include "VulkanMemoryAllocator.h"
+
 struct VulkanTexture
 {
     ~VulkanTexture()
@@ -11,6 +13,11 @@ struct VulkanTexture
     void Reset();
 
     VkImage m_image = VK_NULL_HANDLE;
-    VkDeviceMemory m_deviceMemory = VK_NULL_HANDLE;
+    VulkanAllocation m_allocation;
     VkImageView m_imageView = VK_NULL_HANDLE;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint32_t m_mipLevelCount = 0;
+    // set by the TextureLoader once the upload is done, textures made any other way are ready when they're created
+    bool m_ready = false;
 };
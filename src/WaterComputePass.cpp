@@ -1,34 +1,304 @@
 #include "WaterComputePass.h"
 
+#include <chrono>
 #include <limits>
 #include <vector>
 
+#include "CpuProfiler.h"
 #include "Game.h"
 #include "DuckDemoUtils.h"
+#include "ShaderSpecialization.h"
 
 constexpr uint32_t c_numWorkGroupShaderX = 16;
 constexpr uint32_t c_numWorkGroupShaderY = 16;
 
-void UpdateWaveBuf(WaterComputePass& waterComputePass)
+void UpdateWaveBuf(WaterComputePass& waterComputePass, const uint32_t frameIndex)
 {
-    Game::Get()->FillVulkanBuffer(waterComputePass.waveBufBuffer, &waterComputePass.waveBuf, sizeof(waterComputePass.waveBuf));
+    Game::Get()->FillVulkanBuffer(waterComputePass.waveBufBuffers[frameIndex], &waterComputePass.waveBuf, sizeof(waterComputePass.waveBuf));
+}
+
+// fills the baked loop with one dispatch over every slice and waits for it, only ever done at init
+static bool InitBaked_WaterComputePass(WaterComputePass& waterComputePass, const WaterComputePassParams& params)
+{
+    DUCK_DEMO_CPU_SCOPE("InitBaked_WaterComputePass");
+
+    DUCK_DEMO_ASSERT(params.bakedWidth % c_numWorkGroupShaderX == 0 && params.bakedWidth % c_numWorkGroupShaderY == 0);
+    DUCK_DEMO_ASSERT(params.bakedSliceCount > 0 && params.bakedPeriod > 0.0f);
+
+    VkDevice device = Game::Get()->GetVulkanDevice();
+    VkResult result = VK_SUCCESS;
+
+    VkImageCreateInfo imageCreateInfo;
+    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCreateInfo.pNext = nullptr;
+    imageCreateInfo.flags = 0;
+    imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageCreateInfo.format = c_waterComputePassFormat;
+    imageCreateInfo.extent.width = params.bakedWidth;
+    imageCreateInfo.extent.height = params.bakedWidth;
+    imageCreateInfo.extent.depth = 1;
+    imageCreateInfo.mipLevels = 1;
+    imageCreateInfo.arrayLayers = params.bakedSliceCount;
+    imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCreateInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageCreateInfo.queueFamilyIndexCount = 0;
+    imageCreateInfo.pQueueFamilyIndices = nullptr;
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    result = vkCreateImage(device, &imageCreateInfo, s_allocator, &waterComputePass.bakedImage);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(device, waterComputePass.bakedImage, &memoryRequirements);
+    const uint32_t memoryTypeIndex = Game::Get()->FindMemoryByFlagAndType(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memoryRequirements.memoryTypeBits);
+
+    result = Allocate_VulkanMemoryAllocator(Game::Get()->GetVulkanMemoryAllocator(), memoryRequirements, memoryTypeIndex, VulkanMemoryTiling_Optimal, waterComputePass.bakedAllocation);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    result = vkBindImageMemory(device, waterComputePass.bakedImage, waterComputePass.bakedAllocation.m_deviceMemory, waterComputePass.bakedAllocation.m_offset);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    // the bake writes through this view and playback samples through it
+    VkImageViewCreateInfo imageViewCreateInfo;
+    imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    imageViewCreateInfo.pNext = nullptr;
+    imageViewCreateInfo.flags = 0;
+    imageViewCreateInfo.image = waterComputePass.bakedImage;
+    imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    imageViewCreateInfo.format = c_waterComputePassFormat;
+    imageViewCreateInfo.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
+    imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+    imageViewCreateInfo.subresourceRange.levelCount = 1;
+    imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+    imageViewCreateInfo.subresourceRange.layerCount = params.bakedSliceCount;
+    result = vkCreateImageView(device, &imageViewCreateInfo, s_allocator, &waterComputePass.bakedImageView);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    // the slices are smaller than the output so they're filtered up, but never across the edges of the plane
+    VkSamplerCreateInfo samplerCreateInfo;
+    samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerCreateInfo.pNext = nullptr;
+    samplerCreateInfo.flags = 0;
+    samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+    samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+    samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerCreateInfo.mipLodBias = 0.0f;
+    samplerCreateInfo.anisotropyEnable = VK_FALSE;
+    samplerCreateInfo.maxAnisotropy = 1.0f;
+    samplerCreateInfo.compareEnable = VK_FALSE;
+    samplerCreateInfo.compareOp = VK_COMPARE_OP_NEVER;
+    samplerCreateInfo.minLod = 0.0f;
+    samplerCreateInfo.maxLod = 0.0f;
+    samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+    samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+    result = vkCreateSampler(device, &samplerCreateInfo, s_allocator, &waterComputePass.bakedSampler);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    // the bake's output set uses the same layout as the usual output, it's only needed until the bake is done
+    VkDescriptorSet bakeOutputDescriptorSet = VK_NULL_HANDLE;
+    {
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext = nullptr;
+        descriptorSetAllocateInfo.descriptorPool = waterComputePass.descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = 1;
+        descriptorSetAllocateInfo.pSetLayouts = &waterComputePass.descriptorSetLayouts[2];
+        result = vkAllocateDescriptorSets(device, &descriptorSetAllocateInfo, &bakeOutputDescriptorSet);
+        if (result != VK_SUCCESS)
+        {
+            DUCK_DEMO_VULKAN_ASSERT(result);
+            return false;
+        }
+
+        descriptorSetAllocateInfo.pSetLayouts = &waterComputePass.descriptorSetLayouts[4];
+        result = vkAllocateDescriptorSets(device, &descriptorSetAllocateInfo, &waterComputePass.bakedDescriptorSet);
+        if (result != VK_SUCCESS)
+        {
+            DUCK_DEMO_VULKAN_ASSERT(result);
+            return false;
+        }
+    }
+
+    {
+        std::array<VkDescriptorImageInfo, 2> descriptorImageInfos;
+        descriptorImageInfos[0].sampler = VK_NULL_HANDLE;
+        descriptorImageInfos[0].imageView = waterComputePass.bakedImageView;
+        descriptorImageInfos[0].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        descriptorImageInfos[1].sampler = waterComputePass.bakedSampler;
+        descriptorImageInfos[1].imageView = waterComputePass.bakedImageView;
+        descriptorImageInfos[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        std::array<VkWriteDescriptorSet, 2> writeDescriptorSets;
+        for (std::size_t i = 0; i < writeDescriptorSets.size(); ++i)
+        {
+            writeDescriptorSets[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSets[i].pNext = nullptr;
+            writeDescriptorSets[i].dstBinding = 0;
+            writeDescriptorSets[i].dstArrayElement = 0;
+            writeDescriptorSets[i].descriptorCount = 1;
+            writeDescriptorSets[i].pBufferInfo = nullptr;
+            writeDescriptorSets[i].pImageInfo = &descriptorImageInfos[i];
+            writeDescriptorSets[i].pTexelBufferView = nullptr;
+        }
+        writeDescriptorSets[0].dstSet = bakeOutputDescriptorSet;
+        writeDescriptorSets[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writeDescriptorSets[1].dstSet = waterComputePass.bakedDescriptorSet;
+        writeDescriptorSets[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+    }
+
+    VkShaderModule bakeShaderModule = VK_NULL_HANDLE;
+    result = Game::Get()->LoadShader("data/shader_src/water.comp", shaderc_glsl_compute_shader, &bakeShaderModule, { { "WATER_BAKE", "" } });
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        return false;
+    }
+
+    ShaderSpecialization specialization;
+    Set_ShaderSpecialization(specialization, WaterComputeConstant_LocalSizeX, c_numWorkGroupShaderX);
+    Set_ShaderSpecialization(specialization, WaterComputeConstant_LocalSizeY, c_numWorkGroupShaderY);
+
+    VkComputePipelineCreateInfo computePipelineCreateInfo;
+    computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    computePipelineCreateInfo.pNext = nullptr;
+    computePipelineCreateInfo.flags = 0;
+    computePipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computePipelineCreateInfo.stage.pNext = nullptr;
+    computePipelineCreateInfo.stage.flags = 0;
+    computePipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computePipelineCreateInfo.stage.module = bakeShaderModule;
+    computePipelineCreateInfo.stage.pName = "main";
+    computePipelineCreateInfo.stage.pSpecializationInfo = GetInfo_ShaderSpecialization(specialization);
+    computePipelineCreateInfo.layout = waterComputePass.pipelineLayout;
+    computePipelineCreateInfo.basePipelineHandle = nullptr;
+    computePipelineCreateInfo.basePipelineIndex = 0;
+
+    VkPipeline bakePipeline = VK_NULL_HANDLE;
+    result = Game::Get()->CreateVulkanComputePipeline(computePipelineCreateInfo, &bakePipeline);
+    if (result != VK_SUCCESS)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        vkDestroyShaderModule(device, bakeShaderModule, s_allocator);
+        return false;
+    }
+
+    const std::chrono::high_resolution_clock::time_point bakeStartTime = std::chrono::high_resolution_clock::now();
+
+    // nothing else is using the compute queue yet so the first frame's command buffer is free to borrow
+    VkCommandBuffer commandBuffer = waterComputePass.commandBuffers[0];
+
+    VkCommandBufferBeginInfo commandBufferBeginInfo;
+    commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    commandBufferBeginInfo.pNext = nullptr;
+    commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    commandBufferBeginInfo.pInheritanceInfo = nullptr;
+    DUCK_DEMO_VULKAN_ASSERT(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+
+    VkImageMemoryBarrier imageMemoryBarrier;
+    imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageMemoryBarrier.pNext = nullptr;
+    imageMemoryBarrier.srcAccessMask = VK_ACCESS_NONE;
+    imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageMemoryBarrier.image = waterComputePass.bakedImage;
+    imageMemoryBarrier.subresourceRange = imageViewCreateInfo.subresourceRange;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, bakePipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, waterComputePass.pipelineLayout, 2, 1, &bakeOutputDescriptorSet, 0, nullptr);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, waterComputePass.pipelineLayout, 3, 1, &waterComputePass.waveBufDescriptorSets[0], 0, nullptr);
+    vkCmdDispatch(commandBuffer, params.bakedWidth / c_numWorkGroupShaderX, params.bakedWidth / c_numWorkGroupShaderY, params.bakedSliceCount);
+
+    // every frame's playback only ever samples it from here on
+    imageMemoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+
+    DUCK_DEMO_VULKAN_ASSERT(vkEndCommandBuffer(commandBuffer));
+
+    VkQueue computeQueue = VK_NULL_HANDLE;
+    vkGetDeviceQueue(device, Game::Get()->GetVulkanComputeQueueIndex(), 0, &computeQueue);
+
+    VkSubmitInfo submitInfo;
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = nullptr;
+    submitInfo.waitSemaphoreCount = 0;
+    submitInfo.pWaitSemaphores = nullptr;
+    submitInfo.pWaitDstStageMask = nullptr;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 0;
+    submitInfo.pSignalSemaphores = nullptr;
+    DUCK_DEMO_VULKAN_ASSERT(vkQueueSubmit(computeQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+    // only happens once at startup so waiting on the whole queue is fine
+    DUCK_DEMO_VULKAN_ASSERT(vkQueueWaitIdle(computeQueue));
+
+    SDL_Log("WaterComputePass: baked %u slices of %ux%u in %.1f ms, %.1f mb",
+        params.bakedSliceCount, params.bakedWidth, params.bakedWidth,
+        std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - bakeStartTime).count() * 1e3,
+        static_cast<double>(memoryRequirements.size) / (1024.0 * 1024.0));
+
+    vkDestroyPipeline(device, bakePipeline, s_allocator);
+    vkDestroyShaderModule(device, bakeShaderModule, s_allocator);
+    vkFreeDescriptorSets(device, waterComputePass.descriptorPool, 1, &bakeOutputDescriptorSet);
+
+    waterComputePass.baked = true;
+    return true;
 }
 
 bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComputePassParams& params)
 {
     VkResult result = VK_SUCCESS;
 
-    std::array<VkDescriptorPoolSize, 2> descriptorPoolSize;
+    const uint32_t framesInFlightCount = Game::Get()->GetFramesInFlightCount();
+
+    // the extra storage image and the sampler are the baked loop's, see InitBaked_WaterComputePass
+    std::array<VkDescriptorPoolSize, 3> descriptorPoolSize;
     descriptorPoolSize[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    descriptorPoolSize[0].descriptorCount = 3;
+    descriptorPoolSize[0].descriptorCount = c_waterComputePassTextureCount + 1;
     descriptorPoolSize[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptorPoolSize[1].descriptorCount = 1;
+    descriptorPoolSize[1].descriptorCount = framesInFlightCount;
+    descriptorPoolSize[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorPoolSize[2].descriptorCount = 1;
 
     VkDescriptorPoolCreateInfo descriptorPoolCreateInfo;
     descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     descriptorPoolCreateInfo.pNext = nullptr;
     descriptorPoolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-    descriptorPoolCreateInfo.maxSets = 4;
+    descriptorPoolCreateInfo.maxSets = c_waterComputePassTextureCount + framesInFlightCount + 2;
     descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(descriptorPoolSize.size());
     descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSize.data();
 
@@ -132,6 +402,30 @@ bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComput
         }
     }
 
+    {
+        VkDescriptorSetLayoutBinding descriptorSetLayoutBinding;
+        descriptorSetLayoutBinding.binding = 0;
+        descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorSetLayoutBinding.descriptorCount = 1;
+        descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        descriptorSetLayoutBinding.pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+        descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutCreateInfo.pNext = nullptr;
+        descriptorSetLayoutCreateInfo.flags = 0;
+        descriptorSetLayoutCreateInfo.bindingCount = 1;
+        descriptorSetLayoutCreateInfo.pBindings = &descriptorSetLayoutBinding;
+
+        result = vkCreateDescriptorSetLayout(Game::Get()->GetVulkanDevice(), &descriptorSetLayoutCreateInfo, s_allocator, 
+            &waterComputePass.descriptorSetLayouts[4]);
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        if (result != VK_SUCCESS)
+        {
+            return false;
+        }
+    }
+
     VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
     pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutCreateInfo.pNext = nullptr;
@@ -165,50 +459,39 @@ bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComput
         }
     }
 
+    for (uint32_t frameIndex = 0; frameIndex < framesInFlightCount; ++frameIndex)
+    {
+        VkDescriptorSetAllocateInfo descriptorSetAllocateInfo;
+        descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        descriptorSetAllocateInfo.pNext = nullptr;
+        descriptorSetAllocateInfo.descriptorPool = waterComputePass.descriptorPool;
+        descriptorSetAllocateInfo.descriptorSetCount = 1;
+        descriptorSetAllocateInfo.pSetLayouts = &waterComputePass.descriptorSetLayouts[3];
+
+        result = vkAllocateDescriptorSets(Game::Get()->GetVulkanDevice(), &descriptorSetAllocateInfo, &waterComputePass.waveBufDescriptorSets[frameIndex]);
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        if (result != VK_SUCCESS)
+        {
+            return false;
+        }
+    }
+
     for (uint32_t i = 0; i < c_waterComputePassTextureCount; ++i)
     {    
-        VkBuffer stagingBuffer = VK_NULL_HANDLE;
-        VkDeviceMemory stagingDeviceMemory = VK_NULL_HANDLE;
-
-        VkBufferCreateInfo bufferCreateInfo;
-        bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufferCreateInfo.pNext = nullptr;
-        bufferCreateInfo.flags = 0;
-        bufferCreateInfo.size = static_cast<VkDeviceSize>(params.width * params.width * sizeof(float));
-        bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        bufferCreateInfo.queueFamilyIndexCount = 0;
-        bufferCreateInfo.pQueueFamilyIndices = nullptr;
-        VkResult result = vkCreateBuffer(Game::Get()->GetVulkanDevice(), &bufferCreateInfo, s_allocator, &stagingBuffer);
+        VulkanBuffer stagingBuffer;
+        VkResult result = Game::Get()->CreateVulkanBuffer(static_cast<VkDeviceSize>(params.width * params.width * c_waterComputePassTexelSize), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, stagingBuffer);
         if (result != VK_SUCCESS)
         {
-            DUCK_DEMO_VULKAN_ASSERT(result);
-            return result;
+            return false;
         }
-
-        VkMemoryRequirements memoryRequirements;
-        vkGetBufferMemoryRequirements(Game::Get()->GetVulkanDevice(), stagingBuffer, &memoryRequirements);
-
-        VkMemoryAllocateInfo memoryAllocateInfo;
-        memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        memoryAllocateInfo.pNext = nullptr;
-        memoryAllocateInfo.allocationSize = memoryRequirements.size;
-        memoryAllocateInfo.memoryTypeIndex = Game::Get()->FindMemoryByFlagAndType(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, memoryRequirements.memoryTypeBits);
-
-        DUCK_DEMO_VULKAN_ASSERT(vkAllocateMemory(Game::Get()->GetVulkanDevice(), &memoryAllocateInfo, s_allocator, &stagingDeviceMemory));
-        DUCK_DEMO_VULKAN_ASSERT(vkBindBufferMemory(Game::Get()->GetVulkanDevice(), stagingBuffer, stagingDeviceMemory, 0));
-
-        void* gpuMemory = nullptr;
-        vkMapMemory(Game::Get()->GetVulkanDevice(),stagingDeviceMemory, 0, VK_WHOLE_SIZE, 0, &gpuMemory);
-        memset(gpuMemory, '\0', memoryRequirements.size);
-        vkUnmapMemory(Game::Get()->GetVulkanDevice(), stagingDeviceMemory);
+        Game::Get()->ZeroVulkanBuffer(stagingBuffer);
 
         VkImageCreateInfo imageCreateInfo;
         imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         imageCreateInfo.pNext = nullptr;
         imageCreateInfo.flags = 0;
         imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-        imageCreateInfo.format = VK_FORMAT_R32_SFLOAT;
+        imageCreateInfo.format = c_waterComputePassFormat;
         imageCreateInfo.extent.width = params.width;
         imageCreateInfo.extent.height = params.width;
         imageCreateInfo.extent.depth = 1;
@@ -223,22 +506,22 @@ bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComput
         imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         DUCK_DEMO_VULKAN_ASSERT(vkCreateImage(Game::Get()->GetVulkanDevice(), &imageCreateInfo, s_allocator, &waterComputePass.images[i]));
 
+        VkMemoryRequirements memoryRequirements;
         vkGetImageMemoryRequirements(Game::Get()->GetVulkanDevice(), waterComputePass.images[i], &memoryRequirements);
-        memoryAllocateInfo.allocationSize = memoryRequirements.size;
-        memoryAllocateInfo.memoryTypeIndex = Game::Get()->FindMemoryByFlagAndType(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memoryRequirements.memoryTypeBits);
+        const uint32_t memoryTypeIndex = Game::Get()->FindMemoryByFlagAndType(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memoryRequirements.memoryTypeBits);
 
-        DUCK_DEMO_VULKAN_ASSERT(vkAllocateMemory(Game::Get()->GetVulkanDevice(), &memoryAllocateInfo, s_allocator, &waterComputePass.deviceMemories[i]));
-        DUCK_DEMO_VULKAN_ASSERT(vkBindImageMemory(Game::Get()->GetVulkanDevice(), waterComputePass.images[i], waterComputePass.deviceMemories[i], 0));
+        VulkanAllocation& allocation = waterComputePass.allocations[i];
+        DUCK_DEMO_VULKAN_ASSERT(Allocate_VulkanMemoryAllocator(Game::Get()->GetVulkanMemoryAllocator(), memoryRequirements, memoryTypeIndex, VulkanMemoryTiling_Optimal, allocation));
+        DUCK_DEMO_VULKAN_ASSERT(vkBindImageMemory(Game::Get()->GetVulkanDevice(), waterComputePass.images[i], allocation.m_deviceMemory, allocation.m_offset));
 
         Game::Get()->TransferFromStagingBufferToImage(
-            stagingBuffer, 
+            stagingBuffer.m_buffer, 
             waterComputePass.images[i], 
             1, 
             static_cast<uint32_t>(params.width), 
             static_cast<uint32_t>(params.width));
 
-        vkFreeMemory(Game::Get()->GetVulkanDevice(), stagingDeviceMemory, s_allocator);
-        vkDestroyBuffer(Game::Get()->GetVulkanDevice(), stagingBuffer, s_allocator);
+        stagingBuffer.Reset();
 
         VkImageViewCreateInfo imageViewCreateInfo;
         imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -246,7 +529,7 @@ bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComput
         imageViewCreateInfo.flags = 0;
         imageViewCreateInfo.image = waterComputePass.images[i];
         imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        imageViewCreateInfo.format = VK_FORMAT_R32_SFLOAT;
+        imageViewCreateInfo.format = c_waterComputePassFormat;
         imageViewCreateInfo.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
         imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
@@ -282,7 +565,6 @@ bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComput
     }
     
     {
-        DUCK_DEMO_VULKAN_ASSERT(Game::Get()->CreateVulkanBuffer(static_cast<VkDeviceSize>(sizeof(WaveBuf)), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, waterComputePass.waveBufBuffer));
         
         float dx = 1.0f;
         float dt = 1.0f / 144.0f;
@@ -294,55 +576,57 @@ bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComput
         waterComputePass.waveBuf.Wc3 = (2.0f * e) / d;
         waterComputePass.waveBuf.Time = 0.0f;
 
-        UpdateWaveBuf(waterComputePass);
+        waterComputePass.waveBuf.LoopPeriod = params.bakedPeriod;
+        waterComputePass.waveBuf.LoopSliceCount = params.bakedSliceCount;
+        waterComputePass.waveBuf.BakedTexelScale = static_cast<float>(params.width) / static_cast<float>(params.bakedWidth);
+        waterComputePass.waveBuf.padding0 = 0.0f;
     }
 
-    VkDescriptorBufferInfo waveBufDescriptorBufferInfo;
-    waveBufDescriptorBufferInfo.buffer = waterComputePass.waveBufBuffer.m_buffer;
-    waveBufDescriptorBufferInfo.offset = 0;
-    waveBufDescriptorBufferInfo.range = sizeof(WaveBuf);
+    // the wave buffer is rewritten every frame so each frame in flight gets its own copy
+    for (uint32_t frameIndex = 0; frameIndex < framesInFlightCount; ++frameIndex)
+    {
+        DUCK_DEMO_VULKAN_ASSERT(Game::Get()->CreateVulkanBuffer(static_cast<VkDeviceSize>(sizeof(WaveBuf)), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, waterComputePass.waveBufBuffers[frameIndex]));
+        UpdateWaveBuf(waterComputePass, frameIndex);
 
-    VkWriteDescriptorSet waveBufWriteDescriptorSet;
-    waveBufWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    waveBufWriteDescriptorSet.pNext = nullptr;
-    waveBufWriteDescriptorSet.dstSet = waterComputePass.descriptorSets[3];
-    waveBufWriteDescriptorSet.dstBinding = 0;
-    waveBufWriteDescriptorSet.dstArrayElement = 0;
-    waveBufWriteDescriptorSet.descriptorCount = 1;
-    waveBufWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    waveBufWriteDescriptorSet.pBufferInfo = &waveBufDescriptorBufferInfo;
-    waveBufWriteDescriptorSet.pImageInfo = nullptr;
-    waveBufWriteDescriptorSet.pTexelBufferView = nullptr;
+        VkDescriptorBufferInfo waveBufDescriptorBufferInfo;
+        waveBufDescriptorBufferInfo.buffer = waterComputePass.waveBufBuffers[frameIndex].m_buffer;
+        waveBufDescriptorBufferInfo.offset = 0;
+        waveBufDescriptorBufferInfo.range = sizeof(WaveBuf);
 
-    vkUpdateDescriptorSets(Game::Get()->GetVulkanDevice(), 1, &waveBufWriteDescriptorSet, 0, nullptr);
+        VkWriteDescriptorSet waveBufWriteDescriptorSet;
+        waveBufWriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        waveBufWriteDescriptorSet.pNext = nullptr;
+        waveBufWriteDescriptorSet.dstSet = waterComputePass.waveBufDescriptorSets[frameIndex];
+        waveBufWriteDescriptorSet.dstBinding = 0;
+        waveBufWriteDescriptorSet.dstArrayElement = 0;
+        waveBufWriteDescriptorSet.descriptorCount = 1;
+        waveBufWriteDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        waveBufWriteDescriptorSet.pBufferInfo = &waveBufDescriptorBufferInfo;
+        waveBufWriteDescriptorSet.pImageInfo = nullptr;
+        waveBufWriteDescriptorSet.pTexelBufferView = nullptr;
 
-    shaderc_compile_options_t compileOptions = shaderc_compile_options_initialize();
-    if (compileOptions == nullptr)
-    {
-        DUCK_DEMO_ASSERT(false);
-        return false;
+        vkUpdateDescriptorSets(Game::Get()->GetVulkanDevice(), 1, &waveBufWriteDescriptorSet, 0, nullptr);
     }
 
-    std::array<std::pair<std::string, std::string>, 2> defines;
-    defines[0].first = "NUM_GROUPS_X";
-    defines[0].second = std::to_string(c_numWorkGroupShaderX);
-    defines[1].first = "NUM_GROUPS_Y";
-    defines[1].second = std::to_string(c_numWorkGroupShaderY);
-
-    for (std::pair<std::string, std::string>& definePair : defines)
+    // the baked mode's playback samples the loop instead of running the waves
+    ShaderMacros shaderMacros;
+    if (params.baked)
     {
-        shaderc_compile_options_add_macro_definition(compileOptions, 
-            definePair.first.c_str(), static_cast<size_t>(definePair.first.size()), 
-            definePair.second.c_str(), static_cast<size_t>(definePair.second.size()));
+        shaderMacros.push_back({ "WATER_BAKED", "" });
     }
 
-    result = Game::Get()->CompileShaderFromDisk("data/shader_src/water.comp", shaderc_glsl_compute_shader, &waterComputePass.shaderModule, compileOptions);
+    result = Game::Get()->LoadShader("data/shader_src/water.comp", shaderc_glsl_compute_shader, &waterComputePass.shaderModule, shaderMacros);
     DUCK_DEMO_VULKAN_ASSERT(result);
     if (result != VK_SUCCESS)
     {
         return false;
     }
 
+    // the workgroup size can be retuned here without touching the glsl
+    ShaderSpecialization specialization;
+    Set_ShaderSpecialization(specialization, WaterComputeConstant_LocalSizeX, c_numWorkGroupShaderX);
+    Set_ShaderSpecialization(specialization, WaterComputeConstant_LocalSizeY, c_numWorkGroupShaderY);
+
     VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfo;
     pipelineShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     pipelineShaderStageCreateInfo.pNext = nullptr;
@@ -350,7 +634,7 @@ bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComput
     pipelineShaderStageCreateInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
     pipelineShaderStageCreateInfo.module = waterComputePass.shaderModule;
     pipelineShaderStageCreateInfo.pName = "main";
-    pipelineShaderStageCreateInfo.pSpecializationInfo = nullptr;
+    pipelineShaderStageCreateInfo.pSpecializationInfo = GetInfo_ShaderSpecialization(specialization);
 
     VkComputePipelineCreateInfo computePipelineCreateInfo;
     computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
@@ -361,7 +645,7 @@ bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComput
     computePipelineCreateInfo.basePipelineHandle = nullptr;
     computePipelineCreateInfo.basePipelineIndex = 0;
 
-    result = vkCreateComputePipelines(Game::Get()->GetVulkanDevice(), nullptr, 1, &computePipelineCreateInfo, s_allocator, &waterComputePass.pipeline);
+    result = Game::Get()->CreateVulkanComputePipeline(computePipelineCreateInfo, &waterComputePass.pipeline);
     DUCK_DEMO_VULKAN_ASSERT(result);
     if (result != VK_SUCCESS)
     {
@@ -386,53 +670,29 @@ bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComput
     commandBufferAllocateInfo.pNext = nullptr;
     commandBufferAllocateInfo.commandPool = waterComputePass.commandPool;
     commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    commandBufferAllocateInfo.commandBufferCount = 1;
+    commandBufferAllocateInfo.commandBufferCount = framesInFlightCount;
 
-    result = vkAllocateCommandBuffers(Game::Get()->GetVulkanDevice(), &commandBufferAllocateInfo, &waterComputePass.commandBuffer);
+    result = vkAllocateCommandBuffers(Game::Get()->GetVulkanDevice(), &commandBufferAllocateInfo, waterComputePass.commandBuffers.data());
     DUCK_DEMO_VULKAN_ASSERT(result);
     if (result != VK_SUCCESS)
     {
         return false;
     }
 
-    VkSemaphoreCreateInfo semaphoreCreateInfo;
-    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext = nullptr;
-    semaphoreCreateInfo.flags = 0;
-    result = vkCreateSemaphore(Game::Get()->GetVulkanDevice(), &semaphoreCreateInfo, s_allocator, &waterComputePass.semaphore);
-    DUCK_DEMO_VULKAN_ASSERT(result);
-    if (result != VK_SUCCESS)
+    for (uint32_t frameIndex = 0; frameIndex < framesInFlightCount; ++frameIndex)
     {
-        return false;
-    }
-
-    VkQueue computeQueue = VK_NULL_HANDLE;
-    vkGetDeviceQueue(Game::Get()->GetVulkanDevice(), Game::Get()->GetVulkanComputeQueueIndex(), 0, &computeQueue);
-
-    VkSubmitInfo submitInfo;
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pNext = nullptr;
-    submitInfo.waitSemaphoreCount = 0;
-    submitInfo.pWaitSemaphores = VK_NULL_HANDLE;
-    submitInfo.pWaitDstStageMask = VK_NULL_HANDLE;
-    submitInfo.commandBufferCount = 0;
-    submitInfo.pCommandBuffers = VK_NULL_HANDLE;
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &waterComputePass.semaphore;
-    result = vkQueueSubmit(computeQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    DUCK_DEMO_VULKAN_ASSERT(result);
-    if (result != VK_SUCCESS)
-    {
-        return false;
+        VkSemaphoreCreateInfo semaphoreCreateInfo;
+        semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreCreateInfo.pNext = nullptr;
+        semaphoreCreateInfo.flags = 0;
+        result = vkCreateSemaphore(Game::Get()->GetVulkanDevice(), &semaphoreCreateInfo, s_allocator, &waterComputePass.semaphores[frameIndex]);
+        DUCK_DEMO_VULKAN_ASSERT(result);
+        if (result != VK_SUCCESS)
+        {
+            return false;
+        }
     }
 
-    result = vkQueueWaitIdle(computeQueue);
-    DUCK_DEMO_VULKAN_ASSERT(result);
-    if (result != VK_SUCCESS)
-    {
-        return false;
-    }
-  
     waterComputePass.workGroupDispatchX = params.width / c_numWorkGroupShaderX;
     waterComputePass.workGroupDispatchY = params.width / c_numWorkGroupShaderY;
 
@@ -445,19 +705,30 @@ bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComput
         DUCK_DEMO_ASSERT(false);
     }
 
+    if (params.baked && !InitBaked_WaterComputePass(waterComputePass, params))
+    {
+        return false;
+    }
+
     return true;
 }
 
 void Free_WaterComputePass(WaterComputePass& waterComputePass)
 {
-    if (waterComputePass.semaphore != VK_NULL_HANDLE)
+    for (VkSemaphore semaphore : waterComputePass.semaphores)
     {
-        vkDestroySemaphore(Game::Get()->GetVulkanDevice(), waterComputePass.semaphore, s_allocator);
+        if (semaphore != VK_NULL_HANDLE)
+        {
+            vkDestroySemaphore(Game::Get()->GetVulkanDevice(), semaphore, s_allocator);
+        }
     }
 
-    if (waterComputePass.commandBuffer != VK_NULL_HANDLE)
+    for (VkCommandBuffer commandBuffer : waterComputePass.commandBuffers)
     {
-        vkFreeCommandBuffers(Game::Get()->GetVulkanDevice(), waterComputePass.commandPool, 1, &waterComputePass.commandBuffer);
+        if (commandBuffer != VK_NULL_HANDLE)
+        {
+            vkFreeCommandBuffers(Game::Get()->GetVulkanDevice(), waterComputePass.commandPool, 1, &commandBuffer);
+        }
     }
 
     if (waterComputePass.commandPool != VK_NULL_HANDLE)
@@ -476,6 +747,23 @@ void Free_WaterComputePass(WaterComputePass& waterComputePass)
         vkDestroyShaderModule(Game::Get()->GetVulkanDevice(), waterComputePass.shaderModule, s_allocator);
     }
 
+    if (waterComputePass.bakedSampler != VK_NULL_HANDLE)
+    {
+        vkDestroySampler(Game::Get()->GetVulkanDevice(), waterComputePass.bakedSampler, s_allocator);
+    }
+
+    if (waterComputePass.bakedImageView != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(Game::Get()->GetVulkanDevice(), waterComputePass.bakedImageView, s_allocator);
+    }
+
+    Deallocate_VulkanMemoryAllocator(Game::Get()->GetVulkanMemoryAllocator(), waterComputePass.bakedAllocation);
+
+    if (waterComputePass.bakedImage != VK_NULL_HANDLE)
+    {
+        vkDestroyImage(Game::Get()->GetVulkanDevice(), waterComputePass.bakedImage, s_allocator);
+    }
+
     for (VkImageView& imageView : waterComputePass.imageViews)
     {
         if (imageView != VK_NULL_HANDLE)
@@ -484,12 +772,9 @@ void Free_WaterComputePass(WaterComputePass& waterComputePass)
         }
     }
 
-    for (VkDeviceMemory& deviceMemory : waterComputePass.deviceMemories)
+    for (VulkanAllocation& allocation : waterComputePass.allocations)
     {
-        if (deviceMemory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(Game::Get()->GetVulkanDevice(), deviceMemory, s_allocator);
-        }
+        Deallocate_VulkanMemoryAllocator(Game::Get()->GetVulkanMemoryAllocator(), allocation);
     }
 
     for (VkImage& image : waterComputePass.images)
@@ -508,6 +793,19 @@ void Free_WaterComputePass(WaterComputePass& waterComputePass)
         }
     }
 
+    for (VkDescriptorSet descriptorSet : waterComputePass.waveBufDescriptorSets)
+    {
+        if (descriptorSet != VK_NULL_HANDLE)
+        {
+            vkFreeDescriptorSets(Game::Get()->GetVulkanDevice(), waterComputePass.descriptorPool, 1, &descriptorSet);
+        }
+    }
+
+    if (waterComputePass.bakedDescriptorSet != VK_NULL_HANDLE)
+    {
+        vkFreeDescriptorSets(Game::Get()->GetVulkanDevice(), waterComputePass.descriptorPool, 1, &waterComputePass.bakedDescriptorSet);
+    }
+
     if (waterComputePass.pipelineLayout != VK_NULL_HANDLE)
     {
         vkDestroyPipelineLayout(Game::Get()->GetVulkanDevice(), waterComputePass.pipelineLayout, s_allocator);
@@ -526,13 +824,16 @@ void Free_WaterComputePass(WaterComputePass& waterComputePass)
         vkDestroyDescriptorPool(Game::Get()->GetVulkanDevice(), waterComputePass.descriptorPool, s_allocator);
     }
 
-    waterComputePass.waveBufBuffer.Reset();
+    for (VulkanBuffer& waveBufBuffer : waterComputePass.waveBufBuffers)
+    {
+        waveBufBuffer.Reset();
+    }
 }
 
 void Update_WaterComputePass(WaterComputePass& waterComputePass, const double deltaTime)
 {
     waterComputePass.waveBuf.Time += static_cast<float>(deltaTime);
-    UpdateWaveBuf(waterComputePass);
+    UpdateWaveBuf(waterComputePass, Game::Get()->GetCurrentFrameIndex());
 }
 
 void Compute_WaterComputePass(WaterComputePass& waterComputePass)
@@ -544,104 +845,96 @@ void Compute_WaterComputePass(WaterComputePass& waterComputePass)
         waterComputePass.nextImageOffset = temp;
     }
 
+    const uint32_t frameIndex = Game::Get()->GetCurrentFrameIndex();
+    const uint32_t graphicsQueueIndex = Game::Get()->GetVulkanGraphicsQueueIndex();
+    const uint32_t computeQueueIndex = Game::Get()->GetVulkanComputeQueueIndex();
+    VkCommandBuffer commandBuffer = waterComputePass.commandBuffers[frameIndex];
+
     VkCommandBufferBeginInfo commandBufferBeginInfo;
     commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     commandBufferBeginInfo.pNext = nullptr;
-    commandBufferBeginInfo.flags = 0;
+    commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     commandBufferBeginInfo.pInheritanceInfo = nullptr;
 
-    DUCK_DEMO_VULKAN_ASSERT(vkBeginCommandBuffer(waterComputePass.commandBuffer, &commandBufferBeginInfo));
+    DUCK_DEMO_VULKAN_ASSERT(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
 
-    {
-        VkImageSubresourceRange imageSubresourceRange;
-        imageSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        imageSubresourceRange.baseMipLevel = 0;
-        imageSubresourceRange.levelCount = 1;
-        imageSubresourceRange.baseArrayLayer = 0;
-        imageSubresourceRange.layerCount = 1;
+    BeginScope_GpuProfiler(Game::Get()->GetGpuProfiler(), commandBuffer, frameIndex, GpuProfilerScope_WaterCompute);
 
-        std::array<VkImageMemoryBarrier, 3> imageMemoryBarriers;
-        {
-            VkImageMemoryBarrier& imageMemoryBarrier = imageMemoryBarriers[0];
-            imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            imageMemoryBarrier.pNext = nullptr;
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_NONE;
-            imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-            imageMemoryBarrier.srcQueueFamilyIndex = Game::Get()->GetVulkanGraphicsQueueIndex();
-            imageMemoryBarrier.dstQueueFamilyIndex = Game::Get()->GetVulkanComputeQueueIndex();
-            imageMemoryBarrier.image = waterComputePass.images[waterComputePass.prevImageOffset];
-            imageMemoryBarrier.subresourceRange = imageSubresourceRange;
-        }        
+    VkImageSubresourceRange imageSubresourceRange;
+    imageSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageSubresourceRange.baseMipLevel = 0;
+    imageSubresourceRange.levelCount = 1;
+    imageSubresourceRange.baseArrayLayer = 0;
+    imageSubresourceRange.layerCount = 1;
 
-        {
-            VkImageMemoryBarrier& imageMemoryBarrier = imageMemoryBarriers[1];
-            imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            imageMemoryBarrier.pNext = nullptr;
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_NONE;
-            imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-            imageMemoryBarrier.srcQueueFamilyIndex = Game::Get()->GetVulkanGraphicsQueueIndex();
-            imageMemoryBarrier.dstQueueFamilyIndex = Game::Get()->GetVulkanComputeQueueIndex();
-            imageMemoryBarrier.image = waterComputePass.images[waterComputePass.currentImageOffset];
-            imageMemoryBarrier.subresourceRange = imageSubresourceRange;
-        }  
-        
-        {
-            VkImageMemoryBarrier& imageMemoryBarrier = imageMemoryBarriers[2];
-            imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            imageMemoryBarrier.pNext = nullptr;
-            imageMemoryBarrier.srcAccessMask = VK_ACCESS_NONE;
-            imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-            imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-            imageMemoryBarrier.srcQueueFamilyIndex = Game::Get()->GetVulkanGraphicsQueueIndex();
-            imageMemoryBarrier.dstQueueFamilyIndex = Game::Get()->GetVulkanComputeQueueIndex();
-            imageMemoryBarrier.image = waterComputePass.images[waterComputePass.nextImageOffset];
-            imageMemoryBarrier.subresourceRange = imageSubresourceRange;
-        }  
+    {
+        // the next image was last sampled by the graphics frame that used this frame index, the fence wait in
+        // Game::WaitForCurrentFrame already guarantees that work is done. the shader overwrites every texel so the
+        // old contents are discarded, which lets us skip an ownership transfer back from the graphics queue
+        VkImageMemoryBarrier imageMemoryBarrier;
+        imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageMemoryBarrier.pNext = nullptr;
+        imageMemoryBarrier.srcAccessMask = VK_ACCESS_NONE;
+        imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageMemoryBarrier.image = waterComputePass.images[waterComputePass.nextImageOffset];
+        imageMemoryBarrier.subresourceRange = imageSubresourceRange;
 
-        vkCmdPipelineBarrier(waterComputePass.commandBuffer, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(imageMemoryBarriers.size()), imageMemoryBarriers.data());
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
     }
 
-    vkCmdBindPipeline(waterComputePass.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, waterComputePass.pipeline);
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, waterComputePass.pipeline);
 
-    vkCmdBindDescriptorSets(waterComputePass.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, waterComputePass.pipelineLayout, waterComputePass.prevImageOffset, 1, &waterComputePass.descriptorSets[0], 0, nullptr);
-    vkCmdBindDescriptorSets(waterComputePass.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, waterComputePass.pipelineLayout, waterComputePass.currentImageOffset, 1, &waterComputePass.descriptorSets[1], 0, nullptr);
-    vkCmdBindDescriptorSets(waterComputePass.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, waterComputePass.pipelineLayout, waterComputePass.nextImageOffset, 1, &waterComputePass.descriptorSets[2], 0, nullptr);
-    vkCmdBindDescriptorSets(waterComputePass.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, waterComputePass.pipelineLayout, 3, 1, &waterComputePass.descriptorSets[3], 0, nullptr);
+    // sets 0 and 1 only keep the layout's set numbers, water.comp reads neither of the older images and they've
+    // already been released to the graphics queue
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, waterComputePass.pipelineLayout, 2, 1, &waterComputePass.descriptorSets[waterComputePass.nextImageOffset], 0, nullptr);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, waterComputePass.pipelineLayout, 3, 1, &waterComputePass.waveBufDescriptorSets[frameIndex], 0, nullptr);
+    if (waterComputePass.baked)
+    {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, waterComputePass.pipelineLayout, 4, 1, &waterComputePass.bakedDescriptorSet, 0, nullptr);
+    }
 
-    vkCmdDispatch(waterComputePass.commandBuffer, waterComputePass.workGroupDispatchX, waterComputePass.workGroupDispatchY, 1);
+    vkCmdDispatch(commandBuffer, waterComputePass.workGroupDispatchX, waterComputePass.workGroupDispatchY, 1);
 
     {
-        VkImageSubresourceRange imageSubresourceRange;
-        imageSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        imageSubresourceRange.baseMipLevel = 0;
-        imageSubresourceRange.levelCount = 1;
-        imageSubresourceRange.baseArrayLayer = 0;
-        imageSubresourceRange.layerCount = 1;
-
+        // release half of the ownership transfer, Acquire_WaterComputePass records the matching acquire on the graphics queue.
+        // when both queues come from the same family this is just a regular barrier into the water's vertex and fragment shaders
         VkImageMemoryBarrier imageMemoryBarrier;
         imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         imageMemoryBarrier.pNext = nullptr;
         imageMemoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_NONE;
         imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
         imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        imageMemoryBarrier.srcQueueFamilyIndex = Game::Get()->GetVulkanComputeQueueIndex();
-        imageMemoryBarrier.dstQueueFamilyIndex = Game::Get()->GetVulkanGraphicsQueueIndex();
         imageMemoryBarrier.image = waterComputePass.images[waterComputePass.nextImageOffset];
         imageMemoryBarrier.subresourceRange = imageSubresourceRange;
 
-        vkCmdPipelineBarrier(waterComputePass.commandBuffer, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
+        VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        if (graphicsQueueIndex != computeQueueIndex)
+        {
+            imageMemoryBarrier.dstAccessMask = VK_ACCESS_NONE;
+            imageMemoryBarrier.srcQueueFamilyIndex = computeQueueIndex;
+            imageMemoryBarrier.dstQueueFamilyIndex = graphicsQueueIndex;
+            dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        }
+        else
+        {
+            imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        }
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
     }
 
-    vkEndCommandBuffer(waterComputePass.commandBuffer);
+    EndScope_GpuProfiler(Game::Get()->GetGpuProfiler(), commandBuffer, frameIndex, GpuProfilerScope_WaterCompute);
+
+    DUCK_DEMO_VULKAN_ASSERT(vkEndCommandBuffer(commandBuffer));
 
     VkQueue computeQueue = VK_NULL_HANDLE;
-    vkGetDeviceQueue(Game::Get()->GetVulkanDevice(), Game::Get()->GetVulkanComputeQueueIndex(), 0, &computeQueue);
+    vkGetDeviceQueue(Game::Get()->GetVulkanDevice(), computeQueueIndex, 0, &computeQueue);
 
     VkSubmitInfo submitInfo;
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -650,12 +943,48 @@ void Compute_WaterComputePass(WaterComputePass& waterComputePass)
     submitInfo.pWaitSemaphores = nullptr;
     submitInfo.pWaitDstStageMask = nullptr;
     submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &waterComputePass.commandBuffer;
-    submitInfo.signalSemaphoreCount = 0;
-    submitInfo.pSignalSemaphores = nullptr;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &waterComputePass.semaphores[frameIndex];
 
     DUCK_DEMO_VULKAN_ASSERT(vkQueueSubmit(computeQueue, 1, &submitInfo, VK_NULL_HANDLE));
-    DUCK_DEMO_VULKAN_ASSERT(vkQueueWaitIdle(computeQueue));
+
+    // the graphics submit of this frame won't start sampling the heightmap until the simulation has finished
+    Game::Get()->AddRenderWaitSemaphore(waterComputePass.semaphores[frameIndex], VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+}
+
+void Acquire_WaterComputePass(WaterComputePass& waterComputePass, VkCommandBuffer commandBuffer)
+{
+    const uint32_t graphicsQueueIndex = Game::Get()->GetVulkanGraphicsQueueIndex();
+    const uint32_t computeQueueIndex = Game::Get()->GetVulkanComputeQueueIndex();
+    if (graphicsQueueIndex == computeQueueIndex)
+    {
+        return;
+    }
+
+    VkImageSubresourceRange imageSubresourceRange;
+    imageSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    imageSubresourceRange.baseMipLevel = 0;
+    imageSubresourceRange.levelCount = 1;
+    imageSubresourceRange.baseArrayLayer = 0;
+    imageSubresourceRange.layerCount = 1;
+
+    VkImageMemoryBarrier imageMemoryBarrier;
+    imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageMemoryBarrier.pNext = nullptr;
+    imageMemoryBarrier.srcAccessMask = VK_ACCESS_NONE;
+    imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageMemoryBarrier.srcQueueFamilyIndex = computeQueueIndex;
+    imageMemoryBarrier.dstQueueFamilyIndex = graphicsQueueIndex;
+    imageMemoryBarrier.image = waterComputePass.images[waterComputePass.nextImageOffset];
+    imageMemoryBarrier.subresourceRange = imageSubresourceRange;
+
+    // the source stages are the ones the graphics submit waits on the compute semaphore at, so the acquire and its
+    // layout transition are chained after the release instead of being free to run ahead of it
+    const VkPipelineStageFlags stageMask = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    vkCmdPipelineBarrier(commandBuffer, stageMask, stageMask, 0, 0, nullptr, 0, nullptr, 1, &imageMemoryBarrier);
 }
 
 VkImageView GetCurrImageView_WaterComputePass(WaterComputePass& waterComputePass)
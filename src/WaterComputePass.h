@@ -5,6 +5,7 @@
 #include <vulkan/vulkan.h>
 
 #include "DuckDemoUtils.h"
+#include "Game.h"
 #include "VulkanBuffer.h"
 
 struct DUCK_DEMO_ALIGN(16) WaveBuf
@@ -13,31 +14,52 @@ struct DUCK_DEMO_ALIGN(16) WaveBuf
     float Wc2;
     float Wc3;
     float Time;
+    // only read by the baked modes, see WaterComputePassParams
+    float LoopPeriod;
+    uint32_t LoopSliceCount;
+    float BakedTexelScale;
+    float padding0;
 };
 
 constexpr uint32_t c_waterComputePassTextureCount = 3u;
+// water.comp averages waves between e^-2 and 1 and scales them by 200, so heights never go past this
+constexpr float c_waterComputePassMaxHeight = 200.0f;
+// height in r and its gradient along the image's x and y in g and b, in height per texel so it stays in half range
+constexpr VkFormat c_waterComputePassFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+constexpr uint32_t c_waterComputePassTexelSize = 4u * sizeof(uint16_t);
 
 struct WaterComputePass
 {
     VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
-    std::array<VkDescriptorSetLayout, 4> descriptorSetLayouts;
+    // the last one is the baked loop, only bound when it's used
+    std::array<VkDescriptorSetLayout, 5> descriptorSetLayouts;
     VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
-    std::array<VkDescriptorSet, 4> descriptorSets;
+    std::array<VkDescriptorSet, c_waterComputePassTextureCount> descriptorSets = {};
+    std::array<VkDescriptorSet, c_maxFramesInFlight> waveBufDescriptorSets = {};
     std::array<VkImage, c_waterComputePassTextureCount> images = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
-    std::array<VkDeviceMemory, c_waterComputePassTextureCount> deviceMemories = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+    std::array<VulkanAllocation, c_waterComputePassTextureCount> allocations;
     std::array<VkImageView, c_waterComputePassTextureCount> imageViews = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
     VkShaderModule shaderModule = VK_NULL_HANDLE;
     VkPipeline pipeline = VK_NULL_HANDLE;
     VkCommandPool commandPool = VK_NULL_HANDLE;
-    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
-    VkSemaphore semaphore = VK_NULL_HANDLE;
+    // one command buffer and semaphore per frame in flight so the simulation of the next frame can be recorded
+    // and submitted while the graphics queue is still consuming the previous one
+    std::array<VkCommandBuffer, c_maxFramesInFlight> commandBuffers = {};
+    std::array<VkSemaphore, c_maxFramesInFlight> semaphores = {};
     uint32_t workGroupDispatchX = 0;
     uint32_t workGroupDispatchY = 0;
     uint32_t prevImageOffset = 0;
     uint32_t currentImageOffset = 1;
     uint32_t nextImageOffset = 2;
-    VulkanBuffer waveBufBuffer;
+    std::array<VulkanBuffer, c_maxFramesInFlight> waveBufBuffers;
     WaveBuf waveBuf;
+    // a looping period of the waves written once at init, each frame then only blends two of its slices
+    bool baked = false;
+    VkImage bakedImage = VK_NULL_HANDLE;
+    VulkanAllocation bakedAllocation;
+    VkImageView bakedImageView = VK_NULL_HANDLE;
+    VkSampler bakedSampler = VK_NULL_HANDLE;
+    VkDescriptorSet bakedDescriptorSet = VK_NULL_HANDLE;
 };
 
 struct WaterComputePassParams
@@ -45,6 +67,13 @@ struct WaterComputePassParams
     uint32_t width = 1024;
     float speed = 4.0f;
     float damping = 0.2f;
+    // trades bakedWidth * bakedWidth * bakedSliceCount texels of memory, 64mb with the defaults, for the 40 octaves
+    // of waves every texel of every frame, the wave speeds get rounded so the loop closes
+    bool baked = false;
+    uint32_t bakedWidth = 512;
+    uint32_t bakedSliceCount = 32;
+    // the slowest waves turn exactly twice in this, the rest are rounded to whole turns
+    float bakedPeriod = 6.2831853f;
 };
 
 bool Init_WaterComputePass(WaterComputePass& waterComputePass, const WaterComputePassParams& params);
@@ -52,4 +81,6 @@ void Free_WaterComputePass(WaterComputePass& waterComputePass);
 
 void Update_WaterComputePass(WaterComputePass& waterComputePass, const double deltaTime);
 void Compute_WaterComputePass(WaterComputePass& waterComputePass);
+// must be recorded on the graphics command buffer before anything samples GetCurrImageView_WaterComputePass
+void Acquire_WaterComputePass(WaterComputePass& waterComputePass, VkCommandBuffer commandBuffer);
 VkImageView GetCurrImageView_WaterComputePass(WaterComputePass& waterComputePass);
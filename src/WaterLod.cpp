@@ -0,0 +1,113 @@
+#include "WaterLod.h"
+
+#include <algorithm>
+#include <cmath>
+
+struct WaterLodSelection
+{
+    const WaterLodParams* m_params;
+    glm::vec3 m_cameraPosition;
+    // xyz is the plane normal pointing into the frustum and w its distance
+    glm::vec4 m_frustumPlanes[6];
+    float m_ranges[32];
+    std::vector<WaterPatch>* m_patches;
+    WaterLodStats* m_stats;
+};
+
+static bool IsOutsideFrustum(const WaterLodSelection& selection, const float x, const float z, const float size)
+{
+    const glm::vec3 boundsMin = glm::vec3(x, 0.0f, z);
+    const glm::vec3 boundsMax = glm::vec3(x + size, selection.m_params->m_maxHeight, z + size);
+
+    for (const glm::vec4& plane : selection.m_frustumPlanes)
+    {
+        // the corner furthest along the plane's normal, if even that is behind it the whole box is
+        const glm::vec3 corner = glm::vec3(
+            plane.x >= 0.0f ? boundsMax.x : boundsMin.x,
+            plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+            plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static float GetDistance(const glm::vec3& position, const float x, const float z, const float size)
+{
+    // the patch is flat at y 0 so the height is all of the vertical distance
+    const float dx = std::max(std::max(x - position.x, position.x - (x + size)), 0.0f);
+    const float dz = std::max(std::max(z - position.z, position.z - (z + size)), 0.0f);
+    return std::sqrt(dx * dx + position.y * position.y + dz * dz);
+}
+
+static void SelectNode(WaterLodSelection& selection, const float x, const float z, const float size, const uint32_t level)
+{
+    if (IsOutsideFrustum(selection, x, z, size))
+    {
+        ++selection.m_stats->m_culledNodeCount;
+        return;
+    }
+
+    if (level > 0 && GetDistance(selection.m_cameraPosition, x, z, size) <= selection.m_ranges[level - 1])
+    {
+        const float childSize = size * 0.5f;
+        SelectNode(selection, x, z, childSize, level - 1);
+        SelectNode(selection, x + childSize, z, childSize, level - 1);
+        SelectNode(selection, x, z + childSize, childSize, level - 1);
+        SelectNode(selection, x + childSize, z + childSize, childSize, level - 1);
+        return;
+    }
+
+    if (selection.m_patches->size() >= c_waterLodMaxPatchCount)
+    {
+        return;
+    }
+
+    const WaterLodParams& params = *selection.m_params;
+    const float halfSize = params.m_size * 0.5f;
+    const float previousRange = level > 0 ? selection.m_ranges[level - 1] : 0.0f;
+    const float range = selection.m_ranges[level];
+
+    // the uvs run the same way the old single grid's did, u along x and v against z
+    WaterPatch patch;
+    patch.m_originSize = glm::vec4(x, z, size, 0.0f);
+    patch.m_uvOriginScale = glm::vec4((x + halfSize) / params.m_size, (halfSize - z) / params.m_size, size / params.m_size, -size / params.m_size);
+    patch.m_morphRange = glm::vec2(previousRange + (range - previousRange) * params.m_morphStart, range);
+    selection.m_patches->push_back(patch);
+    ++selection.m_stats->m_visiblePatchCount;
+}
+
+void Select_WaterLod(const WaterLodParams& waterLodParams, const glm::vec3& cameraPosition, const glm::mat4& clipFromObject, std::vector<WaterPatch>& outPatches, WaterLodStats& outStats)
+{
+    outPatches.clear();
+    outStats = WaterLodStats();
+
+    WaterLodSelection selection;
+    selection.m_params = &waterLodParams;
+    selection.m_cameraPosition = cameraPosition;
+    selection.m_patches = &outPatches;
+    selection.m_stats = &outStats;
+
+    // planes straight out of the clip matrix rows, the near plane is the -w <= z one which is a little
+    // looser than vulkan's 0 <= z but never culls anything that's visible
+    const glm::mat4 clipRows = glm::transpose(clipFromObject);
+    selection.m_frustumPlanes[0] = clipRows[3] + clipRows[0];
+    selection.m_frustumPlanes[1] = clipRows[3] - clipRows[0];
+    selection.m_frustumPlanes[2] = clipRows[3] + clipRows[1];
+    selection.m_frustumPlanes[3] = clipRows[3] - clipRows[1];
+    selection.m_frustumPlanes[4] = clipRows[3] + clipRows[2];
+    selection.m_frustumPlanes[5] = clipRows[3] - clipRows[2];
+
+    const uint32_t levelCount = std::min<uint32_t>(std::max<uint32_t>(waterLodParams.m_levelCount, 1u), 32u);
+    const float leafSize = waterLodParams.m_size / static_cast<float>(1u << (levelCount - 1));
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        selection.m_ranges[level] = waterLodParams.m_rangeScale * leafSize * static_cast<float>(1u << level);
+    }
+
+    const float halfSize = waterLodParams.m_size * 0.5f;
+    SelectNode(selection, -halfSize, -halfSize, waterLodParams.m_size, levelCount - 1);
+}
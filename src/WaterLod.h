@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// quads along each side of the one patch every level is drawn with, has to be even so odd vertices can fold onto even ones
+constexpr uint32_t c_waterPatchQuadCount = 16u;
+// more than a camera in the middle of the plane ever selects, anything past it isn't drawn
+constexpr uint32_t c_waterLodMaxPatchCount = 1024u;
+
+// one instance of the water patch, read through the instance binding of data/shader_src/WaterShader.vert
+struct WaterPatch
+{
+    // x and z of the min corner in the water's object space, the side length, and w unused
+    glm::vec4 m_originSize;
+    // heightmap uv of the min corner in xy and how far it moves across the patch in zw
+    glm::vec4 m_uvOriginScale;
+    // camera distances the odd vertices start and finish folding onto the next coarser level between
+    glm::vec2 m_morphRange;
+};
+
+struct WaterLodParams
+{
+    // the plane is square and centred on the object's origin
+    float m_size = 50000.0f;
+    // level 0 is the finest and has the smallest patches, every level up doubles them until one covers the plane
+    uint32_t m_levelCount = 8;
+    // how far each level reaches in multiples of its patch size, below 4 a patch can reach into the next
+    // level's morph before its own has finished and the levels crack
+    float m_rangeScale = 5.0f;
+    // fraction of the way from the previous level's range to this one's that the morph starts at
+    float m_morphStart = 0.7f;
+    // highest the heightmap lifts the surface above y 0, patch bounds are this tall so waves aren't culled
+    float m_maxHeight = 0.0f;
+};
+
+struct WaterLodStats
+{
+    uint32_t m_visiblePatchCount = 0;
+    // nodes dropped whole against the frustum, each of them can stand for a lot of patches
+    uint32_t m_culledNodeCount = 0;
+};
+
+// camera centred quadtree in the style of cdlod, a patch is split while it's within the next finer level's range,
+// clipFromObject takes the water's object space to clip space and nodes entirely outside it are skipped
+void Select_WaterLod(const WaterLodParams& waterLodParams, const glm::vec3& cameraPosition, const glm::mat4& clipFromObject, std::vector<WaterPatch>& outPatches, WaterLodStats& outStats);
@@ -5,6 +5,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include "Game.h"
 #include "VulkanBuffer.h"
 #include "RenderObject.h"
 
@@ -14,14 +15,13 @@ struct WaterRenderPass
     VkRenderPass m_vulkanRenderPass = VK_NULL_HANDLE;
     VkDescriptorPool m_vulkanDescriptorPool = VK_NULL_HANDLE;
     std::array<VkDescriptorSetLayout, 5> m_vulkanDescriptorSetLayouts = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
-    std::array<VkDescriptorSet, 5> m_vulkanDescriptorSets = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+    // descriptor sets are duplicated per frame in flight, frameBuf and objectBuf point into the game's uniform ring and are picked with dynamic offsets
+    std::array<std::array<VkDescriptorSet, 5>, c_maxFramesInFlight> m_vulkanDescriptorSets = {};
     VkPipelineLayout m_vulkanPipelineLayout = VK_NULL_HANDLE;
     VkShaderModule m_vertexShader = VK_NULL_HANDLE;
     VkShaderModule m_fragmentShader = VK_NULL_HANDLE;
     VkPipeline m_vulkanPipeline = VK_NULL_HANDLE;
     VkSampler m_vulkanSampler = VK_NULL_HANDLE;
-    VulkanBuffer m_vulkanFrameBuffer;
-    VulkanBuffer m_vulkanObjectBuffer;
 };
 
 struct WaterRenderPassParams
@@ -34,6 +34,7 @@ bool Init_WaterRenderPass(WaterRenderPass& waterRenderPass, const WaterRenderPas
 void Free_WaterRenderPass(WaterRenderPass& waterRenderPass);
 
 void Resize_WaterRenderPass(WaterRenderPass& waterRenderPass);
-void Render_WaterRenderPass(WaterRenderPass& waterRenderPass, VkCommandBuffer commandBuffer, const std::vector<RenderObject>& renderObjects);
+// frameBufOffset is the uniform ring offset the frame's FrameBuf was pushed at
+void Render_WaterRenderPass(WaterRenderPass& waterRenderPass, VkCommandBuffer commandBuffer, const uint32_t frameBufOffset, const std::vector<RenderObject>& renderObjects);
 
 void SetWaterImageView_WaterRenderPass(WaterRenderPass& waterRenderPass, VkImageView imageView);
@@ -0,0 +1,255 @@
+#include "BlockEncoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#define STB_DXT_IMPLEMENTATION
+#include "stb_dxt.h"
+
+constexpr uint32_t c_blockTexelCount = 16;
+
+// axis the block's colours spread along the most, found with a few rounds of power iteration on the covariance
+static void FindPrincipalAxis(const uint8_t* texels, std::array<float, 4>& OutMean, std::array<float, 4>& OutAxis)
+{
+    OutMean.fill(0.0f);
+    for (uint32_t i = 0; i < c_blockTexelCount; ++i)
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            OutMean[c] += texels[i * 4 + c];
+        }
+    }
+    for (float& mean : OutMean)
+    {
+        mean /= c_blockTexelCount;
+    }
+
+    std::array<float, 16> covariance;
+    covariance.fill(0.0f);
+    for (uint32_t i = 0; i < c_blockTexelCount; ++i)
+    {
+        for (uint32_t a = 0; a < 4; ++a)
+        {
+            for (uint32_t b = 0; b < 4; ++b)
+            {
+                covariance[a * 4 + b] += (texels[i * 4 + a] - OutMean[a]) * (texels[i * 4 + b] - OutMean[b]);
+            }
+        }
+    }
+
+    OutAxis.fill(1.0f);
+    for (uint32_t iteration = 0; iteration < 8; ++iteration)
+    {
+        std::array<float, 4> next;
+        next.fill(0.0f);
+        for (uint32_t a = 0; a < 4; ++a)
+        {
+            for (uint32_t b = 0; b < 4; ++b)
+            {
+                next[a] += covariance[a * 4 + b] * OutAxis[b];
+            }
+        }
+
+        float length = 0.0f;
+        for (const float value : next)
+        {
+            length += value * value;
+        }
+        length = std::sqrt(length);
+        if (length < 1e-6f)
+        {
+            // every texel is the same colour
+            break;
+        }
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            OutAxis[c] = next[c] / length;
+        }
+    }
+}
+
+// the two ends of the block's colours along the principal axis
+static void FindEndpoints(const uint8_t* texels, std::array<float, 4>& OutLow, std::array<float, 4>& OutHigh)
+{
+    std::array<float, 4> mean;
+    std::array<float, 4> axis;
+    FindPrincipalAxis(texels, mean, axis);
+
+    float minProjection = 0.0f;
+    float maxProjection = 0.0f;
+    for (uint32_t i = 0; i < c_blockTexelCount; ++i)
+    {
+        float projection = 0.0f;
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            projection += (texels[i * 4 + c] - mean[c]) * axis[c];
+        }
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        OutLow[c] = std::min(std::max(mean[c] + axis[c] * minProjection, 0.0f), 255.0f);
+        OutHigh[c] = std::min(std::max(mean[c] + axis[c] * maxProjection, 0.0f), 255.0f);
+    }
+}
+
+static uint32_t GetDistance(const uint8_t* texel, const std::array<int32_t, 4>& colour)
+{
+    uint32_t distance = 0;
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        const int32_t delta = texel[c] - colour[c];
+        distance += static_cast<uint32_t>(delta * delta);
+    }
+    return distance;
+}
+
+// appends bits lowest first, which is how the bc formats are laid out
+class BlockBitWriter
+{
+public:
+    explicit BlockBitWriter(uint8_t* block, const uint32_t blockSize)
+        : m_block(block)
+    {
+        memset(m_block, 0, blockSize);
+    }
+
+    void Write(const uint32_t value, const uint32_t bitCount)
+    {
+        for (uint32_t i = 0; i < bitCount; ++i)
+        {
+            if ((value >> i) & 1u)
+            {
+                m_block[m_position >> 3] |= static_cast<uint8_t>(1u << (m_position & 7u));
+            }
+            ++m_position;
+        }
+    }
+
+private:
+    uint8_t* m_block;
+    uint32_t m_position = 0;
+};
+
+void EncodeBC1_BlockEncoder(const uint8_t* texels, uint8_t* block)
+{
+    stb_compress_dxt_block(block, texels, 0, STB_DXT_HIGHQUAL);
+}
+
+void EncodeBC5_BlockEncoder(const uint8_t* texels, uint8_t* block)
+{
+    uint8_t redGreen[c_blockTexelCount * 2];
+    for (uint32_t i = 0; i < c_blockTexelCount; ++i)
+    {
+        redGreen[i * 2 + 0] = texels[i * 4 + 0];
+        redGreen[i * 2 + 1] = texels[i * 4 + 1];
+    }
+    stb_compress_bc5_block(block, redGreen);
+}
+
+// stb_dxt stops at bc5, bc7 is done here
+constexpr std::array<int32_t, 16> c_bc7Weights4 = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BC7Mode6Candidate
+{
+    // 7 bit endpoint values, the p bit is their shared lowest bit
+    std::array<std::array<uint32_t, 4>, 2> m_endpoints;
+    std::array<uint32_t, 2> m_pBits;
+    std::array<uint32_t, c_blockTexelCount> m_indices;
+    uint64_t m_error = 0;
+};
+
+static void EvaluateBC7Mode6(const uint8_t* texels, const std::array<float, 4>& low, const std::array<float, 4>& high, const uint32_t pBit0, const uint32_t pBit1, BC7Mode6Candidate& OutCandidate)
+{
+    const std::array<const std::array<float, 4>*, 2> endpoints = { &low, &high };
+    const std::array<uint32_t, 2> pBits = { pBit0, pBit1 };
+    std::array<std::array<int32_t, 4>, 2> decoded;
+    for (uint32_t e = 0; e < 2; ++e)
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            const float value = ((*endpoints[e])[c] - pBits[e]) * 0.5f;
+            const uint32_t quantized = static_cast<uint32_t>(std::min(std::max(value + 0.5f, 0.0f), 127.0f));
+            OutCandidate.m_endpoints[e][c] = quantized;
+            decoded[e][c] = static_cast<int32_t>((quantized << 1) | pBits[e]);
+        }
+    }
+    OutCandidate.m_pBits = pBits;
+
+    std::array<std::array<int32_t, 4>, 16> palette;
+    for (uint32_t index = 0; index < 16; ++index)
+    {
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            palette[index][c] = ((64 - c_bc7Weights4[index]) * decoded[0][c] + c_bc7Weights4[index] * decoded[1][c] + 32) >> 6;
+        }
+    }
+
+    OutCandidate.m_error = 0;
+    for (uint32_t i = 0; i < c_blockTexelCount; ++i)
+    {
+        uint32_t bestIndex = 0;
+        uint32_t bestDistance = UINT32_MAX;
+        for (uint32_t index = 0; index < 16; ++index)
+        {
+            const uint32_t distance = GetDistance(texels + i * 4, palette[index]);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                bestIndex = index;
+            }
+        }
+        OutCandidate.m_indices[i] = bestIndex;
+        OutCandidate.m_error += bestDistance;
+    }
+}
+
+void EncodeBC7_BlockEncoder(const uint8_t* texels, uint8_t* block)
+{
+    std::array<float, 4> low;
+    std::array<float, 4> high;
+    FindEndpoints(texels, low, high);
+
+    // the p bits double the endpoint precision, all four combinations are cheap enough to just try
+    BC7Mode6Candidate best;
+    best.m_error = UINT64_MAX;
+    for (uint32_t pBits = 0; pBits < 4; ++pBits)
+    {
+        BC7Mode6Candidate candidate;
+        EvaluateBC7Mode6(texels, low, high, pBits & 1u, pBits >> 1, candidate);
+        if (candidate.m_error < best.m_error)
+        {
+            best = candidate;
+        }
+    }
+
+    // the first index is stored without its top bit so it has to be below 8, swapping the endpoints flips every index
+    if (best.m_indices[0] >= 8)
+    {
+        std::swap(best.m_endpoints[0], best.m_endpoints[1]);
+        std::swap(best.m_pBits[0], best.m_pBits[1]);
+        for (uint32_t& index : best.m_indices)
+        {
+            index = 15 - index;
+        }
+    }
+
+    BlockBitWriter writer(block, 16);
+    // mode 6 is six zero bits and a one
+    writer.Write(1u << 6, 7);
+    for (uint32_t c = 0; c < 4; ++c)
+    {
+        writer.Write(best.m_endpoints[0][c], 7);
+        writer.Write(best.m_endpoints[1][c], 7);
+    }
+    writer.Write(best.m_pBits[0], 1);
+    writer.Write(best.m_pBits[1], 1);
+    for (uint32_t i = 0; i < c_blockTexelCount; ++i)
+    {
+        writer.Write(best.m_indices[i], i == 0 ? 3 : 4);
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// texels are the 16 rgba8 texels of a 4x4 block row by row, block gets the encoded bytes
+
+// 8 bytes, rgb only, through stb_dxt
+void EncodeBC1_BlockEncoder(const uint8_t* texels, uint8_t* block);
+// 16 bytes, red and green as two bc4 blocks, through stb_dxt
+void EncodeBC5_BlockEncoder(const uint8_t* texels, uint8_t* block);
+// 16 bytes, only mode 6 (one subset, rgba endpoints, 4 bit indices). it's the mode that suits smooth colour best and
+// keeps the encoder small, a full search over every mode would be a lot slower for little gain on these textures
+void EncodeBC7_BlockEncoder(const uint8_t* texels, uint8_t* block);
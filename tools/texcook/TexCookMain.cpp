@@ -0,0 +1,320 @@
+// duck_texcook [--force] [directory]
+//
+// cooks every png under directory (data by default) into a .ddtex next to it with a full mip chain in a bc format
+// picked from the file name, the game loads the .ddtex instead of the png whenever it's there. files already cooked
+// from the png as it is now are skipped unless --force is given
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "MipChain.h"
+#include "TextureContainer.h"
+
+#include "BlockEncoder.h"
+
+namespace fs = std::filesystem;
+
+enum TexCookUsage
+{
+    TexCookUsage_Diffuse = 0,
+    TexCookUsage_Normal,
+    TexCookUsage_Specular,
+};
+
+static const char* c_texCookUsageNames[] = { "diffuse", "normal", "specular" };
+
+// the data folder names them FloorTilesNormal, FloorTilesSpacular and so on
+static TexCookUsage GetUsage(const fs::path& path)
+{
+    std::string name = path.stem().string();
+    std::transform(name.begin(), name.end(), name.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (name.find("normal") != std::string::npos)
+    {
+        return TexCookUsage_Normal;
+    }
+    if (name.find("spec") != std::string::npos || name.find("spac") != std::string::npos)
+    {
+        return TexCookUsage_Specular;
+    }
+    return TexCookUsage_Diffuse;
+}
+
+static TextureContainerFormat GetFormat(const TexCookUsage usage)
+{
+    switch (usage)
+    {
+    case TexCookUsage_Normal:
+        return TextureContainerFormat_BC5;
+    case TexCookUsage_Specular:
+        return TextureContainerFormat_BC1;
+    default:
+        return TextureContainerFormat_BC7;
+    }
+}
+
+// copies a 4x4 block out of the level, blocks hanging over the edge repeat the last row and column
+static void GatherBlock(const uint8_t* level, const uint32_t width, const uint32_t height, const uint32_t blockX, const uint32_t blockY, uint8_t* texels)
+{
+    for (uint32_t y = 0; y < c_textureContainerBlockExtent; ++y)
+    {
+        const uint32_t srcY = std::min(blockY * c_textureContainerBlockExtent + y, height - 1);
+        for (uint32_t x = 0; x < c_textureContainerBlockExtent; ++x)
+        {
+            const uint32_t srcX = std::min(blockX * c_textureContainerBlockExtent + x, width - 1);
+            memcpy(texels + (y * c_textureContainerBlockExtent + x) * 4, level + (static_cast<std::size_t>(srcY) * width + srcX) * 4, 4);
+        }
+    }
+}
+
+// the same check the game makes, so anything skipped here is a file the game will actually load
+static bool IsUpToDate(const fs::path& srcPath, const fs::path& dstPath)
+{
+    TextureContainerHeader header;
+    std::ifstream file(dstPath, std::ios::in | std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        return false;
+    }
+
+    uint64_t sourceSize = 0;
+    int64_t sourceModifiedTime = 0;
+    return header.m_magic == c_textureContainerMagic &&
+        header.m_version == c_textureContainerVersion &&
+        GetSourceStamp_TextureContainer(srcPath.string().c_str(), sourceSize, sourceModifiedTime) &&
+        sourceSize == header.m_sourceSize &&
+        sourceModifiedTime == header.m_sourceModifiedTime;
+}
+
+static bool CookTexture(const fs::path& srcPath, const fs::path& dstPath, const uint32_t threadCount)
+{
+    int width = 0;
+    int height = 0;
+    int channelsInFile = 0;
+    stbi_uc* pixels = stbi_load(srcPath.string().c_str(), &width, &height, &channelsInFile, STBI_rgb_alpha);
+    if (pixels == nullptr)
+    {
+        fprintf(stderr, "duck_texcook: could not load %s: %s\n", srcPath.string().c_str(), stbi_failure_reason());
+        return false;
+    }
+
+    const TexCookUsage usage = GetUsage(srcPath);
+    const TextureContainerFormat format = GetFormat(usage);
+    const uint32_t blockSize = GetBlockSize_TextureContainer(format);
+
+    TextureContainerHeader header;
+    if (!GetSourceStamp_TextureContainer(srcPath.string().c_str(), header.m_sourceSize, header.m_sourceModifiedTime))
+    {
+        fprintf(stderr, "duck_texcook: could not stat %s\n", srcPath.string().c_str());
+        return false;
+    }
+    header.m_format = format;
+    header.m_width = static_cast<uint32_t>(width);
+    header.m_height = static_cast<uint32_t>(height);
+    header.m_levelCount = std::min(GetLevelCount_MipChain(header.m_width, header.m_height), c_textureContainerMaxLevelCount);
+
+    // only diffuse is colour, normals and masks have to be averaged as they are
+    std::vector<uint8_t> mipChain(GetSize_MipChain(header.m_width, header.m_height, header.m_levelCount, 4));
+    memcpy(mipChain.data(), pixels, static_cast<std::size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+    Generate_MipChain(mipChain.data(), header.m_width, header.m_height, header.m_levelCount, usage == TexCookUsage_Diffuse);
+
+    // a row of blocks is the unit of work so every thread writes to its own part of the output
+    struct BlockRow
+    {
+        const uint8_t* m_level;
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_blockY;
+        uint8_t* m_blocks;
+    };
+    std::vector<BlockRow> blockRows;
+
+    constexpr uint64_t dataAlignment = 16;
+    std::vector<uint8_t> blocks;
+    uint64_t dataOffset = (sizeof(TextureContainerHeader) + dataAlignment - 1) / dataAlignment * dataAlignment;
+    std::vector<std::size_t> levelBlockOffsets;
+    for (uint32_t level = 0; level < header.m_levelCount; ++level)
+    {
+        const uint32_t levelWidth = GetLevelSize_MipChain(header.m_width, level);
+        const uint32_t levelHeight = GetLevelSize_MipChain(header.m_height, level);
+        const uint32_t blocksWide = (levelWidth + c_textureContainerBlockExtent - 1) / c_textureContainerBlockExtent;
+        const uint32_t blocksHigh = (levelHeight + c_textureContainerBlockExtent - 1) / c_textureContainerBlockExtent;
+
+        header.m_levels[level].m_offset = dataOffset;
+        header.m_levels[level].m_size = static_cast<uint64_t>(blocksWide) * blocksHigh * blockSize;
+        dataOffset += header.m_levels[level].m_size;
+
+        levelBlockOffsets.push_back(blocks.size());
+        blocks.resize(blocks.size() + static_cast<std::size_t>(header.m_levels[level].m_size));
+    }
+
+    std::size_t levelOffset = 0;
+    for (uint32_t level = 0; level < header.m_levelCount; ++level)
+    {
+        const uint32_t levelWidth = GetLevelSize_MipChain(header.m_width, level);
+        const uint32_t levelHeight = GetLevelSize_MipChain(header.m_height, level);
+        const uint32_t blocksWide = (levelWidth + c_textureContainerBlockExtent - 1) / c_textureContainerBlockExtent;
+        const uint32_t blocksHigh = (levelHeight + c_textureContainerBlockExtent - 1) / c_textureContainerBlockExtent;
+
+        for (uint32_t blockY = 0; blockY < blocksHigh; ++blockY)
+        {
+            BlockRow& blockRow = blockRows.emplace_back();
+            blockRow.m_level = mipChain.data() + levelOffset;
+            blockRow.m_width = levelWidth;
+            blockRow.m_height = levelHeight;
+            blockRow.m_blockY = blockY;
+            blockRow.m_blocks = blocks.data() + levelBlockOffsets[level] + static_cast<std::size_t>(blockY) * blocksWide * blockSize;
+        }
+
+        levelOffset += static_cast<std::size_t>(levelWidth) * levelHeight * 4;
+    }
+
+    std::atomic<std::size_t> nextBlockRow(0);
+    auto encodeBlockRows = [&]()
+    {
+        uint8_t texels[c_textureContainerBlockExtent * c_textureContainerBlockExtent * 4];
+        for (std::size_t rowIndex = nextBlockRow.fetch_add(1); rowIndex < blockRows.size(); rowIndex = nextBlockRow.fetch_add(1))
+        {
+            const BlockRow& blockRow = blockRows[rowIndex];
+            const uint32_t blocksWide = (blockRow.m_width + c_textureContainerBlockExtent - 1) / c_textureContainerBlockExtent;
+            for (uint32_t blockX = 0; blockX < blocksWide; ++blockX)
+            {
+                GatherBlock(blockRow.m_level, blockRow.m_width, blockRow.m_height, blockX, blockRow.m_blockY, texels);
+
+                uint8_t* block = blockRow.m_blocks + static_cast<std::size_t>(blockX) * blockSize;
+                switch (format)
+                {
+                case TextureContainerFormat_BC1:
+                    EncodeBC1_BlockEncoder(texels, block);
+                    break;
+                case TextureContainerFormat_BC5:
+                    EncodeBC5_BlockEncoder(texels, block);
+                    break;
+                default:
+                    EncodeBC7_BlockEncoder(texels, block);
+                    break;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < threadCount; ++i)
+    {
+        threads.emplace_back(encodeBlockRows);
+    }
+    encodeBlockRows();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    // written next to the final path and renamed over it so the game never maps half a file
+    const fs::path tempPath = fs::path(dstPath).concat(".tmp");
+    {
+        std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        const std::vector<char> padding(static_cast<std::size_t>(header.m_levels[0].m_offset - sizeof(header)), 0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        file.write(reinterpret_cast<const char*>(blocks.data()), static_cast<std::streamsize>(blocks.size()));
+        if (!file)
+        {
+            fprintf(stderr, "duck_texcook: could not write %s\n", tempPath.string().c_str());
+            return false;
+        }
+    }
+
+    std::error_code errorCode;
+    fs::rename(tempPath, dstPath, errorCode);
+    if (errorCode)
+    {
+        fprintf(stderr, "duck_texcook: could not replace %s: %s\n", dstPath.string().c_str(), errorCode.message().c_str());
+        fs::remove(tempPath, errorCode);
+        return false;
+    }
+
+    printf("%s: %ux%u %s, %u levels, %.2f MB as rgba8 with mips -> %.2f MB\n",
+        dstPath.string().c_str(),
+        header.m_width,
+        header.m_height,
+        c_texCookUsageNames[usage],
+        header.m_levelCount,
+        mipChain.size() / (1024.0 * 1024.0),
+        blocks.size() / (1024.0 * 1024.0));
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bool force = false;
+    fs::path directory = "data";
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--force") == 0)
+        {
+            force = true;
+        }
+        else
+        {
+            directory = argv[i];
+        }
+    }
+
+    std::error_code errorCode;
+    if (!fs::is_directory(directory, errorCode))
+    {
+        fprintf(stderr, "duck_texcook: %s is not a directory\n", directory.string().c_str());
+        return 1;
+    }
+
+    const uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    uint32_t cookedCount = 0;
+    uint32_t skippedCount = 0;
+    uint32_t failedCount = 0;
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(directory))
+    {
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (!entry.is_regular_file() || extension != ".png")
+        {
+            continue;
+        }
+
+        const fs::path dstPath = fs::path(entry.path()).replace_extension(c_textureContainerExtension);
+        if (!force && IsUpToDate(entry.path(), dstPath))
+        {
+            ++skippedCount;
+            continue;
+        }
+
+        if (CookTexture(entry.path(), dstPath, threadCount))
+        {
+            ++cookedCount;
+        }
+        else
+        {
+            ++failedCount;
+        }
+    }
+
+    const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    printf("duck_texcook: %u cooked, %u up to date, %u failed in %.1f s on %u threads\n", cookedCount, skippedCount, failedCount, time, threadCount);
+
+    return failedCount == 0 ? 0 : 1;
+}